@@ -2,6 +2,7 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include <array>
 
 // ==========================================
 // UI constants
@@ -72,30 +73,71 @@ inline std::unique_ptr<juce::Drawable> loadOffSvg()
                               BinaryData::checkbox_off_svgSize);
 }
 
+// ==========================================
+// Shared LED drawables
+// ==========================================
+// Each SVG is parsed once and shared by every LedToggleButton of every plugin
+// window in the process.  Held through juce::SharedResourcePointer, so the
+// drawables go away with the last button.  Message thread only.
+class LedDrawableCache
+{
+    public:
+        const juce::Drawable& getOff()
+        {
+            if (offDrawable == nullptr)
+                offDrawable = loadOffSvg();
+
+            jassert (offDrawable != nullptr);
+            return *offDrawable;
+        }
+
+        const juce::Drawable& getOn (SetupUI::LedColour colour)
+        {
+            auto& d = onDrawables[(size_t) colour];
+
+            if (d == nullptr)
+                d = loadSvgFromBinary (getOnSvgData (colour), (size_t) getOnSvgSize (colour));
+
+            jassert (d != nullptr);
+            return *d;
+        }
+
+    private:
+        std::unique_ptr<juce::Drawable> offDrawable;
+        std::array<std::unique_ptr<juce::Drawable>, 5> onDrawables;   // one per SetupUI::LedColour
+};
+
 // ==========================================
 // Image based toggle button
 // ==========================================
-class LedToggleButton : public juce::DrawableButton
+// Paints the shared drawables directly (stretched to the bounds, dimmed when
+// disabled like a DrawableButton) instead of keeping its own copies.
+class LedToggleButton : public juce::Button
 {
     public:
         LedToggleButton (const juce::String& name,
                          SetupUI::LedColour colour)
-            : juce::DrawableButton (name, juce::DrawableButton::ImageStretched),
-              offDrawable (loadOffSvg()),
-              onDrawable  (loadSvgFromBinary (getOnSvgData (colour),
-                                              getOnSvgSize (colour)))
+            : juce::Button (name),
+              offDrawable (&drawables->getOff()),
+              onDrawable  (&drawables->getOn (colour))
         {
-            jassert (offDrawable && onDrawable);
-
             setClickingTogglesState (true);
+        }
+
+        void paintButton (juce::Graphics& g, bool, bool) override
+        {
+            const auto& image = getToggleState() ? *onDrawable : *offDrawable;
 
-            setImages (offDrawable.get(), nullptr, nullptr, nullptr,
-                       onDrawable.get(),  nullptr, nullptr, nullptr);
+            image.drawWithin (g, getLocalBounds().toFloat(),
+                              juce::RectanglePlacement::stretchToFit,
+                              isEnabled() ? 1.0f : 0.4f);
         }
 
     private:
-        std::unique_ptr<juce::Drawable> offDrawable;
-        std::unique_ptr<juce::Drawable> onDrawable;
+        juce::SharedResourcePointer<LedDrawableCache> drawables;
+
+        const juce::Drawable* offDrawable;
+        const juce::Drawable* onDrawable;
 };
 
 // ==========================================
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Error-bounded curve compression for outgoing controller streams
+//
+// Receivers hold a value until the next one (they don't interpolate), so the
+// error that matters is between the value the synth holds and the one the
+// stream has now.  A segment starts at each value sent and is closed by the
+// first sample the held value would be off by more than `tolerance`: that
+// sample is sent at once, so the held value never strays further than the
+// tolerance and jumps keep their timing.  Slow shapes go out as a staircase
+// of tolerance-sized steps instead of one message per change.
+//
+//     Point out;
+//     if (curve.push ({ timeMs, value01, midiValue }, tolerance, out))
+//         send (out);
+//
+// Changes smaller than the tolerance are not lost for good: a value still
+// held after maxSegmentMs is replaced by the current one, and flush() sends
+// the last value when the stream stops, so the receiver ends on it.
+//
+// Values are positions in the parameter's range (0..1); tolerance is in the
+// same unit (see curveToleranceFor in SyntaktParameterTable.h).  No
+// allocation, no JUCE: usable from the engine library as well.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::curve
+{
+    static constexpr double maxSegmentMs = 250.0;
+
+    struct Point
+    {
+        double timeMs    = 0.0;
+        double value01   = 0.0;   // position in the parameter's range
+        int    midiValue = 0;     // the same value, quantised for the wire
+    };
+
+    class Simplifier
+    {
+    public:
+        // Feeds one sample.  Returns true with `out` set when a point must be
+        // sent now (the first sample, or the one that closes the segment).
+        bool push (const Point& p, double tolerance, Point& out) noexcept
+        {
+            if (state == State::empty)
+                return sendNow (p, out);
+
+            const bool moved = p.midiValue != held.midiValue;
+
+            // The held value would be off by more than the tolerance: close now
+            if (moved && std::abs (p.value01 - held.value01) > tolerance)
+                return sendNow (p, out);
+
+            // Within tolerance, but held for a whole segment: catch up
+            if (moved && p.timeMs - held.timeMs >= maxSegmentMs)
+                return sendNow (p, out);
+
+            latest = p;
+            state  = moved ? State::pending : State::held;
+            return false;
+        }
+
+        // Sends the latest value if the receiver holds a different one.
+        bool flush (Point& out) noexcept
+        {
+            if (state != State::pending)
+                return false;
+
+            return sendNow (latest, out);
+        }
+
+        // Forget everything: the next sample is sent as is.
+        void reset() noexcept { state = State::empty; }
+
+        bool isPending() const noexcept { return state == State::pending; }
+
+    private:
+        bool sendNow (const Point& p, Point& out) noexcept
+        {
+            held  = p;
+            out   = p;
+            state = State::held;
+            return true;
+        }
+
+        // held: the receiver has the value of the latest sample
+        // pending: the latest sample differs from the value held
+        enum class State : uint8_t { empty, held, pending };
+
+        Point held, latest;   // last sent, last pushed
+        State state = State::empty;
+    };
+} // namespace modztakt::curve
@@ -2,8 +2,12 @@
 #include <JuceHeader.h>
 
 #include "Cosmetic.h"
+#include "DelayTapEditorComponent.h"
+#include "InstrumentMapLibrary.h"
+#include "UiRefresh.h"
+#include "RouteOccupancy.h"
 
-class DelayEditorComponent : public juce::Component, private juce::Timer
+class DelayEditorComponent : public juce::Component
 {
 public:
     using APVTS          = juce::AudioProcessorValueTreeState;
@@ -14,8 +18,10 @@ public:
     static constexpr int maxRoutes = 3;
 
     // ─────────────────────────────────────────────────────────────────────────
-    DelayEditorComponent (APVTS& apvtsRef)
-        : apvts (apvtsRef)
+    DelayEditorComponent (APVTS& apvtsRef, const modztakt::instrument::MapLibrary& mapsRef,
+                          const modztakt::routing::Occupancy& occupancyRef,
+                          modztakt::ui::RefreshScheduler& uiRefreshRef)
+        : apvts (apvtsRef), instrumentMaps (mapsRef), routeOccupancy (occupancyRef), uiRefresh (uiRefreshRef)
     {
         setName ("Delay");
 
@@ -171,6 +177,17 @@ public:
             delayRouteChannelAttach[r] = std::make_unique<ChoiceAttachment> (
                 apvts, "delayRoute" + rs + "_channel", delayRouteChannelBox[r]);
 
+            // Per-route sync division: 1 = Main (follow the main delay interval),
+            // 2..9 = 1/1 .. 1/16 dot.  Lets routes echo at polyrhythmic intervals.
+            delayRouteDivisionBox[r].addItemList ({ "Main",
+                                                    "1/1", "1/2", "1/4", "1/8", "1/16", "1/32",
+                                                    "1/8 dot", "1/16 dot" }, 1);
+            delayRouteDivisionBox[r].setTooltip ("Route echo interval (Main = main delay time)");
+            addAndMakeVisible (delayRouteDivisionBox[r]);
+
+            delayRouteDivisionAttach[r] = std::make_unique<ChoiceAttachment> (
+                apvts, "delayRoute" + rs + "_division", delayRouteDivisionBox[r]);
+
             // Transpose slider  (-24 .. +24 semitones, integer steps)
             // Attachment is created BEFORE setupTransposeSlider so APVTS sets initial value.
             delayRouteTransposeAttach[r] = std::make_unique<SliderAttachment> (
@@ -241,15 +258,31 @@ public:
         panWidthAttach = std::make_unique<SliderAttachment> (apvts, "delayPanWidth", panWidthSlider);
         setupPanWidthSlider();
 
+        // ── Multi-tap ────────────────────────────────────────────────────────
+        // Toggle + "Taps..." button; the per-tap rows live in a callout so the
+        // panel height stays unchanged.
+        multiTapBtn = std::make_unique<LedToggleButton> ("Multi-Tap", SetupUI::LedColour::Red);
+        multiTapBtn->setClickingTogglesState (true);
+        addAndMakeVisible (*multiTapBtn);
+        multiTapAttach = std::make_unique<ButtonAttachment> (apvts, "delayMultiTap", *multiTapBtn);
+
+        multiTapLabel.setText ("Multi-Tap", juce::dontSendNotification);
+        multiTapLabel.setColour (juce::Label::textColourId, SetupUI::labelsColor);
+        addAndMakeVisible (multiTapLabel);
 
-        startTimerHz (20);
+        editTapsButton.setButtonText ("Taps...");
+        editTapsButton.onClick = [this] { showTapEditor(); };
+        addAndMakeVisible (editTapsButton);
+
+
+        // Keep UI state in sync with the enabled flags (EG shaping follows egEnabled)
+        uiRefresh.subscribe (modztakt::ui::Changed::delayParams | modztakt::ui::Changed::egParams,
+                             [this] (uint32_t) { updateDelayUiEnabledState(); });
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     ~DelayEditorComponent() override
     {
-        stopTimer();
-
         // Reset all APVTS attachments before components are destroyed.
         delayEnableAttach.reset();
         noteSourceDelayChannelAttach.reset();
@@ -260,6 +293,7 @@ public:
         for (int r = 0; r < maxRoutes; ++r)
         {
             delayRouteChannelAttach[r].reset();
+            delayRouteDivisionAttach[r].reset();
             delayRouteTransposeAttach[r].reset();
         }
 
@@ -268,6 +302,7 @@ public:
 
         panEnableAttach.reset();
         panWidthAttach.reset();
+        multiTapAttach.reset();
     }
 
     // ─────────────────────────────────────────────────────────────────────────
@@ -454,8 +489,27 @@ public:
             content.removeFromTop (6);
         }
 
+        // ── Multi-tap row: [●] Multi-Tap  [Taps...]
+        {
+            auto row = content.removeFromTop (rowHeight);
+            juce::FlexBox fb;
+            fb.flexDirection  = juce::FlexBox::Direction::row;
+            fb.alignItems     = juce::FlexBox::AlignItems::center;
+            fb.justifyContent = juce::FlexBox::JustifyContent::flexStart;
+            fb.items.add (juce::FlexItem (*multiTapBtn)
+                              .withWidth (btnW).withHeight ((float)(rowHeight - 4))
+                              .withMargin ({ 0, 4, 0, 4 }));
+            fb.items.add (juce::FlexItem (multiTapLabel)
+                              .withWidth (80.0f).withHeight ((float) rowHeight)
+                              .withMargin ({ 0, 0, 0, 8 }));
+            fb.items.add (juce::FlexItem (editTapsButton)
+                              .withWidth (70.0f).withHeight ((float) rowHeight - 2));
+            fb.performLayout (row.toFloat());
+            content.removeFromTop (6);
+        }
+
         // ── Output route rows ─────────────────────────────────────────────────
-        // Each row: [Route N label | Channel combobox | Transpose slider]
+        // Each row: [Route N label | Channel combobox | Division combobox | Transpose slider]
         auto layoutRouteRow = [&] (juce::Rectangle<int> row, int r)
         {
             juce::FlexBox fb;
@@ -468,6 +522,9 @@ public:
             fb.items.add (juce::FlexItem (delayRouteChannelBox[r])
                               .withWidth (80.0f).withHeight ((float) rowHeight)
                               .withMargin ({ 0, 6, 0, 0 }));
+            fb.items.add (juce::FlexItem (delayRouteDivisionBox[r])
+                              .withWidth (72.0f).withHeight ((float) rowHeight)
+                              .withMargin ({ 0, 6, 0, 0 }));
             fb.items.add (juce::FlexItem (delayRouteTransposeSlider[r])
                               .withFlex (1.0f).withHeight ((float) rowHeight)
                               .withMargin ({ 0, 8, 0, 0 }));
@@ -490,13 +547,36 @@ public:
         }
     }
 
-private:
-    // ── Timer: keep UI state in sync with the enabled flag ───────────────────
-    void timerCallback() override
+    // Route occupancy changed (called by MainComponent after a sync).
+    // When EG shaping is active, grey channels in delayRouteChannelBox that are
+    // already claimed by LFO or EG routes for the same destination parameter
+    // (Amp: Volume or Track Level), then clear routes that now conflict.
+    // The pan conflict is read-only from this side: MainComponent and
+    // EnvelopeEditorComponent grey "Amp: Pan" from the same occupancy table.
+    void refreshRouteAvailability()
     {
-        updateDelayUiEnabledState();
+        enforceDelayRouteConflicts();
+
+        const auto blocked = getChannelsBlockedForShaping();
+
+        for (int r = 0; r < maxRoutes; ++r)
+            for (int ch = 1; ch <= 16; ++ch)
+                delayRouteChannelBox[r].setItemEnabled (ch + 1, !blocked[(size_t) ch]);
+
+        // Sibling-route exclusion: grey any channel already selected by
+        // another delay route, regardless of EG shaping state.
+        std::array<int, maxRoutes> routeCh {};
+        for (int r = 0; r < maxRoutes; ++r)
+            routeCh[r] = (int) apvts.getRawParameterValue (
+                "delayRoute" + juce::String (r) + "_channel")->load(); // 0=Disabled, 1..16
+
+        for (int r = 0; r < maxRoutes; ++r)
+            for (int s = 0; s < maxRoutes; ++s)
+                if (s != r && routeCh[s] > 0)
+                    delayRouteChannelBox[r].setItemEnabled (routeCh[s] + 1, false);
     }
 
+private:
     void updateDelayUiEnabledState()
     {
         const bool enabled = apvts.getRawParameterValue ("delayEnabled")->load() > 0.5f;
@@ -514,12 +594,11 @@ private:
         noteSourceDelayChannelLabel.setEnabled (enabled);
         delaySyncBox.setEnabled (enabled);
         delaySyncLabel.setEnabled (enabled);
-        feedbackSlider.setEnabled (enabled);
-        feedbackLabel.setEnabled (enabled);
 
         // The rate slider is only interactive when the module is enabled AND
-        // not locked to a sync division.
-        const bool rateEditable = enabled && !synced;
+        // not locked to a sync division (multi-tap taps carry their own times).
+        const bool rateEditable = enabled && !synced
+            && apvts.getRawParameterValue ("delayMultiTap")->load() <= 0.5f;
         delayRateSlider.setEnabled (rateEditable);
         delayRateLabel.setEnabled (rateEditable);
 
@@ -529,93 +608,21 @@ private:
             apvts.getRawParameterValue ("delayPanEnabled")->load() > 0.5f;
         panWidthSlider.setEnabled (panEnabled);
 
-        for (int r = 0; r < maxRoutes; ++r)
-        {
-            delayRouteChannelBox[r].setEnabled (enabled);
-            delayRouteLabel[r].setEnabled (enabled);
-            delayRouteTransposeSlider[r].setEnabled (enabled);
-        }
-
-        // Cross-module conflict: when EG shaping is active, grey channels in
-        // delayRouteChannelBox that are already claimed by LFO or EG routes for the
-        // same destination parameter (Amp: Volume or Track Level).
-        // enforceDelayRouteConflicts() has already cleared any conflicting routes
-        // by this point (called from onClick and from this function below), so
-        // the currently-selected channel for each route is guaranteed to be clean.
-        {
-            const int egShape = static_cast<int> (apvts.getRawParameterValue ("delayEgShape")->load());
-
-            if (egShape > 0)
-            {
-                const int targetGlobalIdx = findGlobalParamByName (
-                    egShape == 1 ? "Amp: Volume" : "Track Level");
+        // Multi-tap replaces the feedback chain, routes and step sequencer.
+        const bool multiTap = enabled &&
+            apvts.getRawParameterValue ("delayMultiTap")->load() > 0.5f;
+        const bool chainEditable = enabled && !multiTap;
 
-                std::array<bool, 17> blocked {};
+        if (multiTapBtn) multiTapBtn->setEnabled (enabled);
+        multiTapLabel.setEnabled (enabled);
+        editTapsButton.setEnabled (multiTap);
 
-                for (int r = 0; r < maxRoutes; ++r)
-                {
-                    const auto rs   = juce::String (r);
-                    const int lfoCh = (int) apvts.getRawParameterValue ("route"    + rs + "_channel")->load();
-                    const int lfoP  = (int) apvts.getRawParameterValue ("route"    + rs + "_param"  )->load();
-                    if (lfoCh > 0 && lfoP == targetGlobalIdx)
-                        blocked[lfoCh] = true;
-                }
-
-                for (int r = 0; r < maxRoutes; ++r)
-                {
-                    const auto rs  = juce::String (r);
-                    const int egCh   = (int) apvts.getRawParameterValue ("egRoute" + rs + "_channel")->load();
-                    if (egCh <= 0) continue;
-                    const int egDest = (int) apvts.getRawParameterValue ("egRoute" + rs + "_dest"   )->load();
-                    if (mapEgChoiceToGlobal (egDest) == targetGlobalIdx)
-                        blocked[egCh] = true;
-                }
-
-                for (int r = 0; r < maxRoutes; ++r)
-                    for (int ch = 1; ch <= 16; ++ch)
-                        delayRouteChannelBox[r].setItemEnabled (ch + 1, !blocked[ch]);
-            }
-            else
-            {
-                for (int r = 0; r < maxRoutes; ++r)
-                    for (int ch = 1; ch <= 16; ++ch)
-                        delayRouteChannelBox[r].setItemEnabled (ch + 1, true);
-            }
-
-            // Sibling-route exclusion: grey any channel already selected by
-            // another delay route, regardless of EG shaping state.
-            // This is independent of the LFO/EG block above.
-            {
-                std::array<int, maxRoutes> routeCh {};
-                for (int r = 0; r < maxRoutes; ++r)
-                    routeCh[r] = (int) apvts.getRawParameterValue (
-                        "delayRoute" + juce::String (r) + "_channel")->load(); // 0=Disabled, 1..16
-
-                for (int r = 0; r < maxRoutes; ++r)
-                    for (int ch = 1; ch <= 16; ++ch)
-                    {
-                        // Check whether any sibling route holds this channel.
-                        bool takenBySibling = false;
-                        for (int s = 0; s < maxRoutes; ++s)
-                            if (s != r && routeCh[s] == ch)
-                                { takenBySibling = true; break; }
-
-                        if (takenBySibling)
-                            delayRouteChannelBox[r].setItemEnabled (ch + 1, false);
-                        // (enabling is already handled by the block above;
-                        //  we only ever add restrictions here, never lift them)
-                    }
-            }
-
-            // Pan conflict: when delayPanEnabled, grey "Amp: Pan" in LFO and EG
-            // route destination boxes for any channel occupied by a delay route.
-            // The actual greying happens in MainComponent and EnvelopeEditorComponent
-            // via their 20 Hz timer refresh — here we just fire enforceDelayRouteConflicts()
-            // which is already called above.  The pan conflict is read-only from this side.
-
-            // Also enforce on every timer tick so routes set before egShape was
-            // activated are cleaned up even without a button click.
-            enforceDelayRouteConflicts();
+        for (int r = 0; r < maxRoutes; ++r)
+        {
+            delayRouteChannelBox[r].setEnabled (chainEditable);
+            delayRouteDivisionBox[r].setEnabled (chainEditable);
+            delayRouteLabel[r].setEnabled (chainEditable);
+            delayRouteTransposeSlider[r].setEnabled (chainEditable);
         }
 
         // EG shaping buttons: gated by delay enabled AND EG enabled.
@@ -657,17 +664,26 @@ private:
         delaySyncLabel.setAlpha (enabled ? 1.0f : 0.60f);
         delayRateSlider.setAlpha (aRate);
         delayRateLabel.setAlpha (aRate);
-        feedbackSlider.setAlpha (a);
 
         if (panEnableBtn) panEnableBtn->setAlpha (a);
         panEnableLabel.setAlpha (a);
         panWidthSlider.setAlpha (panEnabled ? 1.0f : 0.45f);
 
+        if (multiTapBtn) multiTapBtn->setAlpha (a);
+        multiTapLabel.setAlpha (a);
+        editTapsButton.setAlpha (multiTap ? 1.0f : 0.45f);
+
+        const float aChain = chainEditable ? 1.0f : 0.45f;
+        feedbackSlider.setEnabled (chainEditable);
+        feedbackLabel.setEnabled (chainEditable);
+        feedbackSlider.setAlpha (aChain);
+
         for (int r = 0; r < maxRoutes; ++r)
         {
-            delayRouteChannelBox[r].setAlpha (a);
-            delayRouteLabel[r].setAlpha (enabled ? 1.0f : 0.60f);
-            delayRouteTransposeSlider[r].setAlpha (a);
+            delayRouteChannelBox[r].setAlpha (aChain);
+            delayRouteDivisionBox[r].setAlpha (aChain);
+            delayRouteLabel[r].setAlpha (chainEditable ? 1.0f : 0.60f);
+            delayRouteTransposeSlider[r].setAlpha (aChain);
         }
 
         // EG shaping buttons alpha (egPerNoteBtn uses visibility instead of alpha)
@@ -685,19 +701,19 @@ private:
         if (seqBinaryBtn)
         {
             seqBinaryBtn ->setToggleState (!ternary, juce::dontSendNotification);
-            seqBinaryBtn ->setEnabled (enabled);
-            seqBinaryBtn ->setAlpha (a);
+            seqBinaryBtn ->setEnabled (chainEditable);
+            seqBinaryBtn ->setAlpha (aChain);
         }
         if (seqTernaryBtn)
         {
             seqTernaryBtn->setToggleState (ternary,  juce::dontSendNotification);
-            seqTernaryBtn->setEnabled (enabled);
-            seqTernaryBtn->setAlpha (a);
+            seqTernaryBtn->setEnabled (chainEditable);
+            seqTernaryBtn->setAlpha (aChain);
         }
-        seqBinaryLabel.setEnabled (enabled);
-        seqTernaryLabel.setEnabled (enabled);
-        seqBinaryLabel.setAlpha (a);
-        seqTernaryLabel.setAlpha (a);
+        seqBinaryLabel.setEnabled (chainEditable);
+        seqTernaryLabel.setEnabled (chainEditable);
+        seqBinaryLabel.setAlpha (aChain);
+        seqTernaryLabel.setAlpha (aChain);
 
         for (int s = 0; s < maxSeqSteps; ++s)
         {
@@ -705,8 +721,8 @@ private:
             seqStepBtn[s]->setVisible (stepVisible);
             if (stepVisible)
             {
-                seqStepBtn[s]->setEnabled (enabled);
-                seqStepBtn[s]->setAlpha (a);
+                seqStepBtn[s]->setEnabled (chainEditable);
+                seqStepBtn[s]->setAlpha (aChain);
             }
         }
 
@@ -808,6 +824,19 @@ private:
         panWidthSlider.updateText();
     }
 
+    // Open the per-tap editor in a callout anchored to the "Taps..." button.
+    void showTapEditor()
+    {
+        auto* parent = getTopLevelComponent();
+        if (parent == nullptr)
+            return;
+
+        juce::CallOutBox::launchAsynchronously (
+            std::make_unique<DelayTapEditorComponent> (apvts, uiRefresh),
+            parent->getLocalArea (this, editTapsButton.getBounds()),
+            parent);
+    }
+
     // Write the delayEgShape choice index to APVTS.
     // 0 = Off, 1 = EG Volume ("Amp: Volume"), 2 = EG Track Level ("Track Level").
     // Note: "Per Note EG" behavior is governed by the separate "delayEgPerNote"
@@ -836,42 +865,16 @@ private:
 
     // ── Cross-module conflict enforcement ─────────────────────────────────────
     //
-    // Called from onClick (immediate) and from updateDelayUiEnabledState (20 Hz).
+    // Called from onClick (immediate) and from refreshRouteAvailability().
     // When egShape > 0, any delay route whose channel is already owned by an LFO
     // or EG route for the same target parameter is forced to Disabled.
     // This is the only place that writes to delayRoute{r}_channel.
     void enforceDelayRouteConflicts()
     {
-        const int egShape = static_cast<int> (
-            apvts.getRawParameterValue ("delayEgShape")->load());
-
-        if (egShape == 0)
-            return; // nothing to enforce when shaping is off
-
-        const int targetGlobalIdx = findGlobalParamByName (
-            egShape == 1 ? "Amp: Volume" : "Track Level");
+        if (getDelayEgTargetIndex() < 0)
+            return; // nothing to enforce when shaping is off (or the synth has no target)
 
-        // Build the blocked channel set (same logic as the greying block).
-        std::array<bool, 17> blocked {};
-
-        for (int r = 0; r < maxRoutes; ++r)
-        {
-            const auto rs   = juce::String (r);
-            const int lfoCh = (int) apvts.getRawParameterValue ("route"    + rs + "_channel")->load();
-            const int lfoP  = (int) apvts.getRawParameterValue ("route"    + rs + "_param"  )->load();
-            if (lfoCh > 0 && lfoP == targetGlobalIdx)
-                blocked[lfoCh] = true;
-        }
-
-        for (int r = 0; r < maxRoutes; ++r)
-        {
-            const auto rs  = juce::String (r);
-            const int egCh   = (int) apvts.getRawParameterValue ("egRoute" + rs + "_channel")->load();
-            if (egCh <= 0) continue;
-            const int egDest = (int) apvts.getRawParameterValue ("egRoute" + rs + "_dest"   )->load();
-            if (mapEgChoiceToGlobal (egDest) == targetGlobalIdx)
-                blocked[egCh] = true;
-        }
+        const auto blocked = getChannelsBlockedForShaping();
 
         // ── Snapshot current delay route channels ────────────────────────────
         std::array<int, maxRoutes> routeCh {};
@@ -914,35 +917,43 @@ private:
 
     // ── Cross-module conflict helpers ─────────────────────────────────────────
     //
-    // Both are static so they can be called without a component instance and
-    // reused in LFO / EG editors (same SyntaktParameterTable.h is included there).
+    // They read the selected instrument map (see InstrumentMap.h) and the
+    // route occupancy table (see RouteOccupancy.h).
 
-    // Find global syntaktParameters[] index by exact name. Returns -1 if not found.
-    static int findGlobalParamByName (const char* name) noexcept
+    // Channels (1..16) where an LFO or EG route already drives the delay EG
+    // target parameter; all false when shaping is off.
+    std::array<bool, 17> getChannelsBlockedForShaping() const
     {
-        for (int i = 0; i < juce::numElementsInArray (syntaktParameters); ++i)
-            if (juce::String (syntaktParameters[i].name) == name)
-                return i;
-        return -1;
+        namespace Owner = modztakt::routing::Owner;
+
+        std::array<bool, 17> blocked {};
+        const int targetGlobalIdx = getDelayEgTargetIndex();
+
+        if (targetGlobalIdx >= 0)
+            for (int ch = 1; ch <= 16; ++ch)
+                blocked[(size_t) ch] = routeOccupancy.isClaimed (ch, targetGlobalIdx, Owner::anyLfo | Owner::anyEg);
+
+        return blocked;
     }
 
-    // Map an EG destination choice index (0-based position in the egDestination=true
-    // filtered list) to the global syntaktParameters[] index.
-    // Mirrors EnvelopeEditorComponent::mapEgChoiceToGlobalParamIndex().
-    static int mapEgChoiceToGlobal (int egChoice) noexcept
+    // Global map index of the parameter shaped by the delay EG ("delayEgShape":
+    // 1 = volume role, 2 = level role). -1 when shaping is off or the synth has none.
+    int getDelayEgTargetIndex() const
     {
-        int k = 0;
-        for (int i = 0; i < juce::numElementsInArray (syntaktParameters); ++i)
-        {
-            if (!syntaktParameters[i].egDestination) continue;
-            if (k == egChoice) return i;
-            ++k;
-        }
-        return -1;
+        const int egShape = static_cast<int> (apvts.getRawParameterValue ("delayEgShape")->load());
+
+        if (egShape == 0)
+            return -1;
+
+        return instrumentMaps.getSelected().getRoleIndex (egShape == 1 ? modztakt::instrument::Role::Volume
+                                                                        : modztakt::instrument::Role::Level);
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     APVTS& apvts;
+    const modztakt::instrument::MapLibrary& instrumentMaps;
+    const modztakt::routing::Occupancy& routeOccupancy;   // synced by MainComponent
+    modztakt::ui::RefreshScheduler& uiRefresh;            // MainComponent's, outlives this
 
     // Group frame
     juce::GroupComponent delayGroup;
@@ -972,6 +983,10 @@ private:
     std::array<juce::ComboBox, maxRoutes> delayRouteChannelBox;
     std::array<std::unique_ptr<ChoiceAttachment>, maxRoutes> delayRouteChannelAttach;
 
+    // Per-route sync division (Main / 1/1 … 1/16 dotted)
+    std::array<juce::ComboBox, maxRoutes> delayRouteDivisionBox;
+    std::array<std::unique_ptr<ChoiceAttachment>, maxRoutes> delayRouteDivisionAttach;
+
     // Per-route transpose sliders (-24 .. +24 semitones)
     std::array<juce::Slider,   maxRoutes> delayRouteTransposeSlider;
     std::array<std::unique_ptr<SliderAttachment>, maxRoutes> delayRouteTransposeAttach;
@@ -990,6 +1005,12 @@ private:
     std::unique_ptr<ButtonAttachment> panEnableAttach;
     std::unique_ptr<SliderAttachment> panWidthAttach;
 
+    // Multi-tap controls (per-tap rows live in DelayTapEditorComponent)
+    std::unique_ptr<LedToggleButton>  multiTapBtn;
+    juce::Label                       multiTapLabel;
+    juce::TextButton                  editTapsButton;
+    std::unique_ptr<ButtonAttachment> multiTapAttach;
+
     // Step sequencer sub-frame + controls
     // maxSeqSteps must match Params::maxSteps in DelayEngine.h (both = 8).
     static constexpr int maxSeqSteps = 8;
@@ -1,13 +1,13 @@
 #pragma once
-#include <JuceHeader.h>
+#include <juce_audio_basics/juce_audio_basics.h>
 #include <array>
-#include <unordered_map>
 #include <vector>
 #include <cmath>
 
 // The per-note EG embeds modztakt::eg::Engine — same params structure as the
 // main EG, so the user drives both from one set of knobs.
 #include "EnvelopeEngine.h"
+#include "MidiPortBuffers.h"
 
 namespace modztakt::delay
 {
@@ -70,6 +70,14 @@ namespace modztakt::delay
         // Semitone transpose applied to echoes per route. Range: -24 .. +24.
         std::array<int, maxDelayRoutes> routeTranspose { 0, 0, 0 };
 
+        // Output port per route (0 = main, see MidiOutputPorts.h).
+        std::array<int, maxDelayRoutes> routePorts { 0, 0, 0 };
+
+        // Per-route echo interval in ms (already sync-resolved by the processor).
+        // 0 = follow delayTimeMs.  Lets routes run polyrhythmic intervals
+        // (e.g. 1/8 on one channel, 1/8 dot on another) from the same schedule.
+        std::array<float, maxDelayRoutes> routeDelayTimeMs { 0.0f, 0.0f, 0.0f };
+
         // Per-note EG: when true each echo retriggers its own independent EG
         // using the parameters below (copied from the main EG APVTS params).
         bool perNoteEg = false;
@@ -92,6 +100,26 @@ namespace modztakt::delay
         // Odd echoes pan left (64 - deviation), even echoes pan right (64 + deviation).
         bool  panEnabled = false;
         float panWidth   = 0.5f;                                      
+
+        // Multi-tap: when multiTapEnabled, each input note schedules exactly one
+        // echo per active tap instead of the feedback chain across routes.
+        // Taps are independent (own time, velocity scale, transpose, channel),
+        // all queued into the same schedule as regular echoes.
+        // The feedback chain, routes and step sequencer are bypassed; per-note
+        // EG, auto-pan (alternating by tap index) and note-off patching still apply.
+        static constexpr int maxTaps = 8;
+
+        struct Tap
+        {
+            int   channel   = 0;       // 0 = Disabled, 1-16 = MIDI channel number
+            float timeMs    = 250.0f;  // offset from the input note-on (already sync-resolved)
+            float velScale  = 1.0f;    // 0.0 – 1.0, applied to the input velocity
+            int   transpose = 0;       // -24 .. +24 semitones
+            int   port      = 0;       // output port (0 = main)
+        };
+
+        bool multiTapEnabled = false;
+        std::array<Tap, maxTaps> taps {};
     };
 
     // ─────────────────────────────────────────────────────────────────────────
@@ -100,26 +128,43 @@ namespace modztakt::delay
     // ─────────────────────────────────────────────────────────────────────────
     struct PerNoteEgOutput
     {
-        // Max EG value (0..1) across all echoes currently sounding per channel.
-        // Index 0 is unused; indices 1..16 = MIDI channels.
-        std::array<float, 17> maxEg01 {};
+        // Max EG value (0..1) across all echoes currently sounding per port
+        // and channel: maxEg01[port][ch].  Channel index 0 is unused.
+        std::array<std::array<float, 17>, ports::maxPorts> maxEg01 {};
         bool hasAnyValue = false;
+
+        // The same values per echo, for MIDI 2.0 per-note controllers.
+        // Capacity matches the schedule cap (Engine::maxQueueSize).
+        struct NoteValue
+        {
+            int   port;
+            int   channel;
+            int   note;
+            float eg01;
+        };
+
+        static constexpr int maxNotes = 128;
+        std::array<NoteValue, maxNotes> notes {};
+        int numNotes = 0;
     };
 
     // ─────────────────────────────────────────────────────────────────────────
-    // Pre-note CC primer — returned by collectNoteOnPrefires() which the
-    // processor must call BEFORE processBlock().
+    // Note-on primer — handed to the processor's primer callback by
+    // processBlock() immediately BEFORE each echo note-on is written.
     //
-    // For each echo note-on due this block the processor injects a CC at
-    // sampleOffset carrying the initial EG value (0.0 = silence).  Because
-    // JUCE MidiBuffer preserves insertion order for equal timestamps, the CC
-    // lands before the note-on that processBlock() writes at the same offset,
-    // so the synth's volume is already set before the note event arrives.
+    // The callback injects pan / initial EG CCs at sampleOffset.  Because
+    // JUCE MidiBuffer preserves insertion order for equal timestamps, those
+    // CCs land before the note-on written right after the callback returns,
+    // so the synth's pan and volume are already set when the note arrives.
     // ─────────────────────────────────────────────────────────────────────────
-    struct NoteOnPrefire
+    struct NoteOnPrimer
     {
         int   channel;       // MIDI channel 1–16
+        int   port;          // output port the note-on is written to
+        int   note;          // outgoing (transposed) note number
         int   sampleOffset;  // position within the current block
+        int   panCcValue;    // 0..127 (bipolar centre = 64), -1 when auto-pan is off
+        bool  primeEg;       // true when perNoteEg is active
         float initialEg01;   // always 0.0f (attack always starts from silence)
     };
 
@@ -129,14 +174,18 @@ namespace modztakt::delay
     struct ScheduledNote
     {
         int    originalNote = 60;  // raw input note (used for noteOff matching)
+        int    sourceChannel = 1;  // input channel the strike arrived on (1 – 16)
+        juce::uint32 strikeId = 0; // identifies the input note-on this echo belongs to
         int    note         = 60;  // transposed note sent over MIDI
         int    velocity     = 64;  // MIDI 1 – 127
         int    channel      = 1;   // MIDI channel 1 – 16
+        int    port         = 0;   // output port (0 = main)
         double onTimeMs     = 0.0; // absolute time to fire note-on
         double offTimeMs    = 0.0; // absolute time to fire note-off (patchable)
         bool   noteOnFired  = false;
         bool   noteOffFired = false;
-        int    echoIndex    = 0;   // 0-based echo number; used for L/R pan alternation
+        int    echoIndex    = 0;   // 0-based echo number (tap index in multi-tap); L/R pan alternation
+        double maxDurMs     = 0.0; // echo length cap applied when the real note-off arrives
 
         // Per-note EG — one independent envelope engine per echo.
         // Only active when Params::perNoteEg is true.
@@ -184,19 +233,32 @@ namespace modztakt::delay
         // ── Call when a note-on passes the source-channel filter. ─────────────
         //
         //    Stores the note-start time and pre-queues all feedback echoes with a
-        //    *tentative* duration of 70 % of the delay interval.  If the real
+        //    *tentative* duration of 70 % of the delay interval (per route, see
+        //    Params::routeDelayTimeMs).  If the real
         //    note-off arrives before that expires, noteOff() will patch the stored
         //    offTimeMs for every pending echo of this note.
+        //    In multi-tap mode one echo per active tap is queued instead, each
+        //    with a tentative duration of 70 % of its tap time.
         //
         //    blockStartMs : absolute time (ms) of the first sample in this block.
+        //    channel      : input MIDI channel (1 – 16).
         //    note         : MIDI note number (0 – 127).
         //    vel01        : MIDI velocity normalised to 0.0 – 1.0.
         // ─────────────────────────────────────────────────────────────────────
-        void noteOn (int note, float vel01, double blockStartMs)
+        void noteOn (int channel, int note, float vel01, double blockStartMs)
         {
             if (!params.enabled)
                 return;
 
+            if (!isValidKey (channel, note))
+                return;
+
+            if (params.multiTapEnabled)
+            {
+                scheduleTaps (channel, note, vel01, blockStartMs);
+                return;
+            }
+
             bool anyRoute = false;
             for (int r = 0; r < maxDelayRoutes; ++r)
                 if (params.routeChannels[r] > 0) { anyRoute = true; break; }
@@ -204,12 +266,17 @@ namespace modztakt::delay
                 return;
 
             // Record note-start time so noteOff() can compute actual duration.
-            noteOnTimes[note] = blockStartMs;
+            const juce::uint32 strikeId = pushHeldStrike (channel, note, blockStartMs);
 
-            const double delayMs = juce::jmax (10.0, static_cast<double> (params.delayTimeMs));
+            // Resolve each route's interval once; routes sharing the main
+            // interval are the common case.
+            const double mainDelayMs = juce::jmax (10.0, static_cast<double> (params.delayTimeMs));
 
-            // Tentative echo duration: 70 % of delay interval (patched by noteOff if needed).
-            const double tentativeDurMs = delayMs * 0.70;
+            std::array<double, maxDelayRoutes> routeDelayMs {};
+            for (int r = 0; r < maxDelayRoutes; ++r)
+                routeDelayMs[r] = (params.routeDelayTimeMs[r] > 0.0f)
+                                ? juce::jmax (10.0, static_cast<double> (params.routeDelayTimeMs[r]))
+                                : mainDelayMs;
 
             float echoVel = vel01;
 
@@ -239,44 +306,24 @@ namespace modztakt::delay
                         continue;
                 }
 
-                const double onMs  = blockStartMs + static_cast<double> (echoIdx + 1) * delayMs;
-                const double offMs = onMs + tentativeDurMs;
                 const int    mVel  = juce::jlimit (1, 127,
                                          static_cast<int> (std::round (echoVel * 127.0f)));
 
+                // Echo-major order keeps the queue cap fair across routes.
                 for (int r = 0; r < maxDelayRoutes; ++r)
                 {
                     if (params.routeChannels[r] <= 0)
                         continue;
 
-                    if (scheduledNotes.size() >= maxQueueSize)
-                        return; // safety cap
+                    const double delayMs = routeDelayMs[r];
+                    const double onMs    = blockStartMs + static_cast<double> (echoIdx + 1) * delayMs;
 
-                    const int transposedNote = juce::jlimit (0, 127,
-                                                   note + params.routeTranspose[r]);
-
-                    ScheduledNote n;
-                    n.originalNote = note;           // raw note for noteOff matching
-                    n.note         = transposedNote; // what actually gets sent
-                    n.velocity     = mVel;
-                    n.channel      = params.routeChannels[r];
-                    n.onTimeMs     = onMs;
-                    n.offTimeMs    = offMs;
-                    n.noteOnFired  = false;
-                    n.noteOffFired = false;
-                    n.echoIndex    = echoIdx;
-
-                    // Per-note EG: set a tentative release start so the release
-                    // finishes exactly when the MIDI note-off fires.
-                    // If a real note-off arrives later, both values are patched
-                    // in noteOff() to reproduce the original hold duration.
-                    if (params.perNoteEg)
-                    {
-                        const double releaseMs = egReleaseMs (params.noteEgParams);
-                        n.egReleaseStartMs = juce::jmax (onMs, offMs - releaseMs);
-                    }
-
-                    scheduledNotes.push_back (n);
+                    // Tentative echo duration: 70 % of the route's interval (patched by noteOff if needed).
+                    if (!scheduleEcho (channel, note, strikeId,
+                                       note + params.routeTranspose[r],
+                                       mVel, params.routeChannels[r], params.routePorts[r],
+                                       onMs, delayMs * 0.70, echoIdx))
+                        return; // safety cap
                 }
             }
         }
@@ -288,38 +335,41 @@ namespace modztakt::delay
         //
         //        echo duration = min( inputDuration, 70 % of delayInterval )
         //
+        //    (delayInterval is the route interval, or the tap time for multi-tap echoes.)
+        //
         //    Echoes that have already fired their note-on are updated too, meaning
         //    even a "currently sounding" first echo will be shortened if the
         //    original note was released early.
         //
+        //    Overlapping re-strikes of the same key are paired first-in/first-out,
+        //    so each note-off only patches the echoes of the strike it releases.
+        //
         //    blockStartMs : approximate time (ms) of the note-off (block boundary).
         // ─────────────────────────────────────────────────────────────────────
-        void noteOff (int note, double blockStartMs)
+        void noteOff (int channel, int note, double blockStartMs)
         {
-            if (!params.enabled)
+            if (!params.enabled || !isValidKey (channel, note))
                 return;
 
-            auto it = noteOnTimes.find (note);
-            if (it == noteOnTimes.end())
+            HeldStrike strike;
+            if (!heldKeys[keyIndex (channel, note)].popOldest (strike))
                 return; // no matching note-on tracked
 
-            const double inputDurMs = blockStartMs - it->second;
-            noteOnTimes.erase (it);
+            const double inputDurMs = blockStartMs - strike.onTimeMs;
 
             if (inputDurMs <= 0.0)
                 return;
 
-            const double delayMs        = juce::jmax (10.0, static_cast<double> (params.delayTimeMs));
-            const double maxEchoDurMs   = delayMs * 0.70;
-            const double echoDurMs      = juce::jmin (inputDurMs, maxEchoDurMs);
-
-            // Patch all pending echoes for this note that haven't fired their note-off yet.
-            // Match on originalNote (the raw input pitch) because n.note may be transposed.
+            // Patch all pending echoes of this strike that haven't fired their note-off yet.
+            // Match on strikeId rather than n.note, which may be transposed.
             for (auto& n : scheduledNotes)
             {
-                if (n.originalNote != note || n.noteOffFired)
+                if (n.strikeId != strike.strikeId || n.noteOffFired)
                     continue;
 
+                // Each echo carries its own cap (70 % of its interval).
+                const double echoDurMs = juce::jmin (inputDurMs, n.maxDurMs);
+
                 if (params.perNoteEg)
                 {
                     // Reproduce the original hold duration on each echo:
@@ -339,104 +389,31 @@ namespace modztakt::delay
             }
         }
 
-        // ── Call this BEFORE processBlock when perNoteEg is active. ──────────
-        //
-        //    Scans scheduled notes and returns one NoteOnPrefire entry for every
-        //    echo whose note-on will fire during [blockStartMs, blockEndMs).
-        //    The processor uses these to inject an initial CC into the MIDI buffer
-        //    BEFORE calling processBlock so the CC timestamp precedes the note-on.
-        //
-        //    out is appended to (not cleared) so the caller can accumulate across
-        //    multiple calls if desired.
-        // ─────────────────────────────────────────────────────────────────────
-        void collectNoteOnPrefires (double                      blockStartMs,
-                                    int                         numSamples,
-                                    std::vector<NoteOnPrefire>& out) const
-        {
-            if (!params.perNoteEg)
-                return;
-
-            const double blockEndMs = blockStartMs
-                                    + static_cast<double> (numSamples) * msPerSample;
-
-            for (const auto& n : scheduledNotes)
-            {
-                if (n.noteOnFired || n.onTimeMs >= blockEndMs)
-                    continue;
-
-                out.push_back ({
-                    n.channel,
-                    msToSampleOffset (n.onTimeMs, blockStartMs, msPerSample, numSamples),
-                    0.0f   // EG always starts from silence (reset() before noteOn())
-                });
-            }
-        }
-
-        // ── Pan CC primer — call BEFORE processBlock when panEnabled is true. ──
-        //
-        //    For each echo note-on due this block, appends one PanPrefire entry.
-        //    The processor injects a pan CC at the given sample offset BEFORE
-        //    calling processBlock(), so the synth's pan is set before the note arrives.
-        //
-        //    Odd echoes pan left  (CC centre − deviation).
-        //    Even echoes pan right (CC centre + deviation).
-        // ─────────────────────────────────────────────────────────────────────
-        struct PanPrefire
-        {
-            int channel;
-            int sampleOffset;
-            int panCcValue;   // 0..127, bipolar centre = 64
-        };
-
-        void collectPanPrefires (double                   blockStartMs,
-                                 int                      numSamples,
-                                 std::vector<PanPrefire>& out) const
-        {
-            if (!params.panEnabled || params.panWidth <= 0.0f)
-                return;
-
-            const double blockEndMs  = blockStartMs
-                                     + static_cast<double> (numSamples) * msPerSample;
-            const int    deviation   = juce::roundToInt (params.panWidth * 63.0f);
-
-            for (const auto& n : scheduledNotes)
-            {
-                if (n.noteOnFired || n.onTimeMs >= blockEndMs)
-                    continue;
-
-                // Even echo index → right (+deviation), odd → left (−deviation).
-                const int pan = (n.echoIndex % 2 == 0)
-                              ? juce::jlimit (0, 127, 64 + deviation)
-                              : juce::jlimit (0, 127, 64 - deviation);
-
-                out.push_back ({
-                    n.channel,
-                    msToSampleOffset (n.onTimeMs, blockStartMs, msPerSample, numSamples),
-                    pan
-                });
-            }
-        }
-
         // ── Called every processBlock to flush due events into the output buffer.
-        //    Pass the same `midi` buffer that LFO / EG already write into.
+        //    Pass the same port buffers that LFO / EG already write into;
+        //    each echo goes to the port of the route (or tap) that queued it.
+        //
+        //    Single pass over the schedule: for every echo note-on due this
+        //    block, primeNoteOn (const NoteOnPrimer&) is invoked first so the
+        //    processor can inject pan / initial EG CCs, then the note-on is
+        //    written; note-offs, per-note EG advance and pruning of dispatched
+        //    events all happen in the same walk.
         //
         //    When Params::perNoteEg is true, each echo retriggers its own embedded
         //    EG.  After this call, read getPerNoteEgOutput() to obtain the max EG
-        //    value per MIDI channel (use it to send a volume CC from the processor).
-        //
-        //    IMPORTANT: when perNoteEg is true, call collectNoteOnPrefires() and
-        //    inject the returned CCs into the same midi buffer BEFORE this call so
-        //    the synth receives volume=0 before the incoming note event.
+        //    value per port and MIDI channel (use it to send a volume CC from the
+        //    processor).
         // ─────────────────────────────────────────────────────────────────────
-        void processBlock (int               numSamples,
-                           double            blockStartMs,
-                           juce::MidiBuffer& midi)
+        template <typename PrimerFn>
+        void processBlock (int                       numSamples,
+                           double                    blockStartMs,
+                           const ports::PortBuffers& out,
+                           PrimerFn&&                primeNoteOn)
         {
             if (!params.enabled)
             {
-                scheduledNotes.clear();
-                noteOnTimes.clear();
-                perNoteEgOutput = {};
+                // Disabled while echoes sound: release them, don't leave them hanging
+                clearEchoes (out);
                 return;
             }
 
@@ -446,14 +423,34 @@ namespace modztakt::delay
             const double blockEndMs = blockStartMs
                                     + static_cast<double> (numSamples) * msPerSample;
 
-            for (auto& n : scheduledNotes)
+            // Pan deviation is constant for the block.
+            const bool panActive = params.panEnabled && params.panWidth > 0.0f;
+            const int  deviation = juce::roundToInt (params.panWidth * 63.0f);
+
+            std::size_t keep = 0;
+
+            for (std::size_t i = 0; i < scheduledNotes.size(); ++i)
             {
+                auto& n = scheduledNotes[i];
+
                 // ── Note-on ─────────────────────────────────────────────────
                 if (!n.noteOnFired && n.onTimeMs < blockEndMs)
                 {
                     const int offset = msToSampleOffset (n.onTimeMs, blockStartMs,
                                                          msPerSample, numSamples);
-                    midi.addEvent (
+
+                    // Even echo index → right (+deviation), odd → left (−deviation).
+                    int pan = -1;
+                    if (panActive)
+                        pan = (n.echoIndex % 2 == 0)
+                            ? juce::jlimit (0, 127, 64 + deviation)
+                            : juce::jlimit (0, 127, 64 - deviation);
+
+                    if (panActive || params.perNoteEg)
+                        primeNoteOn (NoteOnPrimer { n.channel, n.port, n.note, offset, pan,
+                                                    params.perNoteEg, 0.0f });
+
+                    out[n.port].addEvent (
                         juce::MidiMessage::noteOn (n.channel, n.note,
                                                    static_cast<juce::uint8> (n.velocity)),
                         offset);
@@ -477,7 +474,7 @@ namespace modztakt::delay
                 {
                     const int offset = msToSampleOffset (n.offTimeMs, blockStartMs,
                                                          msPerSample, numSamples);
-                    midi.addEvent (
+                    out[n.port].addEvent (
                         juce::MidiMessage::noteOff (n.channel, n.note),
                         offset);
                     n.noteOffFired = true;
@@ -492,18 +489,13 @@ namespace modztakt::delay
                         n.egNoteOffFired = true;
                     }
                 }
-            }
 
-            // ── Advance per-note EGs and accumulate max per channel ──────────
-            // This is a separate second pass so all note-on / note-off events
-            // for this block have already been applied before the EG advances.
-            if (params.perNoteEg)
-            {
-                for (auto& n : scheduledNotes)
+                // ── Advance per-note EG and accumulate max per channel ───────
+                // Runs after this echo's note-on / note-off for the block have
+                // been applied; echoes are independent, so doing it per entry is
+                // equivalent to a separate pass.
+                if (params.perNoteEg && n.noteEgStarted && n.noteOnFired && !n.noteOffFired)
                 {
-                    if (!n.noteEgStarted || !n.noteOnFired || n.noteOffFired)
-                        continue;
-
                     // ── Trigger EG release at the scheduled time ─────────────
                     // This fires BEFORE offTimeMs so the release stage plays out
                     // while the echo is still sounding; offTimeMs was extended
@@ -519,26 +511,38 @@ namespace modztakt::delay
                     double eg01 = 0.0;
                     if (n.noteEg.processBlock (numSamples, eg01))
                     {
-                        const auto ch = static_cast<std::size_t> (n.channel);
-                        if (ch >= 1 && ch <= 16)
+                        const auto ch   = static_cast<std::size_t> (n.channel);
+                        const auto port = static_cast<std::size_t> (n.port);
+                        if (ch >= 1 && ch <= 16 && port < ports::maxPorts)
                         {
-                            perNoteEgOutput.maxEg01[ch] =
-                                juce::jmax (perNoteEgOutput.maxEg01[ch],
-                                            static_cast<float> (eg01));
+                            auto& slot = perNoteEgOutput.maxEg01[port][ch];
+                            slot = juce::jmax (slot, static_cast<float> (eg01));
+
+                            if (perNoteEgOutput.numNotes < PerNoteEgOutput::maxNotes)
+                                perNoteEgOutput.notes[static_cast<std::size_t> (perNoteEgOutput.numNotes++)]
+                                    = { n.port, n.channel, n.note, static_cast<float> (eg01) };
                             perNoteEgOutput.hasAnyValue = true;
                         }
                     }
                 }
+
+                // Prune fully-dispatched events in place (stable, no allocation).
+                if (n.noteOnFired && n.noteOffFired)
+                    continue;
+
+                if (keep != i)
+                    scheduledNotes[keep] = std::move (n);
+                ++keep;
             }
 
-            // Prune fully-dispatched events.
-            scheduledNotes.erase (
-                std::remove_if (scheduledNotes.begin(), scheduledNotes.end(),
-                                [](const ScheduledNote& sn)
-                                {
-                                    return sn.noteOnFired && sn.noteOffFired;
-                                }),
-                scheduledNotes.end());
+            scheduledNotes.resize (keep);
+        }
+
+        // Convenience overload: single output, no primer CCs.
+        void processBlock (int numSamples, double blockStartMs, juce::MidiBuffer& midi)
+        {
+            processBlock (numSamples, blockStartMs, ports::PortBuffers::allTo (midi),
+                          [] (const NoteOnPrimer&) {});
         }
 
         // ── Per-note EG output (valid after each processBlock call) ───────────
@@ -553,26 +557,127 @@ namespace modztakt::delay
         //    Used by PluginProcessor to determine which channels to send
         //    EG-volume / EG-track-level CC to when delayEgShape is active.
         //
-        //    out[1]..out[16] are set to true if that channel has at least one
-        //    echo currently sounding.  out[0] is always left false.
+        //    out[port][1]..out[port][16] are set to true if that channel has at
+        //    least one echo currently sounding on that port.  out[port][0] is
+        //    always left false.
         // ─────────────────────────────────────────────────────────────────────
-        void getActiveSoundingChannels (std::array<bool, 17>& out) const noexcept
+        void getActiveSoundingChannels (std::array<std::array<bool, 17>, ports::maxPorts>& out) const noexcept
         {
-            out.fill (false);
+            for (auto& p : out)
+                p.fill (false);
+
             for (const auto& n : scheduledNotes)
                 if (n.noteOnFired && !n.noteOffFired)
-                    out[static_cast<std::size_t> (n.channel)] = true;
+                    out[static_cast<std::size_t> (n.port)][static_cast<std::size_t> (n.channel)] = true;
         }
 
         // ── Hard-clear all pending echoes (call from prepareToPlay) ──────────
+        //    Also reserves the schedule up to maxQueueSize so noteOn() never
+        //    reallocates on the audio thread.
         void reset()
         {
             scheduledNotes.clear();
-            noteOnTimes.clear();
+            scheduledNotes.reserve (maxQueueSize);
+            clearHeldKeys();
+            perNoteEgOutput = {};
+        }
+
+        // Echoes queued or sounding (0 once everything has been released)
+        int getNumScheduled() const noexcept { return static_cast<int> (scheduledNotes.size()); }
+
+        // ── Drop pending echoes on the audio thread (preset recall) ──────────
+        //    Echoes already sounding get their note-off at the block start so
+        //    nothing hangs; no allocation (the schedule keeps its capacity).
+        void clearEchoes (const ports::PortBuffers& out)
+        {
+            for (const auto& n : scheduledNotes)
+                if (n.noteOnFired && !n.noteOffFired)
+                    out[n.port].addEvent (juce::MidiMessage::noteOff (n.channel, n.note), 0);
+
+            scheduledNotes.clear();
+            clearHeldKeys();
             perNoteEgOutput = {};
         }
 
     private:
+        // Multi-tap scheduling: one echo per active tap, all on the shared schedule.
+        void scheduleTaps (int channel, int note, float vel01, double blockStartMs)
+        {
+            bool anyTap = false;
+            for (const auto& tap : params.taps)
+                if (tap.channel > 0) { anyTap = true; break; }
+            if (!anyTap)
+                return;
+
+            const juce::uint32 strikeId = pushHeldStrike (channel, note, blockStartMs);
+
+            for (int t = 0; t < Params::maxTaps; ++t)
+            {
+                const auto& tap = params.taps[static_cast<std::size_t> (t)];
+                if (tap.channel <= 0)
+                    continue;
+
+                const float tapVel = vel01 * juce::jlimit (0.0f, 1.0f, tap.velScale);
+                if (tapVel < (1.0f / 127.0f))
+                    continue;
+
+                const double tapMs = juce::jmax (10.0, static_cast<double> (tap.timeMs));
+                const int    mVel  = juce::jlimit (1, 127,
+                                         static_cast<int> (std::round (tapVel * 127.0f)));
+
+                if (!scheduleEcho (channel, note, strikeId, note + tap.transpose,
+                                   mVel, tap.channel, tap.port, blockStartMs + tapMs,
+                                   tapMs * 0.70, t))
+                    return; // safety cap
+            }
+        }
+
+        // Queue one echo.  Returns false once the schedule is full.
+        //    maxDurMs : tentative duration, and the cap noteOff() applies later.
+        bool scheduleEcho (int sourceChannel, int note, juce::uint32 strikeId,
+                           int outNote, int velocity, int outChannel, int outPort,
+                           double onMs, double maxDurMs, int echoIdx)
+        {
+            if (scheduledNotes.size() >= maxQueueSize)
+                return false;
+
+            ScheduledNote n;
+            n.originalNote  = note;          // raw note for noteOff matching
+            n.sourceChannel = sourceChannel;
+            n.strikeId      = strikeId;
+            n.note          = juce::jlimit (0, 127, outNote); // what actually gets sent
+            n.velocity      = velocity;
+            n.channel       = outChannel;
+            n.port          = juce::jlimit (0, ports::maxPorts - 1, outPort);
+            n.onTimeMs      = onMs;
+            n.offTimeMs     = onMs + maxDurMs;
+            n.noteOnFired   = false;
+            n.noteOffFired  = false;
+            n.echoIndex     = echoIdx;
+            n.maxDurMs      = maxDurMs;
+
+            // Per-note EG: set a tentative release start so the release
+            // finishes exactly when the MIDI note-off fires.
+            // If a real note-off arrives later, both values are patched
+            // in noteOff() to reproduce the original hold duration.
+            if (params.perNoteEg)
+            {
+                const double releaseMs = egReleaseMs (params.noteEgParams);
+                n.egReleaseStartMs = juce::jmax (onMs, n.offTimeMs - releaseMs);
+            }
+
+            scheduledNotes.push_back (n);
+            return true;
+        }
+
+        juce::uint32 pushHeldStrike (int channel, int note, double blockStartMs) noexcept
+        {
+            const juce::uint32 strikeId = ++strikeCounter;
+            heldKeys[keyIndex (channel, note)].push ({ blockStartMs, strikeId });
+            anyKeyHeld = true;
+            return strikeId;
+        }
+
         // Convert an absolute timestamp to a sample offset within the current block.
         static int msToSampleOffset (double eventMs, double blockStartMs,
                                      double msPrSample, int numSamples) noexcept
@@ -600,9 +705,79 @@ namespace modztakt::delay
         static constexpr std::size_t maxQueueSize = 128;
         std::vector<ScheduledNote> scheduledNotes;
 
+        // ── Held-key table ───────────────────────────────────────────────────
         // Tracks note-start times so noteOff() can compute input note duration.
-        // Key = MIDI note number (0–127), Value = blockStartMs at note-on.
-        std::unordered_map<int, double> noteOnTimes;
+        // Flat [channel][note] table, allocation-free on the audio thread.
+        // Each key keeps a small FIFO so fast re-strikes before release each
+        // get their own duration; the oldest strike is dropped when it is full.
+        struct HeldStrike
+        {
+            double       onTimeMs = 0.0;
+            juce::uint32 strikeId = 0;
+        };
+
+        struct HeldKey
+        {
+            static constexpr int maxStack = 4;
+            std::array<HeldStrike, maxStack> strikes {};
+            int count = 0;
+
+            void push (const HeldStrike& s) noexcept
+            {
+                if (count == maxStack)
+                    popFront();
+
+                strikes[static_cast<std::size_t> (count++)] = s;
+            }
+
+            bool popOldest (HeldStrike& out) noexcept
+            {
+                if (count == 0)
+                    return false;
+
+                out = strikes[0];
+                popFront();
+                return true;
+            }
+
+            void popFront() noexcept
+            {
+                for (int i = 1; i < count; ++i)
+                    strikes[static_cast<std::size_t> (i - 1)] = strikes[static_cast<std::size_t> (i)];
+                --count;
+            }
+        };
+
+        static constexpr int numKeyChannels = 16;
+        static constexpr int numKeyNotes    = 128;
+
+        static bool isValidKey (int channel, int note) noexcept
+        {
+            return channel >= 1 && channel <= numKeyChannels
+                && note >= 0 && note < numKeyNotes;
+        }
+
+        static std::size_t keyIndex (int channel, int note) noexcept
+        {
+            return static_cast<std::size_t> ((channel - 1) * numKeyNotes + note);
+        }
+
+        // Cheap when nothing was struck since the last clear (the disabled
+        // path calls this every block).
+        void clearHeldKeys() noexcept
+        {
+            if (!anyKeyHeld)
+                return;
+
+            for (auto& k : heldKeys)
+                k.count = 0;
+
+            anyKeyHeld = false;
+        }
+
+        std::array<HeldKey, numKeyChannels * numKeyNotes> heldKeys {};
+        juce::uint32 strikeCounter = 0;
+        bool anyKeyHeld = false;
 
         // Per-note EG output — rebuilt each processBlock() when perNoteEg is active.
         PerNoteEgOutput perNoteEgOutput;
@@ -0,0 +1,249 @@
+#pragma once
+#include <JuceHeader.h>
+
+#include "Cosmetic.h"
+#include "DelayEngine.h"
+#include "UiRefresh.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Multi-tap editor — shown in a CallOutBox from DelayEditorComponent.
+//
+// One row per tap:
+//   [Tap N | Channel | Port | Sync | Time | Velocity | Transpose]
+//
+// Every control is bound to its "delayTap{t}_*" APVTS parameter, so the
+// callout can be opened and dismissed freely without owning any state.
+// Row dimming follows delay parameter changes through the editor's
+// RefreshScheduler while the callout is open.
+// ─────────────────────────────────────────────────────────────────────────────
+class DelayTapEditorComponent : public juce::Component
+{
+public:
+    using APVTS            = juce::AudioProcessorValueTreeState;
+    using SliderAttachment = APVTS::SliderAttachment;
+    using ChoiceAttachment = APVTS::ComboBoxAttachment;
+
+    static constexpr int maxTaps = modztakt::delay::Params::maxTaps;
+
+    static constexpr int rowHeight = 24;
+    static constexpr int rowGap    = 6;
+
+    DelayTapEditorComponent (APVTS& apvtsRef, modztakt::ui::RefreshScheduler& uiRefresh)
+        : apvts (apvtsRef),
+          refreshSubscription (uiRefresh.subscribeScoped (modztakt::ui::Changed::delayParams,
+                                                          [this] (uint32_t) { updateRowStates(); }))
+    {
+        setName ("Delay Taps");
+
+        for (const auto* h : { "Tap", "Channel", "Port", "Sync", "Time", "Velocity", "Transpose" })
+        {
+            auto* l = headerLabels.add (new juce::Label ({}, h));
+            l->setColour (juce::Label::textColourId, SetupUI::labelsColor);
+            l->setJustificationType (juce::Justification::centredLeft);
+            addAndMakeVisible (l);
+        }
+
+        for (int t = 0; t < maxTaps; ++t)
+        {
+            const auto ts = "delayTap" + juce::String (t);
+            auto& row = rows[(size_t) t];
+
+            row.label.setText (juce::String (t + 1), juce::dontSendNotification);
+            row.label.setColour (juce::Label::textColourId, SetupUI::labelsColor);
+            addAndMakeVisible (row.label);
+
+            // ComboBox IDs: 1 = Disabled, 2..17 = Ch1..Ch16
+            row.channelBox.addItem ("Disabled", 1);
+            for (int ch = 1; ch <= 16; ++ch)
+                row.channelBox.addItem ("Ch " + juce::String (ch), ch + 1);
+            addAndMakeVisible (row.channelBox);
+            row.channelAttach = std::make_unique<ChoiceAttachment> (
+                apvts, ts + "_channel", row.channelBox);
+
+            // ComboBox IDs: 1 = Main, 2..4 = Port 2..4
+            row.portBox.addItemList (modztakt::ports::makePortChoices(), 1);
+            addAndMakeVisible (row.portBox);
+            row.portAttach = std::make_unique<ChoiceAttachment> (
+                apvts, ts + "_port", row.portBox);
+
+            // Same list as the main delay "Sync" box.
+            row.divisionBox.addItemList ({ "Free",
+                                           "1/1", "1/2", "1/4", "1/8", "1/16", "1/32",
+                                           "1/8 dot", "1/16 dot" }, 1);
+            addAndMakeVisible (row.divisionBox);
+            row.divisionAttach = std::make_unique<ChoiceAttachment> (
+                apvts, ts + "_division", row.divisionBox);
+
+            // Attachments are created BEFORE the setup helpers so APVTS sets the range.
+            row.timeAttach = std::make_unique<SliderAttachment> (apvts, ts + "_time", row.timeSlider);
+            setupTimeSlider (row.timeSlider);
+
+            row.velocityAttach = std::make_unique<SliderAttachment> (apvts, ts + "_velocity", row.velocitySlider);
+            setupVelocitySlider (row.velocitySlider);
+
+            row.transposeAttach = std::make_unique<SliderAttachment> (apvts, ts + "_transpose", row.transposeSlider);
+            setupTransposeSlider (row.transposeSlider);
+        }
+
+        setSize (690, (rowHeight + rowGap) * (maxTaps + 1) + 12);
+
+        updateRowStates();
+    }
+
+    ~DelayTapEditorComponent() override
+    {
+        // Reset all APVTS attachments before components are destroyed.
+        for (auto& row : rows)
+        {
+            row.channelAttach.reset();
+            row.portAttach.reset();
+            row.divisionAttach.reset();
+            row.timeAttach.reset();
+            row.velocityAttach.reset();
+            row.transposeAttach.reset();
+
+            row.timeSlider.setLookAndFeel (nullptr);
+            row.velocitySlider.setLookAndFeel (nullptr);
+            row.transposeSlider.setLookAndFeel (nullptr);
+        }
+    }
+
+    void paint (juce::Graphics& g) override
+    {
+        g.fillAll (SetupUI::background);
+    }
+
+    void resized() override
+    {
+        auto area = getLocalBounds().reduced (8, 6);
+
+        // Column widths: Tap | Channel | Port | Sync | Time | Velocity | Transpose
+        const std::array<int, 7> widths { 36, 90, 70, 84, 150, 110, 0 };
+
+        auto layoutColumns = [&] (juce::Rectangle<int> row, std::array<juce::Component*, 7> comps)
+        {
+            for (size_t c = 0; c < comps.size(); ++c)
+            {
+                auto cell = (widths[c] > 0) ? row.removeFromLeft (widths[c]) : row;
+                comps[c]->setBounds (cell.reduced (2, 0));
+            }
+        };
+
+        {
+            auto header = area.removeFromTop (rowHeight);
+            layoutColumns (header, { headerLabels[0], headerLabels[1], headerLabels[2], headerLabels[3],
+                                     headerLabels[4], headerLabels[5], headerLabels[6] });
+            area.removeFromTop (rowGap);
+        }
+
+        for (auto& row : rows)
+        {
+            layoutColumns (area.removeFromTop (rowHeight),
+                           { &row.label, &row.channelBox, &row.portBox, &row.divisionBox,
+                             &row.timeSlider, &row.velocitySlider, &row.transposeSlider });
+            area.removeFromTop (rowGap);
+        }
+    }
+
+private:
+    // ── Grey the time slider of synced taps, dim disabled taps ───────────────
+    void updateRowStates()
+    {
+        for (int t = 0; t < maxTaps; ++t)
+        {
+            auto& row = rows[(size_t) t];
+
+            const bool active = row.channelBox.getSelectedId() > 1;
+            const bool synced = row.divisionBox.getSelectedId() > 1;
+
+            const float a = active ? 1.0f : 0.45f;
+            row.label.setAlpha (a);
+            row.portBox.setAlpha (a);
+            row.divisionBox.setAlpha (a);
+            row.velocitySlider.setAlpha (a);
+            row.transposeSlider.setAlpha (a);
+
+            // Free time is overridden by the sync division (when a clock runs).
+            row.timeSlider.setEnabled (!synced);
+            row.timeSlider.setAlpha (synced ? 0.40f : a);
+        }
+    }
+
+    // ── Slider setup helpers ──────────────────────────────────────────────────
+    void setupTimeSlider (juce::Slider& s)
+    {
+        addAndMakeVisible (s);
+        s.setSliderStyle (juce::Slider::LinearHorizontal);
+        s.setTextBoxStyle (juce::Slider::TextBoxRight, false, 56, 20);
+        s.setLookAndFeel (&lookGreen);
+
+        s.textFromValueFunction = [] (double v) -> juce::String
+        {
+            if (v < 1000.0)
+                return juce::String (static_cast<int> (v)) + " ms";
+            return juce::String (v / 1000.0, 2) + " s";
+        };
+
+        s.updateText();
+    }
+
+    void setupVelocitySlider (juce::Slider& s)
+    {
+        addAndMakeVisible (s);
+        s.setSliderStyle (juce::Slider::LinearHorizontal);
+        s.setTextBoxStyle (juce::Slider::TextBoxRight, false, 44, 20);
+        s.setLookAndFeel (&lookOrange);
+
+        s.textFromValueFunction = [] (double v) -> juce::String
+        {
+            return juce::String (static_cast<int> (std::round (v * 100.0))) + " %";
+        };
+
+        s.updateText();
+    }
+
+    // Mirrors DelayEditorComponent::setupTransposeSlider (-24 .. +24 st).
+    void setupTransposeSlider (juce::Slider& s)
+    {
+        addAndMakeVisible (s);
+        s.setSliderStyle (juce::Slider::LinearHorizontal);
+        s.setTextBoxStyle (juce::Slider::TextBoxRight, false, 44, 20);
+        s.setLookAndFeel (&lookPurple);
+
+        s.textFromValueFunction = [] (double v) -> juce::String
+        {
+            const int st = static_cast<int> (v);
+            if (st == 0)  return "0 st";
+            if (st  > 0)  return "+" + juce::String (st) + " st";
+            return               juce::String (st) + " st";
+        };
+
+        s.updateText();
+    }
+
+    // ─────────────────────────────────────────────────────────────────────────
+    APVTS& apvts;
+
+    struct TapRow
+    {
+        juce::Label    label;
+        juce::ComboBox channelBox, portBox, divisionBox;
+        juce::Slider   timeSlider, velocitySlider, transposeSlider;
+
+        std::unique_ptr<ChoiceAttachment> channelAttach, portAttach, divisionAttach;
+        std::unique_ptr<SliderAttachment> timeAttach, velocityAttach, transposeAttach;
+    };
+
+    // Look & Feel instances first: the rows' sliders reference them.
+    ModzTaktLookAndFeel lookGreen  { SetupUI::sliderTrackGreen };
+    ModzTaktLookAndFeel lookOrange { SetupUI::sliderTrackOrange };
+    ModzTaktLookAndFeel lookPurple { SetupUI::sliderTrackPurple };
+
+    juce::OwnedArray<juce::Label>  headerLabels;
+    std::array<TapRow, maxTaps>    rows;
+
+    // Last: ends before the rows it refreshes are destroyed
+    modztakt::ui::RefreshScheduler::Subscription refreshSubscription;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayTapEditorComponent)
+};
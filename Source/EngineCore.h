@@ -0,0 +1,811 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <climits>
+#include <memory>
+
+#include "SyntaktParameterTable.h"
+#include "InstrumentMap.h"
+#include "IncomingControllers.h"
+#include "LfoEngine.h"
+#include "EnvelopeEngine.h"
+#include "DelayEngine.h"
+#include "MidiPortBuffers.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Engine core: the LFO, EG and delay engines and the one send path behind them
+//
+// The plugin's processBlock() owns a Core and hands it every generated
+// message; hosts that are not a plugin or the standalone app (e.g. a headless
+// box next to the Syntakt) link it as a static library
+// (Engine/ModzTakt_engine.jucer).  Only juce_core and juce_audio_basics are
+// needed: no APVTS, no GUI, no audio / MIDI devices.
+//
+// Headless hosts drive a whole block from plain settings (the same Params
+// structs the plugin fills from its parameters):
+//
+//     modztakt::engine::Core core;
+//     core.prepare (48000.0);
+//     core.setSettings (settings);                 // between blocks
+//     core.process (midiIn, midiOut, numSamples);  // once per block
+//
+// The plugin runs the two stages of a block itself, with its own note
+// handling, LFO start / stop state machine, clock sync and transport in
+// between:
+//
+//     const bool egHasValue = core.processEnvelope (numSamples, egEnabled);
+//     ...                                          // EG can force the LFO on
+//     core.render (block, sink);
+//
+// render() is the send path for everything generated: LFO routes (through
+// lfo::renderBlock()), EG routes, EG shaping of the delay echoes, the echoes
+// with their pan / EG primers, and per-note EG.  Each value goes through the
+// curve compression, the data throttle and the rate limiter, then out as
+// CC / CC pair / NRPN, or as a MIDI 2.0 packet on MIDI 2.0 ports.  `sink` is
+// the caller's output ports for the block:
+//
+//     const ports::PortBuffers& buffers();     // MIDI 1.0 buffer per port
+//     bool isUmp (int port);                   // MIDI 2.0 port: packets through addUmp
+//     void addUmp (int port, int offset, const juce::ump::PacketX2&);
+//     void lfoSent (int route, double sent01, int offset);   // LFO value that went out
+//     void oneShotFinished (int route);
+//
+// process() leaves out what belongs to a host: MIDI clock sync (pass rates /
+// delay times already resolved), transport, devices and MIDI 2.0.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::engine
+{
+    static constexpr int maxLfoRoutes = lfo::maxRoutes;
+    static constexpr int maxEgRoutes  = 3;
+
+    struct LfoSettings
+    {
+        bool          running = false;
+        lfo::LfoShape shape   = lfo::LfoShape::Sine;
+        double        rateHz  = 1.0;
+        double        depth   = 1.0;             // 0..1
+
+        bool egToRate  = false;                  // EG scales rate / depth while it has a value
+        bool egToDepth = false;
+
+        int noteRestartChannel = 0;              // 0 = off, 1..16: note-ons restart the phase
+
+        struct Route
+        {
+            int  channel    = 0;                 // 0 = disabled, 1..16
+            int  paramIndex = -1;
+            bool bipolar    = false;
+            bool invert     = false;
+            bool oneShot    = false;
+        };
+
+        std::array<Route, maxLfoRoutes> routes {};
+    };
+
+    // Destination of one EG route
+    struct EgRoute
+    {
+        int channel    = 0;                      // 0 = disabled, 1..16
+        int paramIndex = -1;
+        int port       = 0;                      // output port (0 = main)
+
+        bool operator== (const EgRoute& o) const noexcept
+        {
+            return channel == o.channel && paramIndex == o.paramIndex && port == o.port;
+        }
+
+        bool operator!= (const EgRoute& o) const noexcept { return ! (*this == o); }
+    };
+
+    struct EgSettings
+    {
+        eg::Params params;
+        int sourceChannel = 1;
+
+        std::array<EgRoute, maxEgRoutes> routes {};
+    };
+
+    struct DelaySettings
+    {
+        delay::Params params;                    // panEnabled needs a Role::Pan entry in the map
+        int sourceChannel = 1;
+
+        int  egShape   = 0;                      // EG shaping of the echoes: 0 = off, 1 = volume, 2 = level
+        bool egPerNote = false;                  // with egShape: one EG per echo instead of the main EG
+    };
+
+    struct Settings
+    {
+        LfoSettings   lfo;
+        EgSettings    eg;
+        DelaySettings delay;
+
+        int    changeThreshold = 1;              // 7-bit steps, as "midiDataThrottle"
+        double rateLimitMs     = 0.0;            // as "midiRateLimiter" (0 = off)
+        double curveTolerance  = 0.0;            // 7-bit steps, as "midiCurveTolerance" (0 = off)
+        bool   knobFollow      = false;          // modulate around the knob positions received
+        bool   passThrough     = true;           // copy the input to the output
+    };
+
+    // One block of output for render(), resolved by the caller
+    struct Block
+    {
+        const instrument::InstrumentMap* map = nullptr;   // parameter indices point into it
+        double startMs    = 0.0;
+        int    numSamples = 0;
+
+        bool             lfoRunning = false;
+        lfo::BlockParams lfo;                    // before EG modulation
+        bool             egToLfoRate  = false;
+        bool             egToLfoDepth = false;
+
+        std::array<EgRoute, maxEgRoutes> egRoutes {};
+
+        bool delayEnabled       = false;
+        int  delayEgParamIndex  = -1;            // EG shaping destination, -1 = off
+        bool delayEgPerNote     = false;         // per-note EG (Params::perNoteEg) instead of the main EG
+        int  delayPanParamIndex = -1;            // auto-pan destination, -1 = none
+
+        int    changeThreshold = 1;
+        double rateLimitMs     = 0.0;
+        double curveTolerance  = 0.0;
+        bool   knobFollow      = false;
+    };
+
+    class Core
+    {
+    public:
+        // `instrumentMap` serves setSettings() / process().  A caller that only
+        // uses render() passes its map in each Block and may pass nullptr here.
+        explicit Core (std::unique_ptr<const instrument::InstrumentMap> instrumentMap = instrument::InstrumentMap::createBuiltIn())
+            : map (std::move (instrumentMap))
+        {
+            resetSendState();
+        }
+
+        // Sample rate for every engine; drops echoes, envelopes and the send
+        // state.  LFO phases carry on (reset() restarts them).
+        void prepare (double sampleRate)
+        {
+            sr = juce::jmax (1.0, sampleRate);
+            msPerSample = 1000.0 / sr;
+
+            egEngine.setSampleRate (sr);
+            egEngine.reset();
+            delayEngine.setSampleRate (sr);
+            delayEngine.reset();
+
+            resetSendState();
+        }
+
+        // ── Headless hosts ────────────────────────────────────────────────────
+
+        void setSettings (const Settings& newSettings)
+        {
+            jassert (map != nullptr);
+
+            const auto previousLfo = settings.lfo;
+            settings = newSettings;
+
+            egEngine.setParams (settings.eg.params);
+            delayEngine.setParams (makeDelayParams());
+
+            for (int r = 0; r < maxLfoRoutes; ++r)
+            {
+                const auto& was = previousLfo.routes[(size_t) r];
+                const auto& now = settings.lfo.routes[(size_t) r];
+
+                namespace RouteFlag = lfo::RouteFlag;
+                uint8_t flags = 0;
+                if (now.bipolar) flags |= RouteFlag::bipolar;
+                if (now.invert)  flags |= RouteFlag::invert;
+                if (now.oneShot) flags |= RouteFlag::oneShot;
+
+                // Random ignores these (see LfoRouteSync.h)
+                if (settings.lfo.shape == lfo::LfoShape::Random)
+                    flags &= (uint8_t) ~(RouteFlag::bipolar | RouteFlag::invert);
+
+                lfoRoutes.channel[(size_t) r]    = juce::jmax (0, now.channel);
+                lfoRoutes.paramIndex[(size_t) r] = map->isValidIndex (now.paramIndex) ? now.paramIndex : -1;
+                lfoRoutes.flags[(size_t) r]      = (uint8_t) ((lfoRoutes.flags[(size_t) r] & RouteFlag::runtime) | flags);
+
+                if (was.channel != now.channel || was.paramIndex != now.paramIndex
+                    || was.bipolar != now.bipolar || was.invert != now.invert || was.oneShot != now.oneShot)
+                    restartLfoRoute (r);
+            }
+
+            lfoRoutes.updateActive();
+
+            if (settings.lfo.running && ! previousLfo.running)
+                restartLfo();
+        }
+
+        const Settings& getSettings() const noexcept { return settings; }
+
+        // Appends this block's output to `out` (input copied first when passThrough).
+        // `in` and `out` must be different buffers.
+        void process (const juce::MidiBuffer& in, juce::MidiBuffer& out, int numSamples)
+        {
+            jassert (map != nullptr);
+
+            for (const auto meta : in)
+            {
+                const auto msg = meta.getMessage();
+
+                if (settings.passThrough)
+                    out.addEvent (msg, meta.samplePosition);
+
+                handleInput (msg, timeMs);
+            }
+
+            // Knob positions sent back by the synth (always tracked, used when knobFollow is on)
+            incomingControllers.process (in, *map);
+
+            processEnvelope (numSamples, settings.eg.params.enabled);
+
+            MidiSink sink { ports::PortBuffers::allTo (out) };
+            render (makeBlock (numSamples), sink);
+
+            timeMs += numSamples * msPerSample;
+        }
+
+        // Drops every echo and envelope; LFO phases go back to their start.
+        void reset()
+        {
+            delayEngine.reset();
+            egEngine.reset();
+            restartLfo();
+            incomingControllers.reset();
+            resetSendState();
+        }
+
+        double getTimeMs() const noexcept { return timeMs; }
+        int getPendingEchoCount() const noexcept { return delayEngine.getNumScheduled(); }
+
+        // State after the last block, for checks (e.g. MidiStressTest.cpp)
+        double getEgValue() const noexcept { return eg01; }
+        const lfo::RouteTable<maxLfoRoutes>& getLfoRoutes() const noexcept { return lfoRoutes; }
+        const instrument::InstrumentMap& getInstrumentMap() const noexcept { return *map; }
+
+        // ── Block stages (process(), or the plugin's processBlock) ────────────
+
+        // Advances the main EG by one block.  Returns true while it has a value
+        // (render() then sends it and modulates the LFO with it).
+        bool processEnvelope (int numSamples, bool enabled)
+        {
+            double value = 0.0;
+
+            egHasValue = enabled && egEngine.processBlock (numSamples, value);
+            eg01       = egHasValue ? juce::jlimit (0.0, 1.0, value) : 0.0;
+            return egHasValue;
+        }
+
+        template <typename Sink>
+        void render (const Block& b, Sink& sink)
+        {
+            jassert (b.map != nullptr);
+
+            block  = &b;
+            nowMs  = b.startMs;
+
+            const auto& m = *b.map;
+
+            if (b.lfoRunning)
+            {
+                auto params = b.lfo;
+
+                if (egHasValue)
+                    lfo::applyEgModulation (params, eg01, b.egToLfoRate, b.egToLfoDepth);
+
+                LfoOutput<Sink> output { *this, sink };
+                lfo::renderBlock (lfoRoutes, params, m, random, output);
+            }
+            else
+            {
+                // Stopped: routes end on their true last value (curve compression)
+                for (const int i : lfoRoutes)
+                    flushLfoRoute (sink, i, m[lfoRoutes.paramIndex[(size_t) i]]);
+            }
+
+            renderEgRoutes (sink);
+            renderDelay (sink);
+
+            block = nullptr;
+        }
+
+        // The plugin drives the engines directly (notes, parameters, restarts)
+        eg::Engine&                    getEnvelope() noexcept            { return egEngine; }
+        delay::Engine&                 getDelay() noexcept               { return delayEngine; }
+        lfo::RouteTable<maxLfoRoutes>& getLfoRoutes() noexcept           { return lfoRoutes; }
+        incoming::ControllerTracker&   getIncomingControllers() noexcept { return incomingControllers; }
+
+    private:
+        void handleInput (const juce::MidiMessage& msg, double blockStartMs)
+        {
+            const int ch = msg.getChannel();
+
+            if (msg.isNoteOn())
+            {
+                if (ch == settings.eg.sourceChannel)
+                    egEngine.noteOn (msg.getFloatVelocity());
+
+                if (ch == settings.delay.sourceChannel)
+                    delayEngine.noteOn (ch, msg.getNoteNumber(), msg.getFloatVelocity(), blockStartMs);
+
+                if (ch == settings.lfo.noteRestartChannel)
+                    restartLfo();
+            }
+            else if (msg.isNoteOff())
+            {
+                if (ch == settings.eg.sourceChannel)
+                    egEngine.noteOff();
+
+                if (ch == settings.delay.sourceChannel)
+                    delayEngine.noteOff (ch, msg.getNoteNumber(), blockStartMs);
+            }
+        }
+
+        // EG shaping destination from the map's volume / level role, -1 when
+        // off or missing from the map
+        int delayEgShapeIndex() const noexcept
+        {
+            if (settings.delay.egShape <= 0)
+                return -1;
+
+            return map->getRoleIndex (settings.delay.egShape == 1 ? instrument::Role::Volume
+                                                                  : instrument::Role::Level);
+        }
+
+        // As the plugin fills them: per-note EG runs the main EG's settings
+        delay::Params makeDelayParams() const
+        {
+            auto p = settings.delay.params;
+
+            p.panEnabled = p.panEnabled && map->getRoleIndex (instrument::Role::Pan) >= 0;
+            p.perNoteEg  = settings.delay.egPerNote && delayEgShapeIndex() >= 0;
+
+            if (p.perNoteEg)
+            {
+                p.noteEgParams         = settings.eg.params;
+                p.noteEgParams.enabled = true;
+            }
+
+            return p;
+        }
+
+        Block makeBlock (int numSamples) const
+        {
+            Block b;
+            b.map        = map.get();
+            b.startMs    = timeMs;
+            b.numSamples = numSamples;
+
+            b.lfoRunning   = settings.lfo.running;
+            b.lfo          = { settings.lfo.shape, settings.lfo.rateHz, settings.lfo.depth, sr, numSamples };
+            b.egToLfoRate  = settings.lfo.egToRate;
+            b.egToLfoDepth = settings.lfo.egToDepth;
+
+            for (int r = 0; r < maxEgRoutes; ++r)
+            {
+                auto route = settings.eg.routes[(size_t) r];
+
+                if (! map->isValidIndex (route.paramIndex))
+                    route.channel = 0;
+
+                b.egRoutes[(size_t) r] = route;
+            }
+
+            b.delayEnabled       = settings.delay.params.enabled;
+            b.delayEgParamIndex  = delayEgShapeIndex();
+            b.delayEgPerNote     = settings.delay.egPerNote && b.delayEgParamIndex >= 0;
+            b.delayPanParamIndex = map->getRoleIndex (instrument::Role::Pan);
+
+            b.changeThreshold = settings.changeThreshold;
+            b.rateLimitMs     = settings.rateLimitMs;
+            b.curveTolerance  = settings.curveTolerance;
+            b.knobFollow      = settings.knobFollow;
+            return b;
+        }
+
+        // process(): every port into the caller's buffer, MIDI 1.0 only
+        struct MidiSink
+        {
+            ports::PortBuffers out;
+
+            const ports::PortBuffers& buffers() const noexcept { return out; }
+            bool isUmp (int) const noexcept { return false; }
+            void addUmp (int, int, const juce::ump::PacketX2&) noexcept {}
+            void lfoSent (int, double, int) noexcept {}
+            void oneShotFinished (int) noexcept {}
+        };
+
+        // lfo::renderBlock() output: curve compression, then sendLfoValue()
+        template <typename Sink>
+        struct LfoOutput
+        {
+            Core& core;
+            Sink& sink;
+
+            int knob (int route, int paramIndex) const noexcept
+            {
+                return core.knobFor (core.lfoRoutes.channel[(size_t) route], paramIndex);
+            }
+
+            void send (int route, const SyntaktParameter& param, const lfo::RouteValue& v, int offset)
+            {
+                int    value   = v.midiValue;
+                double value01 = v.value01;
+
+                // Curve compression may hold this value back, or send an earlier one
+                if (core.passCurve (core.lfoRoutes.curve[(size_t) route], param, value, value01, offset))
+                    core.sendLfoValue (sink, route, param, value, value01, offset);
+            }
+
+            // One-shot over: its last value goes out now
+            void finished (int route, const SyntaktParameter& param)
+            {
+                sink.oneShotFinished (route);
+                core.flushLfoRoute (sink, route, param);
+            }
+        };
+
+        int knobFor (int channel, int paramIndex) const noexcept
+        {
+            return block->knobFollow ? incomingControllers.getValue (channel, paramIndex)
+                                     : incoming::ControllerTracker::unknown;
+        }
+
+        void restartLfo()
+        {
+            for (int r = 0; r < maxLfoRoutes; ++r)
+                restartLfoRoute (r);
+        }
+
+        void restartLfoRoute (int r)
+        {
+            lfoRoutes.restart (r, settings.lfo.shape);
+            lfoRoutes.resetThrottle (r);
+        }
+
+        // ── EG routes ─────────────────────────────────────────────────────────
+        template <typename Sink>
+        void renderEgRoutes (Sink& sink)
+        {
+            const auto& m = *block->map;
+
+            for (int r = 0; r < maxEgRoutes; ++r)
+            {
+                const auto& route = block->egRoutes[(size_t) r];
+                auto& slot = egSlots[(size_t) r];
+
+                // New destination: nothing was sent there yet
+                if (route != egRouteSent[(size_t) r])
+                {
+                    egRouteSent[(size_t) r] = route;
+                    slot = {};
+                }
+
+                if (route.channel <= 0 || ! m.isValidIndex (route.paramIndex))
+                    continue;
+
+                const auto& param = m[route.paramIndex];
+
+                int    value = 0, offset = 0;
+                double value01 = 0.0;
+
+                if (egHasValue)
+                {
+                    // knobFollow: the envelope starts from the live knob position
+                    const int knob = knobFor (route.channel, route.paramIndex);
+
+                    value   = mapEgToMidi (eg01, param, knob);
+                    value01 = mapEgTo01 (eg01, value, param, knob);
+
+                    if (! passCurve (slot.curve, param, value, value01, offset))
+                        continue;
+                }
+                else if (! flushCurve (slot.curve, value, value01, offset))
+                {
+                    continue;   // envelope idle, and nothing held back
+                }
+
+                sendValue (sink, slot, route.port, route.channel, param, value, value01, offset);
+            }
+        }
+
+        // ── Delay: EG shaping, echoes with their primers, per-note EG ─────────
+        template <typename Sink>
+        void renderDelay (Sink& sink)
+        {
+            const auto& m   = *block->map;
+            const auto& out = sink.buffers();
+
+            const int egParamIndex = m.isValidIndex (block->delayEgParamIndex) ? block->delayEgParamIndex : -1;
+            const auto* egParam    = egParamIndex >= 0 ? &m[egParamIndex] : nullptr;
+            const auto* panParam   = m.isValidIndex (block->delayPanParamIndex) ? &m[block->delayPanParamIndex] : nullptr;
+
+            // Another destination: the values sent so far were for the old one
+            if (egParamIndex != delayEgParamSent)
+            {
+                delayEgParamSent = egParamIndex;
+
+                for (auto& port : shapeSlots)   port.fill ({});
+                for (auto& port : perNoteSlots) port.fill ({});
+            }
+
+            // EG → echo shaping: the main EG level to every channel with echoes
+            // sounding, per port.  The note-off cap in DelayEngine limits echo
+            // duration to 70 % of the delay interval, so the EG attack + hold +
+            // early-decay stages are what naturally get applied.
+            if (egParam != nullptr && ! block->delayEgPerNote && egHasValue && block->delayEnabled)
+            {
+                const int value = mapEgToMidi (eg01, *egParam);
+
+                std::array<std::array<bool, 17>, ports::maxPorts> sounding {};
+                delayEngine.getActiveSoundingChannels (sounding);
+
+                for (int port = 0; port < ports::maxPorts; ++port)
+                    for (int ch = 1; ch <= 16; ++ch)
+                        if (sounding[(size_t) port][(size_t) ch])
+                            sendValue (sink, shapeSlots[(size_t) port][(size_t) ch], port, ch, *egParam, value, eg01, 0);
+            }
+
+            // Single pass: the engine calls back right before each echo note-on so
+            // the primer CCs land ahead of the note at the same sample offset.
+            //  - Auto-pan: the synth's pan register is set before the note event
+            //    arrives.  Pan is not throttled — it must fire every echo.
+            //  - Per-note EG: volume is primed to the EG start value (silence); the
+            //    throttle slot is updated so the next per-note EG value is not
+            //    swallowed as "unchanged".
+            delayEngine.processBlock (block->numSamples, block->startMs, out,
+                [&] (const delay::NoteOnPrimer& pr)
+                {
+                    auto& portOut = out[pr.port];
+
+                    // (NRPN pan path omitted — "Amp: Pan" is a CC in SyntaktParameterTable.h)
+                    if (pr.panCcValue >= 0 && panParam != nullptr && panParam->isCC)
+                        portOut.addEvent (juce::MidiMessage::controllerEvent (pr.channel, panParam->ccNumber, pr.panCcValue),
+                                          pr.sampleOffset);
+
+                    if (! pr.primeEg || egParam == nullptr)
+                        return;
+
+                    if (sink.isUmp (pr.port) && hasPerNoteIndex (*egParam))
+                    {
+                        // MIDI 2.0: prime this note only, other echoes keep their level.
+                        sink.addUmp (pr.port, pr.sampleOffset,
+                                     makeUmpPerNotePacket (pr.channel, pr.note, *egParam, toUmp32 (*egParam, pr.initialEg01)));
+                        return;
+                    }
+
+                    const int value = mapEgToMidi (static_cast<double> (pr.initialEg01), *egParam);
+                    auto& slot = perNoteSlots[(size_t) pr.port][(size_t) pr.channel];
+
+                    writeParamValueToBuffer (portOut, pr.channel, *egParam, value, pr.sampleOffset);
+                    slot.lastSent = value;
+                    slot.curve.reset();
+                });
+
+            // Per-note EG: each echo retriggers its own EG at its note-on
+            if (! block->delayEgPerNote || egParam == nullptr || ! block->delayEnabled)
+                return;
+
+            const auto& pnEgOut = delayEngine.getPerNoteEgOutput();
+
+            if (! pnEgOut.hasAnyValue)
+                return;
+
+            for (int port = 0; port < ports::maxPorts; ++port)
+            {
+                // MIDI 2.0 ports: one per-note controller per echo instead of
+                // the loudest echo per channel.  NRPN destinations have no
+                // per-note index: per channel below.
+                if (sink.isUmp (port) && hasPerNoteIndex (*egParam))
+                {
+                    for (int k = 0; k < pnEgOut.numNotes; ++k)
+                    {
+                        const auto& nv = pnEgOut.notes[(size_t) k];
+
+                        if (nv.port == port)
+                            sink.addUmp (port, 0, makeUmpPerNotePacket (nv.channel, nv.note, *egParam,
+                                                                        toUmp32 (*egParam, nv.eg01)));
+                    }
+                    continue;
+                }
+
+                for (int ch = 1; ch <= 16; ++ch)
+                {
+                    const float level = pnEgOut.maxEg01[port][ch];
+                    auto& slot = perNoteSlots[(size_t) port][(size_t) ch];
+
+                    int    value   = 0, offset = 0;
+                    double value01 = level;
+
+                    if (level <= 0.0f)
+                    {
+                        // Echoes on this channel done: end on the true last value
+                        if (! flushCurve (slot.curve, value, value01, offset))
+                            continue;
+                    }
+                    else
+                    {
+                        value = mapEgToMidi (static_cast<double> (level), *egParam);
+
+                        if (! passCurve (slot.curve, *egParam, value, value01, offset))
+                            continue;
+                    }
+
+                    sendMidi1 (out[port], slot, ch, *egParam, value, offset);
+                }
+            }
+        }
+
+        // ── Send path ─────────────────────────────────────────────────────────
+
+        // Throttle + curve state of one destination (LFO routes keep theirs in
+        // the route table)
+        struct SendSlot
+        {
+            int    lastSent   = lfo::RouteTable<maxLfoRoutes>::notSent;
+            double lastSendMs = 0.0;
+            curve::Simplifier curve;
+        };
+
+        // Curve compression (CurveSimplifier.h) in front of a send.  Returns false
+        // when the sample only extends the current segment; otherwise midiValue,
+        // value01 and sampleOffset hold the point to send now.  Off (tolerance 0):
+        // every sample passes unchanged.
+        bool passCurve (curve::Simplifier& curve, const SyntaktParameter& param,
+                        int& midiValue, double& value01, int& sampleOffset) noexcept
+        {
+            if (block->curveTolerance <= 0.0)
+            {
+                curve.reset();
+                return true;
+            }
+
+            curve::Point point { nowMs + sampleOffset * msPerSample, value01, midiValue };
+
+            if (! curve.push (point, curveToleranceFor (param, block->curveTolerance), point))
+                return false;
+
+            takeCurvePoint (point, midiValue, value01, sampleOffset);
+            return true;
+        }
+
+        // The stream stopped: the end of the pending segment, if any.
+        bool flushCurve (curve::Simplifier& curve, int& midiValue, double& value01, int& sampleOffset) noexcept
+        {
+            curve::Point point;
+
+            if (! curve.flush (point))
+                return false;
+
+            takeCurvePoint (point, midiValue, value01, sampleOffset);
+            return true;
+        }
+
+        // Points held over from an earlier block go out at the start of this one.
+        void takeCurvePoint (const curve::Point& point, int& midiValue, double& value01, int& sampleOffset) const noexcept
+        {
+            midiValue    = point.midiValue;
+            value01      = point.value01;
+            sampleOffset = juce::jlimit (0, juce::jmax (0, block->numSamples - 1),
+                                         (int) std::round ((point.timeMs - nowMs) / msPerSample));
+        }
+
+        template <typename Sink>
+        void flushLfoRoute (Sink& sink, int route, const SyntaktParameter& param)
+        {
+            int    value = 0, offset = 0;
+            double value01 = 0.0;
+
+            if (flushCurve (lfoRoutes.curve[(size_t) route], value, value01, offset))
+                sendLfoValue (sink, route, param, value, value01, offset);
+        }
+
+        // LFO routes: same rules as sendValue(), with the throttle state kept
+        // in the route table (no lookups in the per-step loop).
+        template <typename Sink>
+        void sendLfoValue (Sink& sink, int route, const SyntaktParameter& param,
+                           int midiValue, double value01, int offset)
+        {
+            const auto r       = (size_t) route;
+            const int  port    = lfoRoutes.port[r];
+            const int  channel = lfoRoutes.channel[r];
+            const bool ump     = sink.isUmp (port);
+            const auto data    = ump ? toUmp32 (param, value01) : 0u;
+
+            // MIDI 2.0: exact repeats only (one packet carries full resolution)
+            if (! passThrottle (lfoRoutes.lastSent[r], lfoRoutes.lastSendMs[r],
+                                ump ? (int) data : midiValue,
+                                ump ? 1 : changeThresholdFor (param, block->changeThreshold),
+                                nowMs, block->rateLimitMs))
+                return;
+
+            // What goes out on the wire, as a position in the parameter's range
+            sink.lfoSent (route,
+                          ump ? value01 : (midiValue - param.minValue) / (double) juce::jmax (1, param.maxValue - param.minValue),
+                          offset);
+
+            if (ump)
+                sink.addUmp (port, offset, makeUmpParamPacket (channel, param, data));
+            else
+                writeParamValueToBuffer (sink.buffers()[port], channel, param, midiValue, offset);
+        }
+
+        // Route a value to its output port: MIDI 2.0 ports get one 32-bit
+        // controller packet, MIDI 1.0 ports the throttled CC / CC pair / NRPN.
+        //    value01 : unquantised position in the parameter's [min, max] range.
+        template <typename Sink>
+        void sendValue (Sink& sink, SendSlot& slot, int port, int channel, const SyntaktParameter& param,
+                        int midiValue, double value01, int offset)
+        {
+            if (! sink.isUmp (port))
+            {
+                sendMidi1 (sink.buffers()[port], slot, channel, param, midiValue, offset);
+                return;
+            }
+
+            // MIDI 2.0: no change threshold (one packet carries full resolution);
+            // exact repeats are skipped and the rate limiter still applies.
+            const auto data = toUmp32 (param, value01);
+
+            if (passThrottle (slot.lastSent, slot.lastSendMs, (int) data, 1, nowMs, block->rateLimitMs))
+                sink.addUmp (port, offset, makeUmpParamPacket (channel, param, data));
+        }
+
+        // Data throttle, then rate limiter (MIDI 1.0 output)
+        void sendMidi1 (juce::MidiBuffer& out, SendSlot& slot, int channel, const SyntaktParameter& param,
+                        int midiValue, int offset)
+        {
+            if (passThrottle (slot.lastSent, slot.lastSendMs, midiValue,
+                              changeThresholdFor (param, block->changeThreshold), nowMs, block->rateLimitMs))
+                writeParamValueToBuffer (out, channel, param, midiValue, offset);
+        }
+
+        void resetSendState() noexcept
+        {
+            egSlots.fill ({});
+            egRouteSent.fill ({});
+
+            for (auto& port : shapeSlots)   port.fill ({});
+            for (auto& port : perNoteSlots) port.fill ({});
+
+            delayEgParamSent = -1;
+        }
+
+        std::unique_ptr<const instrument::InstrumentMap> map;
+
+        Settings settings;
+
+        double sr = 48000.0;
+        double msPerSample = 1000.0 / 48000.0;
+        double timeMs = 0.0;                       // process() only
+
+        // During render()
+        const Block* block = nullptr;
+        double nowMs = 0.0;                        // block start
+
+        eg::Engine    egEngine;
+        delay::Engine delayEngine;
+
+        lfo::RouteTable<maxLfoRoutes> lfoRoutes;   // settings (setSettings(), or the plugin's RouteSync) + runtime state
+        juce::Random random;
+
+        incoming::ControllerTracker incomingControllers;
+
+        double eg01       = 0.0;
+        bool   egHasValue = false;
+
+        std::array<SendSlot, maxEgRoutes> egSlots {};
+        std::array<EgRoute,  maxEgRoutes> egRouteSent {};
+
+        std::array<std::array<SendSlot, 17>, ports::maxPorts> shapeSlots {};     // [port][channel 1..16]
+        std::array<std::array<SendSlot, 17>, ports::maxPorts> perNoteSlots {};   // [port][channel 1..16]
+        int delayEgParamSent = -1;
+
+        JUCE_DECLARE_NON_COPYABLE (Core)
+    };
+} // namespace modztakt::engine
@@ -0,0 +1,8 @@
+// Engine library entry (Engine/ModzTakt_engine.jucer).
+//
+// The engines are header-only like the rest of the tree; this translation
+// unit compiles them against juce_core + juce_audio_basics alone, so a header
+// that starts needing a GUI / device / APVTS module breaks the library build
+// instead of silently growing its dependencies.  Consumers include
+// EngineCore.h and link the archive, which carries the JUCE module code.
+#include "EngineCore.h"
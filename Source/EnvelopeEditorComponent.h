@@ -2,9 +2,11 @@
 #include <JuceHeader.h>
 
 #include "Cosmetic.h"
-#include "SyntaktParameterTable.h"
+#include "InstrumentMapLibrary.h"
+#include "UiRefresh.h"
+#include "RouteOccupancy.h"
 
-class EnvelopeEditorComponent : public juce::Component, private juce::Timer
+class EnvelopeEditorComponent : public juce::Component
 {
 public:
     using APVTS = juce::AudioProcessorValueTreeState;
@@ -13,8 +15,10 @@ public:
     using ChoiceAttachment   = APVTS::ComboBoxAttachment;
 
 
-    EnvelopeEditorComponent (APVTS& apvtsRef)
-        : apvts(apvtsRef)
+    EnvelopeEditorComponent (APVTS& apvtsRef, const modztakt::instrument::MapLibrary& mapsRef,
+                             const modztakt::routing::Occupancy& occupancyRef,
+                             modztakt::ui::RefreshScheduler& uiRefresh)
+        : apvts(apvtsRef), instrumentMaps(mapsRef), routeOccupancy(occupancyRef)
     {
         setName("Envelope");
 
@@ -255,8 +259,9 @@ public:
         addAndMakeVisible(egToLfoRateLabel);
 
         // Keep LED states in sync with automation/preset changes
-        startTimerHz(20);
-        
+        namespace Changed = modztakt::ui::Changed;
+        uiRefresh.subscribe (Changed::egParams, [this] (uint32_t) { syncWithParameters(); });
+
         // Initialize release slider outline based on current releaseLong state
         updateReleaseSliderOutline();
 
@@ -266,7 +271,6 @@ public:
 
     ~EnvelopeEditorComponent() override
     {
-        stopTimer();
         attackAttach.reset(); holdAttach.reset(); decayAttach.reset(); sustainAttach.reset(); releaseAttach.reset(); velAttach.reset();
         egEnableAttach.reset(); noteSourceChannelAttach.reset();
         releaseLongAttach.reset();
@@ -529,8 +533,25 @@ public:
         }
     }
 
+    // Selected instrument map changed: rebuild the destination lists
+    // (selections are kept by index where the new map allows it).
+    void refreshInstrumentMap()
+    {
+        for (int r = 0; r < maxRoutes; ++r)
+            updateDestinationBoxForRoute (r);
+
+        refreshEgRouteAvailability();
+    }
+
+    // Route occupancy changed (called by MainComponent after a sync): filter the
+    // destination lists against LFO / Delay routes without a channel re-select.
+    void refreshRouteAvailability()
+    {
+        refreshEgRouteAvailability();
+    }
+
 private:
-    void timerCallback() override
+    void syncWithParameters()
     {
         updateEgUiEnabledState();
 
@@ -592,10 +613,6 @@ private:
 
         // Update release slider outline based on releaseLong parameter
         updateReleaseSliderOutline();
-
-        // Refresh dest box filtering every tick so changes made in LFO or Delay
-        // routes are reflected immediately without requiring a channel re-select.
-        refreshEgRouteAvailability();
     }
 
     void setChoiceParam(const char* paramID, int choiceIndex)
@@ -752,7 +769,7 @@ private:
 
         populateEgDestinationBox(destBox, channelType);
 
-        const int midiCount = ModzTaktAudioProcessor::egMidiDestCount();
+        const int midiCount = getEgMidiDestCount();
 
         int desiredMaster = 0;
 
@@ -788,9 +805,8 @@ private:
         if (channelType == ChannelType::MIDI)
         {
             // Regular EG MIDI destinations
-            for (int globalIdx = 0; globalIdx < juce::numElementsInArray(syntaktParameters); ++globalIdx)
-                if (syntaktParameters[globalIdx].egDestination)
-                    box.addItem(syntaktParameters[globalIdx].name, itemId++);
+            for (const auto& name : instrumentMap().getEgDestinationNames())
+                box.addItem(name, itemId++);
         }
         // Disabled: leave box empty
     }
@@ -830,75 +846,9 @@ private:
         if (globalParamIdx < 0)
             return false;
 
-        // conflict with LFO routes using same (ch,param)
-        if (lfoUsesChannelParam(ch, globalParamIdx))
-            return false;
-
-        // conflict with other EG MIDI routes on same channel
-        for (int other = 0; other < maxRoutes; ++other)
-        {
-            if (other == r) continue;
-            if (getChannelType(other) != ChannelType::MIDI) continue;
-
-            if (getEgRouteChannelNumber(other) != ch)
-                continue;
-
-            const int otherMaster = getSelectedEgDestMasterIndex(other);
-            const int otherParam  = mapEgChoiceToGlobalParamIndex(otherMaster);
-
-            if (otherParam == globalParamIdx)
-                return false;
-        }
-
-        // conflict with Delay EG shaping:
-        // when delayEgShape > 0 the delay engine owns (delayRouteCh, targetParam).
-        {
-            const int delayEgShape =
-                (int) apvts.getRawParameterValue ("delayEgShape")->load();
-
-            if (delayEgShape > 0)
-            {
-                const int delayTargetParam =
-                    (delayEgShape == 1)
-                        ? findGlobalParamByName ("Amp: Volume")
-                        : findGlobalParamByName ("Track Level");
-
-                if (globalParamIdx == delayTargetParam)
-                {
-                    for (int dr = 0; dr < maxRoutes; ++dr)
-                    {
-                        const int dCh = (int) apvts.getRawParameterValue (
-                            "delayRoute" + juce::String (dr) + "_channel")->load();
-                        if (dCh == ch)
-                            return false;
-                    }
-                }
-            }
-        }
-
-        // conflict with Delay auto-pan:
-        // when delayPanEnabled, the delay engine owns (delayRouteCh, "Amp: Pan").
-        {
-            const bool delayPanEnabled =
-                apvts.getRawParameterValue ("delayPanEnabled")->load() > 0.5f;
-
-            if (delayPanEnabled)
-            {
-                const int panParamIdx = findGlobalParamByName ("Amp: Pan");
-                if (globalParamIdx == panParamIdx)
-                {
-                    for (int dr = 0; dr < maxRoutes; ++dr)
-                    {
-                        const int dCh = (int) apvts.getRawParameterValue (
-                            "delayRoute" + juce::String (dr) + "_channel")->load();
-                        if (dCh == ch)
-                            return false;
-                    }
-                }
-            }
-        }
-
-        return true;
+        // conflict with LFO routes, other EG routes, Delay EG shaping and
+        // Delay auto-pan on the same (ch, param)
+        return !routeOccupancy.isClaimed (ch, globalParamIdx, ~modztakt::routing::Owner::eg (r));
     }
 
     int findFirstAllowedMaster (int r) const
@@ -916,22 +866,14 @@ private:
 
     // helpers used to prevent conflicts between LFO and EG dest. param
 
-    // Find global syntaktParameters[] index by exact name. Returns -1 if not found.
-    static int findGlobalParamByName (const char* name) noexcept
+    const modztakt::instrument::InstrumentMap& instrumentMap() const noexcept
     {
-        for (int i = 0; i < juce::numElementsInArray (syntaktParameters); ++i)
-            if (juce::String (syntaktParameters[i].name) == name)
-                return i;
-        return -1;
+        return instrumentMaps.getSelected();
     }
 
     int getEgMidiDestCount() const
     {
-        int count = 0;
-        for (int i = 0; i < juce::numElementsInArray(syntaktParameters); ++i)
-            if (syntaktParameters[i].egDestination)
-                ++count;
-        return count;
+        return instrumentMap().getNumEgDestinations();
     }
 
     int getEgRouteChannelNumber(int r) const
@@ -946,37 +888,11 @@ private:
         return destChoice - getEgMidiDestCount(); // 0..2
     }
 
-    bool lfoUsesChannelParam(int ch, int globalParamIdx) const
-    {
-        // LFO routes: route{r}_channel is Choice index 0=Disabled or 1..16
-        // route{r}_param is 0..N-1 (global param index)
-        for (int r = 0; r < maxRoutes; ++r)
-        {
-            const auto rs = juce::String(r);
-            const int lfoCh = (int) apvts.getRawParameterValue("route" + rs + "_channel")->load();
-            const int lfoP  = (int) apvts.getRawParameterValue("route" + rs + "_param")->load();
-            if (lfoCh == ch && lfoP == globalParamIdx)
-                return true;
-        }
-        return false;
-    }
-
-    // Map an EG destination choice index (0..egMidiDestCount-1) to global syntakt param index.
+    // Map an EG destination choice index (0..egMidiDestCount-1) to global map param index.
     // Returns -1 if out of range.
     int mapEgChoiceToGlobalParamIndex(int egChoiceIndex) const
     {
-        int k = 0;
-        for (int globalIdx = 0; globalIdx < juce::numElementsInArray(syntaktParameters); ++globalIdx)
-        {
-            if (!syntaktParameters[globalIdx].egDestination)
-                continue;
-
-            if (k == egChoiceIndex)
-                return globalIdx;
-
-            ++k;
-        }
-        return -1;
+        return instrumentMap().egChoiceToIndex (egChoiceIndex);
     }
 
     void refreshEgRouteAvailability()
@@ -1170,6 +1086,8 @@ private:
     }
 
     APVTS& apvts;
+    const modztakt::instrument::MapLibrary& instrumentMaps;
+    const modztakt::routing::Occupancy& routeOccupancy;   // synced by MainComponent
 
     // group
     juce::GroupComponent egGroup;
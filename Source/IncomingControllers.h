@@ -0,0 +1,157 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <cstdint>
+
+#include "InstrumentMap.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Incoming controller tracking ("modulate around the knob")
+//
+// Decodes the CC / NRPN stream coming back from the synth and keeps the last
+// received value of every (channel, map parameter), in the parameter's own
+// units (minValue..maxValue).  The LFO / EG routes can then modulate around
+// the live knob position instead of the fixed centre of the range.
+//
+// Per channel, a small state machine follows the NRPN protocol:
+//   CC 99 / 98   select parameter MSB / LSB  (CC 101 / 100 = RPN: deselect)
+//   CC 6         data MSB  → value stored right away (MSB << 7)
+//   CC 38        data LSB  → refines the value (MSB << 7 | LSB)
+// 14-bit CC pairs work the same way (CC n, then CC n + 32).
+//
+// The controller → parameter lookups are the instrument map's prebuilt
+// tables, and the values live in a fixed 16 × maxParams array: process()
+// is O(1) per message and never allocates.  Audio thread only.
+//
+// Note: a synth that echoes received CCs back (MIDI thru / "CC echo") would
+// report ModzTakt's own modulation as knob moves; keep echo off on that port.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::incoming
+{
+    class ControllerTracker
+    {
+    public:
+        static constexpr int unknown = -1;
+
+        ControllerTracker() { reset(); }
+
+        void reset() noexcept
+        {
+            for (auto& ch : values)
+                ch.fill (unknown);
+
+            for (auto& st : channels)
+                st = {};
+        }
+
+        // Decodes every controller message of the block against `map`.
+        // Values are cleared when the map changes (indices would not match).
+        void process (const juce::MidiBuffer& midi, const instrument::InstrumentMap& map) noexcept
+        {
+            if (&map != currentMap)
+            {
+                reset();
+                currentMap = &map;
+            }
+
+            for (const auto meta : midi)
+            {
+                const auto* data = meta.data;
+
+                if (meta.numBytes == 3 && (data[0] & 0xf0) == 0xb0)
+                    handleController (data[0] & 0x0f, data[1], data[2], map);
+            }
+        }
+
+        // Last received value of a parameter on a MIDI channel (1..16), or unknown.
+        int getValue (int channel, int paramIndex) const noexcept
+        {
+            if (channel < 1 || channel > 16 || paramIndex < 0 || paramIndex >= instrument::maxParams)
+                return unknown;
+
+            return values[(size_t) channel - 1][(size_t) paramIndex];
+        }
+
+    private:
+        struct ChannelState
+        {
+            int nrpnMsb = -1, nrpnLsb = -1;   // selected NRPN (-1 = none)
+            int dataMsb = -1;                 // CC 6 of the current NRPN value
+            std::array<int8_t, 32> cc14Msb {};  // CC n MSB of a 14-bit pair (-1 = none)
+
+            ChannelState() noexcept { cc14Msb.fill (-1); }
+        };
+
+        void handleController (int ch0, int cc, int value, const instrument::InstrumentMap& map) noexcept
+        {
+            auto& st = channels[(size_t) ch0];
+
+            switch (cc)
+            {
+                case 99:  st.nrpnMsb = value; st.dataMsb = -1; return;
+                case 98:  st.nrpnLsb = value; st.dataMsb = -1; return;
+                case 101:
+                case 100: st.nrpnMsb = st.nrpnLsb = -1; st.dataMsb = -1; return;
+
+                case 6:
+                    st.dataMsb = value;
+                    storeNrpn (ch0, st, value << 7, map);
+                    return;
+
+                case 38:
+                    if (st.dataMsb >= 0)
+                        storeNrpn (ch0, st, (st.dataMsb << 7) | value, map);
+                    return;
+
+                default:
+                    break;
+            }
+
+            const int idx = map.findByCc (cc);
+            if (idx < 0)
+                return;
+
+            const auto& param = map[idx];
+
+            if (getParamEncoding (param) != ParamEncoding::CC14)
+            {
+                store (ch0, idx, value, param);
+            }
+            else if (cc == param.ccNumber)
+            {
+                st.cc14Msb[(size_t) cc] = (int8_t) value;
+                store (ch0, idx, value << 7, param);
+            }
+            else if (st.cc14Msb[(size_t) param.ccNumber] >= 0) // LSB (cc == ccNumber + 32)
+            {
+                store (ch0, idx, (st.cc14Msb[(size_t) param.ccNumber] << 7) | value, param);
+            }
+        }
+
+        void storeNrpn (int ch0, const ChannelState& st, int value14, const instrument::InstrumentMap& map) noexcept
+        {
+            if (st.nrpnMsb < 0 || st.nrpnLsb < 0)
+                return;
+
+            const int idx = map.findByNrpn (st.nrpnMsb, st.nrpnLsb);
+            if (idx < 0)
+                return;
+
+            const auto& param = map[idx];
+
+            // A 7-bit parameter reached through its NRPN: keep the MSB.
+            store (ch0, idx, getParamEncoding (param) == ParamEncoding::CC7 ? (value14 >> 7) : value14, param);
+        }
+
+        void store (int ch0, int idx, int value, const SyntaktParameter& param) noexcept
+        {
+            values[(size_t) ch0][(size_t) idx] = (int16_t) juce::jlimit (param.minValue, param.maxValue, value);
+        }
+
+        std::array<ChannelState, 16> channels {};
+        std::array<std::array<int16_t, instrument::maxParams>, 16> values {};
+
+        const instrument::InstrumentMap* currentMap = nullptr;
+    };
+} // namespace modztakt::incoming
@@ -0,0 +1,388 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SyntaktParameterTable.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Instrument maps
+//
+// An InstrumentMap is the parameter table of one synth model: the same
+// SyntaktParameter entries as SyntaktParameterTable.h, plus lookups that are
+// built once when the map is created and never change afterwards:
+//   - name          → index   (hash map)
+//   - CC number     → index   (128 entries, CC14 LSBs included)
+//   - NRPN MSB/LSB  → index   (16384 entries)
+//   - EG destination choice ↔ global index
+//   - role indices (volume / level / pan) used by the delay features
+//
+// The built-in Syntakt table is always available.  Further maps are read at
+// startup from JSON or XML files in the user maps folder (see
+// MapLibrary::getUserMapsFolder() in InstrumentMapLibrary.h):
+//
+//   { "name": "Digitone",
+//     "roles": { "volume": "Amp: Volume", "level": "Track Level", "pan": "Amp: Pan" },
+//     "parameters": [
+//       { "name": "Track Level", "cc": 95, "min": 0, "max": 127, "eg": true },
+//       { "name": "Filter: Frequency", "nrpn": [1, 20], "min": 0, "max": 16383,
+//         "eg": true },
+//       { "name": "Amp: Pan", "cc": 10, "min": 0, "max": 127, "bipolar": true } ] }
+//
+//   <InstrumentMap name="Digitone">
+//     <Roles volume="Amp: Volume" level="Track Level" pan="Amp: Pan"/>
+//     <Parameter name="Track Level" cc="95" min="0" max="127" eg="1"/>
+//     <Parameter name="Filter: Frequency" nrpnMsb="1" nrpnLsb="20" max="16383" eg="1"/>
+//   </InstrumentMap>
+//
+// An entry with "cc" is sent as CC ("cc14": true for a 14-bit pair), without
+// it as NRPN.  Maps are immutable: the library publishes the selected map
+// through an atomic pointer, and the processor picks it up once at the start
+// of each block, so a switch always lands on a block boundary.  Loaded maps
+// stay alive until the library is destroyed.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::instrument
+{
+    // Size of the route parameter / EG destination choice parameters.
+    // Choices past the end of the selected map are treated as "no parameter".
+    static constexpr int maxParams = 128;
+
+    enum class Role { Volume, Level, Pan };
+
+    class InstrumentMap
+    {
+    public:
+        struct Entry
+        {
+            juce::String name;
+            SyntaktParameter param {};   // .name is filled in by the map
+            bool hasNrpn = true;         // false: CC-only entry, not in the NRPN lookup
+        };
+
+        struct Roles
+        {
+            juce::String volume, level, pan;
+        };
+
+        // ── Construction (message thread) ─────────────────────────────────────
+        static std::unique_ptr<const InstrumentMap> createBuiltIn()
+        {
+            std::vector<Entry> entries;
+            for (const auto& p : syntaktParameters)
+                entries.push_back ({ p.name, p });
+
+            std::unique_ptr<const InstrumentMap> map;
+            create ("Syntakt", std::move (entries), { "Amp: Volume", "Track Level", "Amp: Pan" }, map);
+            jassert (map != nullptr);
+            return map;
+        }
+
+        static juce::Result create (const juce::String& mapName,
+                                    std::vector<Entry> entries,
+                                    const Roles& roles,
+                                    std::unique_ptr<const InstrumentMap>& result)
+        {
+            if (mapName.isEmpty())
+                return juce::Result::fail ("missing map name");
+
+            if (entries.empty() || (int) entries.size() > maxParams)
+                return juce::Result::fail ("a map needs 1 to " + juce::String (maxParams) + " parameters");
+
+            std::unique_ptr<InstrumentMap> map (new InstrumentMap());
+            map->name = mapName;
+
+            for (int i = 0; i < (int) entries.size(); ++i)
+            {
+                const auto& e = entries[(size_t) i];
+                if (auto r = validate (e); r.failed())
+                    return juce::Result::fail (e.name.quoted() + ": " + r.getErrorMessage());
+
+                if (! map->nameToIndex.emplace (e.name, i).second)
+                    return juce::Result::fail (e.name.quoted() + ": duplicate name");
+            }
+
+            // Names are owned here; params[].name points into this vector,
+            // which is never resized after this point.
+            map->nameStorage.reserve (entries.size());
+            map->params.reserve (entries.size());
+
+            for (auto& e : entries)
+            {
+                map->nameStorage.push_back (e.name.toStdString());
+                map->params.push_back (e.param);
+            }
+
+            map->ccToIndex.fill (-1);
+            map->nrpnToIndex.assign (16384, -1);
+
+            for (int i = 0; i < map->size(); ++i)
+            {
+                auto& p = map->params[(size_t) i];
+                p.name = map->nameStorage[(size_t) i].c_str();
+
+                map->parameterNames.add (p.name);
+
+                // First entry wins when two entries share a controller.
+                if (p.isCC)
+                {
+                    if (map->ccToIndex[(size_t) p.ccNumber] < 0)
+                        map->ccToIndex[(size_t) p.ccNumber] = (int16_t) i;
+
+                    if (getParamEncoding (p) == ParamEncoding::CC14 && map->ccToIndex[(size_t) p.ccNumber + 32] < 0)
+                        map->ccToIndex[(size_t) p.ccNumber + 32] = (int16_t) i;
+                }
+
+                const int nrpn = (p.nrpnMsb << 7) | p.nrpnLsb;
+                if (entries[(size_t) i].hasNrpn && map->nrpnToIndex[(size_t) nrpn] < 0)
+                    map->nrpnToIndex[(size_t) nrpn] = (int16_t) i;
+
+                map->globalToEg.push_back (p.egDestination ? (int) map->egToGlobal.size() : -1);
+
+                if (p.egDestination)
+                {
+                    map->egToGlobal.push_back (i);
+                    map->egDestinationNames.add (p.name);
+                }
+            }
+
+            map->roleIndex[(size_t) Role::Volume] = map->findByName (roles.volume);
+            map->roleIndex[(size_t) Role::Level]  = map->findByName (roles.level);
+            map->roleIndex[(size_t) Role::Pan]    = map->findByName (roles.pan);
+
+            result = std::move (map);
+            return juce::Result::ok();
+        }
+
+        // ── Lookups (any thread, the map never changes) ───────────────────────
+        const juce::String& getName() const noexcept { return name; }
+        int size() const noexcept                    { return (int) params.size(); }
+
+        bool isValidIndex (int index) const noexcept { return index >= 0 && index < size(); }
+
+        const SyntaktParameter& operator[] (int index) const noexcept
+        {
+            jassert (isValidIndex (index));
+            return params[(size_t) index];
+        }
+
+        // -1 when not found.
+        int findByName (const juce::String& paramName) const
+        {
+            const auto it = nameToIndex.find (paramName);
+            return it != nameToIndex.end() ? it->second : -1;
+        }
+
+        int findByCc (int cc) const noexcept
+        {
+            return (cc >= 0 && cc < 128) ? ccToIndex[(size_t) cc] : -1;
+        }
+
+        int findByNrpn (int msb, int lsb) const noexcept
+        {
+            return (msb >= 0 && msb < 128 && lsb >= 0 && lsb < 128) ? nrpnToIndex[(size_t) ((msb << 7) | lsb)] : -1;
+        }
+
+        // EG destination choices are the egDestination entries, in table order.
+        int getNumEgDestinations() const noexcept { return (int) egToGlobal.size(); }
+
+        int egChoiceToIndex (int egChoice) const noexcept
+        {
+            return (egChoice >= 0 && egChoice < getNumEgDestinations()) ? egToGlobal[(size_t) egChoice] : -1;
+        }
+
+        int indexToEgChoice (int index) const noexcept
+        {
+            return isValidIndex (index) ? globalToEg[(size_t) index] : -1;
+        }
+
+        // Index of the parameter playing a role, -1 when this synth has none.
+        int getRoleIndex (Role role) const noexcept { return roleIndex[(size_t) role]; }
+
+        const juce::StringArray& getParameterNames() const noexcept      { return parameterNames; }
+        const juce::StringArray& getEgDestinationNames() const noexcept  { return egDestinationNames; }
+
+    private:
+        InstrumentMap() = default;
+
+        static juce::Result validate (const Entry& e)
+        {
+            const auto& p = e.param;
+
+            if (e.name.isEmpty())
+                return juce::Result::fail ("missing name");
+
+            if (p.isCC && (p.ccNumber < 0 || p.ccNumber > 127))
+                return juce::Result::fail ("CC number out of range");
+
+            if (p.nrpnMsb < 0 || p.nrpnMsb > 127 || p.nrpnLsb < 0 || p.nrpnLsb > 127)
+                return juce::Result::fail ("NRPN number out of range");
+
+            const int fullScale = (getParamEncoding (p) == ParamEncoding::CC7) ? 127 : 16383;
+
+            if (p.minValue < 0 || p.maxValue > fullScale || p.minValue >= p.maxValue)
+                return juce::Result::fail ("min/max out of range (0.." + juce::String (fullScale) + ")");
+
+            return juce::Result::ok();
+        }
+
+        juce::String name;
+
+        std::vector<std::string>      nameStorage;
+        std::vector<SyntaktParameter> params;
+
+        std::unordered_map<juce::String, int> nameToIndex;
+        std::array<int16_t, 128>              ccToIndex {};
+        std::vector<int16_t>                  nrpnToIndex;
+
+        std::vector<int> egToGlobal;
+        std::vector<int> globalToEg;
+        std::array<int, 3> roleIndex { -1, -1, -1 };
+
+        juce::StringArray parameterNames, egDestinationNames;
+
+        JUCE_DECLARE_NON_COPYABLE (InstrumentMap)
+    };
+
+    // ─────────────────────────────────────────────────────────────────────────
+    // File parsing
+    // ─────────────────────────────────────────────────────────────────────────
+    namespace detail
+    {
+        // Fields shared by the JSON and XML readers (XML attribute strings
+        // convert through juce::var as well).
+        template <typename GetFn, typename HasFn>
+        inline InstrumentMap::Entry readEntry (GetFn get, HasFn has)
+        {
+            InstrumentMap::Entry e;
+            e.name = get ("name").toString();
+
+            auto& p = e.param;
+            p.isCC          = has ("cc");
+            p.ccNumber      = has ("cc") ? (int) get ("cc") : 0;
+            p.minValue      = has ("min") ? (int) get ("min") : 0;
+            p.maxValue      = has ("max") ? (int) get ("max") : 127;
+            p.isBipolar     = has ("bipolar") && (bool) get ("bipolar");
+            p.egDestination = has ("eg") && (bool) get ("eg");
+            p.isCC14        = has ("cc14") && (bool) get ("cc14");
+            return e;
+        }
+
+        inline juce::Result readJson (const juce::var& json,
+                                      juce::String& name,
+                                      std::vector<InstrumentMap::Entry>& entries,
+                                      InstrumentMap::Roles& roles)
+        {
+            if (! json.isObject())
+                return juce::Result::fail ("not a JSON object");
+
+            name = json["name"].toString();
+
+            const auto& r = json["roles"];
+            roles = { r["volume"].toString(), r["level"].toString(), r["pan"].toString() };
+
+            const auto* list = json["parameters"].getArray();
+            if (list == nullptr)
+                return juce::Result::fail ("missing \"parameters\" array");
+
+            for (const auto& item : *list)
+            {
+                auto e = readEntry ([&] (const char* k) { return item[k]; },
+                                    [&] (const char* k) { return item.hasProperty (k); });
+
+                // "nrpn": [msb, lsb]
+                if (const auto* nrpn = item["nrpn"].getArray(); nrpn != nullptr && nrpn->size() == 2)
+                {
+                    e.param.nrpnMsb = (int) (*nrpn)[0];
+                    e.param.nrpnLsb = (int) (*nrpn)[1];
+                }
+                else if (e.param.isCC)
+                {
+                    e.hasNrpn = false;
+                }
+                else
+                {
+                    return juce::Result::fail (e.name.quoted() + ": needs \"cc\" or \"nrpn\": [msb, lsb]");
+                }
+
+                entries.push_back (std::move (e));
+            }
+
+            return juce::Result::ok();
+        }
+
+        inline juce::Result readXml (const juce::XmlElement& xml,
+                                     juce::String& name,
+                                     std::vector<InstrumentMap::Entry>& entries,
+                                     InstrumentMap::Roles& roles)
+        {
+            if (! xml.hasTagName ("InstrumentMap"))
+                return juce::Result::fail ("root element must be <InstrumentMap>");
+
+            name = xml.getStringAttribute ("name");
+
+            if (const auto* r = xml.getChildByName ("Roles"))
+                roles = { r->getStringAttribute ("volume"), r->getStringAttribute ("level"), r->getStringAttribute ("pan") };
+
+            for (const auto* item : xml.getChildWithTagNameIterator ("Parameter"))
+            {
+                auto e = readEntry ([&] (const char* k) { return juce::var (item->getStringAttribute (k)); },
+                                    [&] (const char* k) { return item->hasAttribute (k); });
+
+                if (item->hasAttribute ("nrpnMsb") && item->hasAttribute ("nrpnLsb"))
+                {
+                    e.param.nrpnMsb = item->getIntAttribute ("nrpnMsb");
+                    e.param.nrpnLsb = item->getIntAttribute ("nrpnLsb");
+                }
+                else if (e.param.isCC)
+                {
+                    e.hasNrpn = false;
+                }
+                else
+                {
+                    return juce::Result::fail (e.name.quoted() + ": needs cc or nrpnMsb/nrpnLsb");
+                }
+
+                entries.push_back (std::move (e));
+            }
+
+            return juce::Result::ok();
+        }
+    } // namespace detail
+
+    // Reads a .json or .xml map file.
+    inline juce::Result loadMapFile (const juce::File& file, std::unique_ptr<const InstrumentMap>& result)
+    {
+        juce::String name;
+        std::vector<InstrumentMap::Entry> entries;
+        InstrumentMap::Roles roles;
+
+        auto r = juce::Result::ok();
+
+        if (file.hasFileExtension ("json"))
+        {
+            juce::var json;
+            r = juce::JSON::parse (file.loadFileAsString(), json);
+
+            if (r.wasOk())
+                r = detail::readJson (json, name, entries, roles);
+        }
+        else if (auto xml = juce::XmlDocument::parse (file))
+        {
+            r = detail::readXml (*xml, name, entries, roles);
+        }
+        else
+        {
+            r = juce::Result::fail ("not a valid XML file");
+        }
+
+        if (r.wasOk())
+            r = InstrumentMap::create (name.isNotEmpty() ? name : file.getFileNameWithoutExtension(),
+                                       std::move (entries), roles, result);
+
+        return r.wasOk() ? r : juce::Result::fail (file.getFileName() + ": " + r.getErrorMessage());
+    }
+} // namespace modztakt::instrument
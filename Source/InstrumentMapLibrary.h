@@ -0,0 +1,141 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "InstrumentMap.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Instrument map library (plugin side)
+//
+// The maps folder, the selection the editors and the processor share, and its
+// place in the plugin state.  Kept out of InstrumentMap.h so the maps
+// themselves need no ValueTree / GUI module and the engine library can use
+// them (see EngineCore.h).
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::instrument
+{
+    // ─────────────────────────────────────────────────────────────────────────
+    // MapLibrary
+    //
+    // Owns every map loaded during the session.  The message thread scans the
+    // maps folder and selects a map; the audio thread only reads the selected
+    // pointer at the start of each block (getForBlock()).
+    // ─────────────────────────────────────────────────────────────────────────
+    class MapLibrary
+    {
+    public:
+        static constexpr const char* stateId = "InstrumentMap";
+
+        MapLibrary()
+        {
+            owned.push_back (InstrumentMap::createBuiltIn());
+            available.push_back (owned.back().get());
+            selected.store (available.front(), std::memory_order_release);
+        }
+
+        static juce::File getUserMapsFolder()
+        {
+            return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+                       .getChildFile ("ModzTakt")
+                       .getChildFile ("Instruments");
+        }
+
+        // ── Message thread ────────────────────────────────────────────────────
+
+        // (Re)reads every *.json / *.xml file of the maps folder.  A map that
+        // keeps its name replaces the previous version; the selection follows
+        // by name.  Returns one message per file that failed to load.
+        juce::StringArray rescan()
+        {
+            juce::StringArray errors;
+            const auto selectedName = getSelected().getName();
+
+            available.resize (1); // keep the built-in map
+
+            for (const auto& file : getUserMapsFolder().findChildFiles (juce::File::findFiles, false, "*.json;*.xml"))
+            {
+                std::unique_ptr<const InstrumentMap> map;
+
+                if (auto r = loadMapFile (file, map); r.failed())
+                {
+                    errors.add (r.getErrorMessage());
+                    continue;
+                }
+
+                if (findMap (map->getName()) >= 0)
+                {
+                    errors.add (file.getFileName() + ": map name " + map->getName().quoted() + " already used");
+                    continue;
+                }
+
+                owned.push_back (std::move (map));
+                available.push_back (owned.back().get());
+            }
+
+            if (! select (selectedName))
+                select (0);
+
+            return errors;
+        }
+
+        int getNumMaps() const noexcept                     { return (int) available.size(); }
+        const InstrumentMap& getMap (int index) const       { return *available[(size_t) index]; }
+
+        int findMap (const juce::String& mapName) const
+        {
+            for (int i = 0; i < getNumMaps(); ++i)
+                if (available[(size_t) i]->getName() == mapName)
+                    return i;
+            return -1;
+        }
+
+        bool select (int index)
+        {
+            if (index < 0 || index >= getNumMaps())
+                return false;
+
+            if (selected.exchange (available[(size_t) index], std::memory_order_acq_rel) != available[(size_t) index])
+                serial.fetch_add (1, std::memory_order_relaxed);
+
+            return true;
+        }
+
+        bool select (const juce::String& mapName) { return select (findMap (mapName)); }
+
+        // Selected map (message thread, or any thread for display text).
+        const InstrumentMap& getSelected() const noexcept { return *selected.load (std::memory_order_acquire); }
+
+        // Bumped on every selection change: UI menus rebuild when it moves.
+        int getSerial() const noexcept { return serial.load (std::memory_order_relaxed); }
+
+        void saveToState (juce::ValueTree& state) const
+        {
+            state.getOrCreateChildWithName (stateId, nullptr)
+                 .setProperty ("name", getSelected().getName(), nullptr);
+        }
+
+        // A saved map that is missing on this machine falls back to the built-in one.
+        void loadFromState (const juce::ValueTree& state)
+        {
+            const auto node = state.getChildWithName (stateId);
+
+            if (! (node.isValid() && select (node.getProperty ("name").toString())))
+                select (0);
+        }
+
+        // ── Audio thread ──────────────────────────────────────────────────────
+        const InstrumentMap& getForBlock() const noexcept { return *selected.load (std::memory_order_acquire); }
+
+    private:
+        std::vector<std::unique_ptr<const InstrumentMap>> owned;      // never shrinks
+        std::vector<const InstrumentMap*>                 available;  // [0] = built-in
+
+        std::atomic<const InstrumentMap*> selected { nullptr };
+        std::atomic<int>                  serial { 0 };
+
+        JUCE_DECLARE_NON_COPYABLE (MapLibrary)
+    };
+} // namespace modztakt::instrument
@@ -0,0 +1,521 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "PluginProcessor.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// End-to-end MIDI latency / jitter probe (Linux standalone, Settings menu)
+//
+// Opens two ALSA virtual ports and plugs them into the standalone wrapper's
+// own device selection, so the measured path is the real one:
+//   "ModzTakt Probe Out"  → enabled as a MIDI input of the app
+//   "ModzTakt Probe In"   ← made the app's default MIDI output
+//
+// The app is switched to a fixed patch (EG route 0 → CC on channel 2, delay
+// route 0 → one echo on channel 3 after echoDelayMs) and fed a note on
+// channel 1 every 2 × stepMs, each with a marker CC (thruController, value =
+// note number), plus MIDI clock at ≈ 119 BPM.  For every note the probe
+// timestamps, on arrival:
+//   thru   the pass-through copy of the marker CC (channel 1; processBlock
+//          passes everything through except notes)
+//   cc     the first EG controller message (channel 2)
+//   echo   the delay echo (channel 3), minus echoDelayMs
+// once per configuration: each audio buffer size the device offers in
+// bufferSizes × the MIDI rate limiter settings in limiterIndices (or the tick
+// alone while the MIDI-only timing engine drives the processor).  The report
+// gives min / median / p95 / max and the standard deviation (jitter) in ms.
+//
+// Everything the probe changes (parameters, audio setup, MIDI devices) is put
+// back when it finishes or is cancelled.  Times are taken with
+// Time::getMillisecondCounterHiRes() on send and on receipt, so they include
+// the ALSA sequencer hop in both directions.
+//
+// probeOut is written from the message thread (notes, markers) and the
+// HighResolutionTimer thread (clock); MidiOutput isn't thread-safe, so every
+// send goes through send(), serialised by sendLock.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::standalone
+{
+    class LatencyProbe : private juce::Timer,
+                         private juce::HighResolutionTimer,
+                         private juce::MidiInputCallback
+    {
+    public:
+        using Finished = std::function<void (const juce::String& report)>;
+
+        static constexpr int   notesPerConfig  = 30;
+        static constexpr int   stepMs          = 70;    // note-on, note-off one step later
+        static constexpr int   settleSteps     = 6;     // after a configuration change
+        static constexpr int   graceSteps      = 4;     // for the last echo to come back
+        static constexpr int   connectSteps    = 15;    // for the virtual ports to show up
+        static constexpr int   clockIntervalMs = 21;
+        static constexpr float echoDelayMs     = 100.0f;
+
+        static constexpr int probeChannel = 1, ccChannel = 2, echoChannel = 3;
+        static constexpr int thruController = 3;   // undefined CC: marks each probe note on the thru path
+
+        static constexpr int bufferSizes[]    = { 64, 128, 256, 512 };
+        static constexpr int limiterIndices[] = { 0, 2, 6 };   // Off, 1.0 ms, 5.0 ms
+
+        static constexpr const char* probeOutName = "ModzTakt Probe Out";
+        static constexpr const char* probeInName  = "ModzTakt Probe In";
+
+        explicit LatencyProbe (ModzTaktAudioProcessor& p) : processor (p), apvts (p.getAPVTS()) {}
+
+        ~LatencyProbe() override { cancel(); }
+
+        // ALSA virtual ports exist on Linux only.
+        static bool isAvailable() noexcept
+        {
+           #if JUCE_LINUX && JucePlugin_Build_Standalone
+            return MidiTimingEngine::isAvailable();
+           #else
+            return false;
+           #endif
+        }
+
+        bool isRunning() const noexcept { return phase != Phase::idle; }
+
+        // ── Message thread only ───────────────────────────────────────────────
+        juce::Result start (Finished whenFinished)
+        {
+           #if JUCE_LINUX && JucePlugin_Build_Standalone
+            auto* holder = juce::StandalonePluginHolder::getInstance();
+
+            if (isRunning())
+                return juce::Result::fail ("A measurement is already running.");
+
+            if (holder == nullptr || ! isAvailable())
+                return juce::Result::fail ("Only available in the standalone app.");
+
+            probeOut = juce::MidiOutput::createNewDevice (probeOutName);
+            probeIn  = juce::MidiInput::createNewDevice (probeInName, this);
+
+            if (probeOut == nullptr || probeIn == nullptr)
+            {
+                probeOut.reset();
+                probeIn.reset();
+                return juce::Result::fail ("Could not create the ALSA virtual MIDI ports.");
+            }
+
+            probeIn->start();
+
+            onFinished = std::move (whenFinished);
+            report     = {};
+
+            buildConfigs (*holder);
+            processor.getStateInformation (savedState);
+            savedAudioSetup = holder->deviceManager.getAudioDeviceSetup();
+
+            phase = Phase::connecting;
+            steps = 0;
+            juce::Timer::startTimer (stepMs);
+            return juce::Result::ok();
+           #else
+            juce::ignoreUnused (whenFinished);
+            return juce::Result::fail ("Only available in the Linux standalone app.");
+           #endif
+        }
+
+        // Stops without a report and restores the app.
+        void cancel()
+        {
+            if (! isRunning())
+                return;
+
+            onFinished = nullptr;
+            finish();
+        }
+
+    private:
+        enum class Phase { idle, connecting, settling, measuring, grace };
+
+        struct Config
+        {
+            int bufferSize   = 0;   // 0 = leave the audio device alone
+            int limiterIndex = 0;
+        };
+
+        struct SentNote
+        {
+            double sentMs   = 0.0;
+            bool   thruSeen = false;
+            bool   echoSeen = false;
+        };
+
+        // ── Setup ─────────────────────────────────────────────────────────────
+       #if JUCE_LINUX && JucePlugin_Build_Standalone
+        void buildConfigs (juce::StandalonePluginHolder& holder)
+        {
+            configs.clear();
+
+            juce::Array<int> sizes;
+
+            if (! processor.getMidiTimingEngine().isRunning())
+                if (auto* device = holder.deviceManager.getCurrentAudioDevice())
+                    for (const int size : bufferSizes)
+                        if (device->getAvailableBufferSizes().contains (size))
+                            sizes.add (size);
+
+            if (sizes.isEmpty())
+                sizes.add (0);
+
+            for (const int size : sizes)
+                for (const int limiter : limiterIndices)
+                    configs.push_back ({ size, limiter });
+
+            configIndex = 0;
+        }
+
+        bool connect (juce::StandalonePluginHolder& holder)
+        {
+            const auto appInput  = findDevice (juce::MidiInput::getAvailableDevices(),  probeOutName);
+            const auto appOutput = findDevice (juce::MidiOutput::getAvailableDevices(), probeInName);
+
+            if (appInput.isEmpty() || appOutput.isEmpty())
+                return false;
+
+            auto& dm = holder.deviceManager;
+
+            probeInputId         = appInput;
+            probeInputWasEnabled = dm.isMidiInputDeviceEnabled (appInput);
+            savedDefaultOutput   = dm.getDefaultMidiOutputIdentifier();
+
+            dm.setMidiInputDeviceEnabled (appInput, true);
+            setAppMidiOutput (holder, appOutput);
+            return true;
+        }
+
+        // Both the audio player and the timing engine pick the default output up on (re)start.
+        void setAppMidiOutput (juce::StandalonePluginHolder& holder, const juce::String& identifier)
+        {
+            holder.deviceManager.setDefaultMidiOutputDevice (identifier);
+
+            auto& timing = processor.getMidiTimingEngine();
+
+            if (timing.isRunning())
+                timing.start (timing.getTickMs());
+            else
+                holder.player.setMidiOutput (holder.deviceManager.getDefaultMidiOutput());
+        }
+       #endif
+
+        static juce::String findDevice (const juce::Array<juce::MidiDeviceInfo>& devices, const juce::String& name)
+        {
+            for (const auto& d : devices)
+                if (d.name == name)
+                    return d.identifier;
+
+            return {};
+        }
+
+        // Known patch: everything at its default, then one EG route and one delay route.
+        void applyPatch()
+        {
+            for (auto* p : processor.getParameters())
+                if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (p))
+                    ranged->setValueNotifyingHost (ranged->getDefaultValue());
+
+            setParam ("egEnabled",          1.0f);
+            setParam ("egAttack",           0.0005f);
+            setParam ("egDecay",            0.001f);
+            setParam ("egSustain",          1.0f);
+            setParam ("egRelease",          0.005f);
+            setParam ("egRoute0_channel",   (float) ccChannel);    // choice index = channel
+            setParam ("egRoute0_dest",      0.0f);
+
+            setParam ("delayEnabled",       1.0f);
+            setParam ("delayRate",          echoDelayMs);
+            setParam ("feedback",           0.05f);                // velocity 127 → exactly one echo
+            setParam ("delayRoute0_channel", (float) echoChannel);
+        }
+
+        void setParam (const juce::String& id, float value)
+        {
+            if (auto* p = apvts.getParameter (id))
+                p->setValueNotifyingHost (p->convertTo0to1 (value));
+        }
+
+        void applyConfig (const Config& c)
+        {
+           #if JUCE_LINUX && JucePlugin_Build_Standalone
+            if (c.bufferSize > 0)
+                if (auto* holder = juce::StandalonePluginHolder::getInstance())
+                {
+                    auto setup = holder->deviceManager.getAudioDeviceSetup();
+                    setup.bufferSize = c.bufferSize;
+                    holder->deviceManager.setAudioDeviceSetup (setup, true);
+                }
+           #endif
+
+            setParam ("midiRateLimiter", (float) c.limiterIndex);
+
+            const juce::ScopedLock sl (lock);
+            thru.clear();
+            cc.clear();
+            echo.clear();
+            sent = {};
+            ccPendingSinceMs = 0.0;
+        }
+
+        // ── Sequencing (message thread) ───────────────────────────────────────
+        void timerCallback() override
+        {
+            ++steps;
+
+            switch (phase)
+            {
+                case Phase::connecting:
+                {
+                   #if JUCE_LINUX && JucePlugin_Build_Standalone
+                    auto* holder = juce::StandalonePluginHolder::getInstance();
+
+                    if (holder != nullptr && connect (*holder))
+                    {
+                        applyPatch();
+                        applyConfig (configs[configIndex]);
+                        HighResolutionTimer::startTimer (clockIntervalMs);
+                        enter (Phase::settling);
+                    }
+                    else if (steps >= connectSteps)
+                    {
+                        report << "The virtual ports did not show up in the device list.\n"
+                                  "Connect \"" << probeOutName << "\" to the app's MIDI input and its MIDI output to \""
+                               << probeInName << "\" (e.g. with aconnect), then try again.";
+                        finish();
+                    }
+                   #endif
+                    break;
+                }
+
+                case Phase::settling:
+                    if (steps >= settleSteps)
+                        enter (Phase::measuring);
+                    break;
+
+                case Phase::measuring:
+                    // Odd steps send a note, even steps release it.
+                    if ((steps & 1) == 0)
+                    {
+                        send (juce::MidiMessage::noteOff (probeChannel, noteFor (notesSent - 1)));
+
+                        if (notesSent >= notesPerConfig)
+                            enter (Phase::grace);
+                    }
+                    else
+                    {
+                        sendProbeNote();
+                    }
+                    break;
+
+                case Phase::grace:
+                    if (steps >= graceSteps)
+                    {
+                        appendConfigReport (configs[configIndex]);
+
+                        if (++configIndex < configs.size())
+                        {
+                            applyConfig (configs[configIndex]);
+                            enter (Phase::settling);
+                        }
+                        else
+                        {
+                            finish();
+                        }
+                    }
+                    break;
+
+                case Phase::idle:
+                    break;
+            }
+        }
+
+        void enter (Phase p)
+        {
+            phase = p;
+            steps = 0;
+
+            if (p == Phase::measuring)
+                notesSent = 0;
+        }
+
+        static int noteFor (int index) noexcept { return 36 + index % 48; }
+
+        void sendProbeNote()
+        {
+            const int note = noteFor (notesSent++);
+
+            {
+                const juce::ScopedLock sl (lock);
+                auto& s = sent[(size_t) note];
+                s = {};
+                s.sentMs = juce::Time::getMillisecondCounterHiRes();
+                ccPendingSinceMs = s.sentMs;
+            }
+
+            send (juce::MidiMessage::controllerEvent (probeChannel, thruController, note));
+            send (juce::MidiMessage::noteOn (probeChannel, note, (juce::uint8) 127));
+        }
+
+        // MIDI clock keeps the sync path busy the way a running sequencer does.
+        void hiResTimerCallback() override
+        {
+            send (juce::MidiMessage::midiClock());
+        }
+
+        // Message thread and HighResolutionTimer thread
+        void send (const juce::MidiMessage& m)
+        {
+            const juce::ScopedLock sl (sendLock);
+
+            if (probeOut != nullptr)
+                probeOut->sendMessageNow (m);
+        }
+
+        void finish()
+        {
+            juce::Timer::stopTimer();
+            HighResolutionTimer::stopTimer();
+
+           #if JUCE_LINUX && JucePlugin_Build_Standalone
+            if (auto* holder = juce::StandalonePluginHolder::getInstance(); holder != nullptr && phase != Phase::connecting)
+            {
+                send (juce::MidiMessage::allNotesOff (probeChannel));
+
+                holder->deviceManager.setAudioDeviceSetup (savedAudioSetup, true);
+                holder->deviceManager.setMidiInputDeviceEnabled (probeInputId, probeInputWasEnabled);
+                setAppMidiOutput (*holder, savedDefaultOutput);
+
+                processor.setStateInformation (savedState.getData(), (int) savedState.getSize());
+            }
+           #endif
+
+            if (probeIn != nullptr)
+                probeIn->stop();
+
+            probeIn.reset();
+
+            {
+                const juce::ScopedLock sl (sendLock);
+                probeOut.reset();
+            }
+
+            phase = Phase::idle;
+
+            if (auto done = std::exchange (onFinished, nullptr))
+                done (report);
+        }
+
+        // ── Receipt (MIDI input thread) ───────────────────────────────────────
+        void handleIncomingMidiMessage (juce::MidiInput*, const juce::MidiMessage& m) override
+        {
+            const double now = juce::Time::getMillisecondCounterHiRes();
+            const int ch = m.getChannel();
+
+            const juce::ScopedLock sl (lock);
+
+            if (m.isNoteOn())
+            {
+                auto& s = sent[(size_t) m.getNoteNumber()];
+
+                if (s.sentMs <= 0.0)
+                    return;
+
+                if (ch == echoChannel && ! std::exchange (s.echoSeen, true))
+                    echo.push_back (now - s.sentMs - echoDelayMs);
+            }
+            else if (m.isControllerOfType (thruController) && ch == probeChannel)
+            {
+                auto& s = sent[(size_t) m.getControllerValue()];
+
+                if (s.sentMs > 0.0 && ! std::exchange (s.thruSeen, true))
+                    thru.push_back (now - s.sentMs);
+            }
+            else if (m.isController() && ch == ccChannel && ccPendingSinceMs > 0.0)
+            {
+                cc.push_back (now - ccPendingSinceMs);
+                ccPendingSinceMs = 0.0;
+            }
+        }
+
+        // ── Report ────────────────────────────────────────────────────────────
+        void appendConfigReport (const Config& c)
+        {
+            const auto limiter = apvts.getParameter ("midiRateLimiter");
+
+            report << (c.bufferSize > 0 ? "buffer " + juce::String (c.bufferSize)
+                                        : juce::String (processor.getMidiTimingEngine().isRunning() ? "timing engine" : "current buffer"))
+                   << ", rate limiter " << (limiter != nullptr ? limiter->getCurrentValueAsText() : juce::String())
+                   << "\n";
+
+            const juce::ScopedLock sl (lock);
+            report << describe ("  thru", thru) << describe ("  cc  ", cc) << describe ("  echo", echo);
+        }
+
+        static juce::String describe (const char* label, std::vector<double> v)
+        {
+            juce::String line (label);
+
+            if (v.empty())
+                return line + "  no messages\n";
+
+            std::sort (v.begin(), v.end());
+
+            double mean = 0.0;
+            for (const auto x : v)
+                mean += x;
+            mean /= (double) v.size();
+
+            double var = 0.0;
+            for (const auto x : v)
+                var += (x - mean) * (x - mean);
+
+            const auto at = [&v] (double q) { return v[(size_t) juce::jmin ((double) v.size() - 1.0, std::floor (q * (double) v.size()))]; };
+            const auto ms = [] (double x) { return juce::String (x, 2); };
+
+            line << "  n " << (int) v.size() << "/" << notesPerConfig
+                 << "  min " << ms (v.front()) << "  med " << ms (at (0.5)) << "  p95 " << ms (at (0.95))
+                 << "  max " << ms (v.back()) << "  jitter " << ms (std::sqrt (var / (double) v.size())) << " ms\n";
+
+            return line;
+        }
+
+        ModzTaktAudioProcessor& processor;
+        juce::AudioProcessorValueTreeState& apvts;
+
+        Phase phase = Phase::idle;
+        int   steps = 0;
+        int   notesSent = 0;
+
+        std::vector<Config> configs;
+        size_t configIndex = 0;
+
+        std::unique_ptr<juce::MidiOutput> probeOut;   // sent to through send() only
+        juce::CriticalSection sendLock;
+        std::unique_ptr<juce::MidiInput>  probeIn;
+
+        // Restored by finish()
+        juce::MemoryBlock savedState;
+        juce::AudioDeviceManager::AudioDeviceSetup savedAudioSetup;
+        juce::String probeInputId, savedDefaultOutput;
+        bool probeInputWasEnabled = false;
+
+        // Shared with the MIDI input thread
+        juce::CriticalSection lock;
+        std::array<SentNote, 128> sent {};
+        double ccPendingSinceMs = 0.0;
+        std::vector<double> thru, cc, echo;
+
+        juce::String report;
+        Finished onFinished;
+
+        JUCE_DECLARE_NON_COPYABLE (LatencyProbe)
+    };
+} // namespace modztakt::standalone
@@ -1,8 +1,11 @@
 #pragma once
-#include <JuceHeader.h>
+#include <juce_audio_basics/juce_audio_basics.h>
 #include <array>
+#include <climits>
+#include <cstdint>
 
 #include "SyntaktParameterTable.h"
+#include "CurveSimplifier.h"
 
 namespace modztakt::lfo
 {
@@ -16,30 +19,8 @@ namespace modztakt::lfo
         Random
     };
 
-    struct LfoRoute
-    {
-        int  midiChannel = 0;      // 0 = disabled, 1..16 = enabled
-        int  parameterIndex = -1;  // index into syntaktParameters
-        bool bipolar = false;
-        bool invertPhase = false;
-        bool oneShot = false;
-
-        // runtime state
-        bool hasFinishedOneShot = false;
-        bool passedPeak = false;
-
-        double totalPhaseAdvanced = 0.0;  // ADD THIS
-    };
-
-    // Cache last route settings to detect changes (so we can reset oneshot/phase only when needed)
-    struct RouteSnapshot
-    {
-        int  midiChannel = 0;
-        int  paramIndex  = 0;
-        bool bipolar     = false;
-        bool invert      = false;
-        bool oneShot     = false;
-    };
+    // LFO routes per instance: enough for every Syntakt track (12) plus spares
+    static constexpr int maxRoutes = 16;
 
     //==============================================================================
     inline bool advancePhase (double& phase, double inc) noexcept
@@ -201,118 +182,124 @@ namespace modztakt::lfo
     }
 
     //==============================================================================
+    // LFO routes, struct-of-arrays
+    //
+    // One array per field so the per-step loop touches only what it reads
+    // (phase, channel, parameter, flags) for the routes that are on.  The
+    // active list holds the indices of routes with a channel and a parameter,
+    // in ascending order; iterating the table walks that list:
+    //
+    //     for (const int r : table)   // active routes only
+    //
+    // Call updateActive() after changing channel / paramIndex.
+    //==============================================================================
+    namespace RouteFlag
+    {
+        // settings
+        constexpr uint8_t bipolar    = 1u << 0;
+        constexpr uint8_t invert     = 1u << 1;
+        constexpr uint8_t oneShot    = 1u << 2;
+
+        // runtime
+        constexpr uint8_t finished   = 1u << 3;   // one-shot cycle completed
+        constexpr uint8_t passedPeak = 1u << 4;
+        constexpr uint8_t suppressed = 1u << 5;   // silenced by noteOffStop
+
+        constexpr uint8_t settings = bipolar | invert | oneShot;
+        constexpr uint8_t runtime  = finished | passedPeak | suppressed;
+    }
 
-    template <size_t MaxRoutes>
-    inline void syncRoutesFromApvts (juce::AudioProcessorValueTreeState& apvts,
-                                    LfoShape currentShape,
-                                    std::array<LfoRoute, MaxRoutes>& lfoRoutes,
-                                    std::array<RouteSnapshot, MaxRoutes>& lastRouteSnapshot,
-                                    std::array<double, MaxRoutes>& lfoPhase)
+    template <int MaxRoutes>
+    struct RouteTable
     {
-        for (size_t i = 0; i < MaxRoutes; ++i)
+        static constexpr int capacity = MaxRoutes;
+        static constexpr int notSent  = INT_MIN;   // lastSent before the first value
+
+        // Settings
+        std::array<int,     MaxRoutes> channel {};       // 0 = disabled, 1..16
+        std::array<int,     MaxRoutes> paramIndex {};    // into the instrument map, -1 = none
+        std::array<int,     MaxRoutes> port {};          // output port (0 = main)
+        std::array<uint8_t, MaxRoutes> flags {};         // RouteFlag bits
+
+        // Runtime
+        std::array<double,  MaxRoutes> phase {};
+        std::array<double,  MaxRoutes> phaseAdvanced {}; // since the last (re)start, for one-shots
+        std::array<int,     MaxRoutes> lastSent {};      // data throttle
+        std::array<double,  MaxRoutes> lastSendMs {};    // rate limiter
+        std::array<curve::Simplifier, MaxRoutes> curve {};   // curve compression
+
+        RouteTable() noexcept
         {
-            const auto rs = juce::String((int)i);
-
-            const int chChoice0 = (int) apvts.getRawParameterValue("route" + rs + "_channel")->load(); // 0=Disabled, 1..16=Ch1..16
-
-            const int midiChannel = (chChoice0 == 0) ? 0 : chChoice0;
-
-            const int paramIdx = (int) apvts.getRawParameterValue("route" + rs + "_param")->load();   // 0..N-1
-
-            bool bipolar =
-                apvts.getRawParameterValue("route" + rs + "_bipolar")->load() > 0.5f;
-
-            bool invert =
-                apvts.getRawParameterValue("route" + rs + "_invert")->load() > 0.5f;
-
-            bool oneShot =
-                apvts.getRawParameterValue("route" + rs + "_oneshot")->load() > 0.5f;
-
-            // Engine constraint: Random ignores these (you can also enforce via UI)
-            if (currentShape == LfoShape::Random)
-            {
-                bipolar = false;
-                invert  = false;
-            }
-
-            // ============================================================
-            // Enforce exclusivity: (channel, param) must be unique.
-            // Deterministic rule: first route (lowest index) wins.
-            // Conflicting later routes are force-disabled at engine level.
-            // ============================================================
-            int effectiveChannel = midiChannel;
+            paramIndex.fill (-1);
+            lastSent.fill (notSent);
+        }
 
-            if (effectiveChannel != 0 && paramIdx >= 0)
-            {
-                for (size_t j = 0; j < i; ++j)
-                {
-                    const auto js = juce::String((int)j);
+        bool has (int r, uint8_t f) const noexcept { return (flags[(size_t) r] & f) != 0; }
 
-                    const int chJ0 = (int) apvts.getRawParameterValue("route" + js + "_channel")->load();
-                    const int chJ  = (chJ0 == 0) ? 0 : chJ0;
+        void set (int r, uint8_t f, bool on) noexcept
+        {
+            auto& v = flags[(size_t) r];
+            v = (uint8_t) (on ? (v | f) : (v & ~f));
+        }
 
-                    if (chJ == 0)
-                        continue;
+        // Same flag change on every route, active or not
+        void setAll (uint8_t f, bool on) noexcept
+        {
+            for (int r = 0; r < MaxRoutes; ++r)
+                set (r, f, on);
+        }
 
-                    const int paramJ = (int) apvts.getRawParameterValue("route" + js + "_param")->load();
+        bool isEnabled (int r) const noexcept { return channel[(size_t) r] > 0 && paramIndex[(size_t) r] >= 0; }
 
-                    if (chJ == effectiveChannel && paramJ == paramIdx)
-                    {
-                        effectiveChannel = 0; // disable this route
-                        break;
-                    }
-                }
-            }
+        void updateActive() noexcept
+        {
+            numActive = 0;
 
-            // Detect changes (so we can reset runtime-only flags safely)
-            const RouteSnapshot now { effectiveChannel, paramIdx, bipolar, invert, oneShot };
+            for (int r = 0; r < MaxRoutes; ++r)
+                if (isEnabled (r))
+                    active[(size_t) numActive++] = r;
+        }
 
-            const auto& prev = lastRouteSnapshot[i];
+        // Back to the shape's start phase, runtime flags cleared
+        void restart (int r, LfoShape shape) noexcept
+        {
+            phase[(size_t) r] = getWaveformStartPhase (shape, has (r, RouteFlag::bipolar));
+            phaseAdvanced[(size_t) r] = 0.0;
+            set (r, RouteFlag::runtime, false);
+        }
 
-            const bool channelChanged = (now.midiChannel != prev.midiChannel);
-            const bool paramChanged   = (now.paramIndex  != prev.paramIndex);
-            const bool modeChanged    = (now.bipolar     != prev.bipolar) || (now.invert != prev.invert);
-            const bool oneshotChanged = (now.oneShot     != prev.oneShot);
+        void restartAll (LfoShape shape) noexcept
+        {
+            for (int r = 0; r < MaxRoutes; ++r)
+                restart (r, shape);
+        }
 
-            // Apply to engine route
-            auto& r = lfoRoutes[i];
-            r.midiChannel     = now.midiChannel;   // 0 means disabled
-            r.parameterIndex  = now.paramIndex;
-            r.bipolar         = now.bipolar;
-            r.invertPhase     = now.invert;
+        // Forget the last value sent (route moved to another channel / parameter)
+        void resetThrottle (int r) noexcept
+        {
+            lastSent[(size_t) r]   = notSent;
+            lastSendMs[(size_t) r] = 0.0;
+            curve[(size_t) r].reset();
+        }
 
-            // if oneshot is turned off, clear completion state so it can run again next time
-            if (!now.oneShot)
-                r.hasFinishedOneShot = false;
-            r.oneShot = now.oneShot;
+        int getNumActive() const noexcept { return numActive; }
 
-            // If route settings changed while running, it’s safe to reset runtime state.
-            // This replaces your old “stop LFO during combobox interaction” trick.
-            if (channelChanged || paramChanged || modeChanged || oneshotChanged)
-            {
-                r.hasFinishedOneShot = false;
-                r.passedPeak = false;
+        const int* begin() const noexcept { return active.data(); }
+        const int* end()   const noexcept { return active.data() + numActive; }
 
-                // Re-align phase when the *shape/mode* changes,
-                // or when route is re-enabled.
-                const bool routeBecameEnabled = (prev.midiChannel == 0 && now.midiChannel != 0);
-                if (modeChanged || routeBecameEnabled)
-                {
-                    lfoPhase[i] = getWaveformStartPhase (currentShape, now.bipolar);
-                }
-            }
+    private:
+        std::array<int, MaxRoutes> active {};
+        int numActive = 0;
+    };
 
-            lastRouteSnapshot[i] = now;
-        }
-    }
+    //==============================================================================
 
-    template <size_t MaxRoutes>
+    template <int MaxRoutes>
     inline void applyLfoActiveState (bool shouldBeActive,
                                     LfoShape shape,
                                     bool& lfoActive,
                                     bool& lfoRuntimeMuted,
-                                    std::array<LfoRoute, MaxRoutes>& lfoRoutes,
-                                    std::array<double, MaxRoutes>& lfoPhase)
+                                    RouteTable<MaxRoutes>& routes)
     {
         if (shouldBeActive == lfoActive)
             return;
@@ -324,23 +311,142 @@ namespace modztakt::lfo
         {
             lfoRuntimeMuted = false;
 
-            for (size_t i = 0; i < MaxRoutes; ++i)
+            for (int r = 0; r < MaxRoutes; ++r)
             {
-                auto& route = lfoRoutes[i];
+                routes.phase[(size_t) r] = getWaveformStartPhase (shape, routes.has (r, RouteFlag::bipolar));
+                routes.phaseAdvanced[(size_t) r] = 0.0;
+                routes.set (r, RouteFlag::finished | RouteFlag::passedPeak, false);
+            }
+        }
+        else
+        {
+            routes.setAll (RouteFlag::finished | RouteFlag::passedPeak, false);
+        }
+    }
+
+    //==============================================================================
+    // One block of LFO output
+    //
+    // The per-step loop of the plugin and of the engine core (EngineCore.h),
+    // shared so both send the same values: about 128 steps per cycle (8 to 128
+    // samples apart), phase and one-shot handling, and the waveform mapped into
+    // each route's parameter range around the live knob (knobFollow).  What
+    // happens to a value next (curve compression, throttle, port) is up to
+    // the caller's `output`:
+    //
+    //     int  knob (int route, int paramIndex);          // live knob position, or -1
+    //     void send (int route, const SyntaktParameter&, const RouteValue&, int offset);
+    //     void finished (int route, const SyntaktParameter&);  // one-shot done, after its last value
+    //==============================================================================
+    struct BlockParams
+    {
+        LfoShape shape      = LfoShape::Sine;
+        double   rateHz     = 1.0;
+        double   depth      = 1.0;       // 0..1
+        double   sampleRate = 48000.0;
+        int      numSamples = 0;
+    };
 
-                lfoPhase[i] = getWaveformStartPhase(shape, route.bipolar);
+    // EG → LFO: while the envelope has a value it scales rate and / or depth (0 to full).
+    inline void applyEgModulation (BlockParams& block, double eg01, bool toRate, bool toDepth) noexcept
+    {
+        if (toRate)
+            block.rateHz *= eg01;
 
-                route.hasFinishedOneShot = false;
-                route.passedPeak = false;
-                route.totalPhaseAdvanced = 0.0;
-            }
+        if (toDepth)
+            block.depth *= eg01;
+    }
+
+    struct RouteValue
+    {
+        int    midiValue = 0;
+        double value01   = 0.0;   // unquantised position in [min, max] (MIDI 2.0, curve compression)
+    };
+
+    // Waveform value (-1..1) → parameter value.
+    // knob >= 0: live knob position (knobFollow) — bipolar swings around it,
+    // unipolar rises from it towards the top of the range.
+    inline RouteValue mapToParam (double shape, double depth, bool bipolar,
+                                  const SyntaktParameter& param, int knob = -1) noexcept
+    {
+        RouteValue v;
+        const double span = (double) (param.maxValue - param.minValue);
+
+        if (bipolar)
+        {
+            const int center = (knob >= 0) ? knob : (param.minValue + param.maxValue) / 2;
+            const int range  = (param.maxValue - param.minValue) / 2;
+            v.midiValue = center + int (std::round (shape * depth * range));
+            v.value01   = (knob >= 0 ? (knob - param.minValue) / span : 0.5) + 0.5 * shape * depth;
         }
         else
         {
-            for (size_t i = 0; i < MaxRoutes; ++i)
+            const double uni    = juce::jlimit (0.0, 1.0, (shape + 1.0) * 0.5);
+            const double base01 = (knob >= 0) ? (knob - param.minValue) / span : 0.0;
+            v.value01   = base01 + uni * depth * (1.0 - base01);
+            v.midiValue = param.minValue + int (std::round (v.value01 * span));
+        }
+
+        v.value01   = juce::jlimit (0.0, 1.0, v.value01);
+        v.midiValue = juce::jlimit (param.minValue, param.maxValue, v.midiValue);
+        return v;
+    }
+
+    // Samples between two LFO steps: ~128 per cycle, 8..128, never past the block.
+    inline int getStepSamples (double sampleRate, double rateHz, int numSamples) noexcept
+    {
+        int stepSamples = (int) std::round (juce::jmax (1.0, sampleRate) / juce::jmax (0.001, rateHz) / 128.0);
+
+        stepSamples = juce::jlimit (8, 128, stepSamples);
+        return juce::jlimit (1, juce::jmax (1, numSamples), stepSamples);
+    }
+
+    template <int MaxRoutes, typename ParamTable, typename Output>
+    inline void renderBlock (RouteTable<MaxRoutes>& routes,
+                             const BlockParams& block,
+                             const ParamTable& params,
+                             juce::Random& random,
+                             Output& output)
+    {
+        const double phaseIncPerSample = block.rateHz / juce::jmax (1.0, block.sampleRate);
+        const int stepSamples = getStepSamples (block.sampleRate, block.rateHz, block.numSamples);
+
+        for (int offset = 0; offset < block.numSamples; offset += stepSamples)
+        {
+            const double phaseIncThis = phaseIncPerSample * (double) juce::jmin (stepSamples, block.numSamples - offset);
+
+            for (const int r : routes)   // active routes only
             {
-                lfoRoutes[i].hasFinishedOneShot = false;
-                lfoRoutes[i].passedPeak = false;
+                const auto ri = (size_t) r;
+                const auto flags = routes.flags[ri];
+                const bool oneShot = (flags & RouteFlag::oneShot) != 0;
+                const bool bipolar = (flags & RouteFlag::bipolar) != 0;
+
+                if (oneShot && (flags & RouteFlag::finished) != 0)
+                    continue;
+
+                // Silenced by noteOffStop
+                if ((flags & RouteFlag::suppressed) != 0)
+                    continue;
+
+                // Accumulate before advancing
+                routes.phaseAdvanced[ri] += phaseIncThis;
+                advancePhase (routes.phase[ri], phaseIncThis);
+
+                const double shape = computeWaveform (block.shape, routes.phase[ri], bipolar,
+                                                      (flags & RouteFlag::invert) != 0, random);
+
+                const int   paramIndex = routes.paramIndex[ri];
+                const auto& param      = params[paramIndex];
+
+                output.send (r, param, mapToParam (shape, block.depth, bipolar, param, output.knob (r, paramIndex)), offset);
+
+                // One-shot: complete after a full cycle
+                if (oneShot && routes.phaseAdvanced[ri] >= 1.0)
+                {
+                    routes.set (r, RouteFlag::finished, true);
+                    output.finished (r, param);
+                }
             }
         }
     }
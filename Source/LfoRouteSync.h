@@ -0,0 +1,133 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+#include "LfoEngine.h"
+#include "RouteOccupancy.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// LFO routes ← APVTS
+//
+// Reads the route{r}_* parameters into the engine's RouteTable once per
+// block, applies first-route-wins exclusivity and resets runtime state only
+// for routes whose settings moved.  Parameter pointers are looked up once, so
+// a sync builds no strings whatever the route count.  Kept out of
+// LfoEngine.h so the engine itself needs no juce_audio_processors (see
+// EngineCore.h).
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::lfo
+{
+    template <int MaxRoutes>
+    class RouteSync
+    {
+    public:
+        static_assert (MaxRoutes <= routing::maxLfoRoutes, "routes past the occupancy table");
+
+        explicit RouteSync (juce::AudioProcessorValueTreeState& apvts)
+        {
+            for (int r = 0; r < MaxRoutes; ++r)
+            {
+                const auto rs = juce::String (r);
+                auto& p = params[(size_t) r];
+
+                p.channel = apvts.getRawParameterValue ("route" + rs + "_channel");   // 0=Disabled, 1..16=Ch1..16
+                p.param   = apvts.getRawParameterValue ("route" + rs + "_param");     // 0..N-1
+                p.port    = apvts.getRawParameterValue ("route" + rs + "_port");
+                p.bipolar = apvts.getRawParameterValue ("route" + rs + "_bipolar");
+                p.invert  = apvts.getRawParameterValue ("route" + rs + "_invert");
+                p.oneShot = apvts.getRawParameterValue ("route" + rs + "_oneshot");
+            }
+        }
+
+        void sync (const routing::Occupancy& occupancy,
+                   const instrument::InstrumentMap& map,
+                   LfoShape currentShape,
+                   RouteTable<MaxRoutes>& routes) noexcept
+        {
+            for (int r = 0; r < MaxRoutes; ++r)
+            {
+                const auto& p = params[(size_t) r];
+
+                int channel = (int) p.channel->load (std::memory_order_relaxed);
+                int paramIdx = (int) p.param->load (std::memory_order_relaxed);
+                const int port = (int) p.port->load (std::memory_order_relaxed);
+
+                if (! map.isValidIndex (paramIdx))   // past the map's end: off
+                    paramIdx = -1;
+
+                uint8_t settings = 0;
+                if (p.bipolar->load (std::memory_order_relaxed) > 0.5f) settings |= RouteFlag::bipolar;
+                if (p.invert ->load (std::memory_order_relaxed) > 0.5f) settings |= RouteFlag::invert;
+                if (p.oneShot->load (std::memory_order_relaxed) > 0.5f) settings |= RouteFlag::oneShot;
+
+                // Engine constraint: Random ignores these (you can also enforce via UI)
+                if (currentShape == LfoShape::Random)
+                    settings &= (uint8_t) ~(RouteFlag::bipolar | RouteFlag::invert);
+
+                // ============================================================
+                // Enforce exclusivity: (port, channel, param) must be unique.
+                // Deterministic rule: first route (lowest index) wins.
+                // Conflicting later routes are force-disabled at engine level.
+                // ============================================================
+                if (paramIdx >= 0 && occupancy.isClaimed (channel, paramIdx, routing::Owner::lfoBefore (r)))
+                    for (int j = 0; j < r; ++j)
+                        if (routes.port[(size_t) j] == port && routes.channel[(size_t) j] == channel
+                            && routes.paramIndex[(size_t) j] == paramIdx)
+                        {
+                            channel = 0;   // disable this route
+                            break;
+                        }
+
+                // Detect changes (so we can reset runtime-only flags safely)
+                const uint8_t prevSettings = routes.flags[(size_t) r] & RouteFlag::settings;
+                const int prevChannel = routes.channel[(size_t) r];
+
+                const bool targetChanged  = channel != prevChannel || paramIdx != routes.paramIndex[(size_t) r]
+                                            || port != routes.port[(size_t) r];
+                const bool modeChanged    = ((settings ^ prevSettings) & (RouteFlag::bipolar | RouteFlag::invert)) != 0;
+                const bool oneshotChanged = ((settings ^ prevSettings) & RouteFlag::oneShot) != 0;
+
+                routes.channel[(size_t) r]    = channel;
+                routes.paramIndex[(size_t) r] = paramIdx;
+                routes.port[(size_t) r]       = port;
+                routes.flags[(size_t) r]      = (uint8_t) ((routes.flags[(size_t) r] & RouteFlag::runtime) | settings);
+
+                // if oneshot is turned off, clear completion state so it can run again next time
+                if ((settings & RouteFlag::oneShot) == 0)
+                    routes.set (r, RouteFlag::finished, false);
+
+                // If route settings changed while running, it's safe to reset runtime state.
+                if (targetChanged || modeChanged || oneshotChanged)
+                {
+                    routes.set (r, RouteFlag::finished | RouteFlag::passedPeak, false);
+
+                    // Re-align phase when the *shape/mode* changes,
+                    // or when route is re-enabled.
+                    const bool routeBecameEnabled = (prevChannel == 0 && channel != 0);
+                    if (modeChanged || routeBecameEnabled)
+                        routes.phase[(size_t) r] = getWaveformStartPhase (currentShape, (settings & RouteFlag::bipolar) != 0);
+                }
+
+                // New destination: its first value always goes out
+                if (targetChanged)
+                    routes.resetThrottle (r);
+            }
+
+            routes.updateActive();
+        }
+
+    private:
+        struct ParamPtrs
+        {
+            std::atomic<float>* channel = nullptr;
+            std::atomic<float>* param   = nullptr;
+            std::atomic<float>* port    = nullptr;
+            std::atomic<float>* bipolar = nullptr;
+            std::atomic<float>* invert  = nullptr;
+            std::atomic<float>* oneShot = nullptr;
+        };
+
+        std::array<ParamPtrs, MaxRoutes> params {};
+    };
+} // namespace modztakt::lfo
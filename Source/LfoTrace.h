@@ -0,0 +1,220 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstdint>
+#include <vector>
+
+#include "UiEventQueue.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// LFO run-state trace
+//
+// The audio thread packs the LFO start/stop flags (LfoRunIntent, forcing,
+// mute and UI auto-latch state) into one word and writes a 24-byte record
+// only when that word changes, plus one record per incoming note.  Records go
+// through a preallocated SPSC queue (UiEventQueue.h), so tracing costs a
+// compare per block and a few stores per transition: it stays on in release
+// builds.
+//
+// A low-priority thread drains the queue into a history ring of the last
+// historySize records.  exportChromeTrace() writes that history as Chrome
+// trace-event JSON (chrome://tracing, Perfetto): flag changes and notes as
+// instant events on separate tracks, "running" as a counter.  Timestamps are
+// the processor's ms timeline (block start, plus the sample offset for notes).
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::trace
+{
+    namespace Flag
+    {
+        enum : uint32_t
+        {
+            userButtonOn     = 1u << 0,
+            userExplicitStop = 1u << 1,
+            noteForce        = 1u << 2,
+            playForce        = 1u << 3,
+            egForce          = 1u << 4,
+            transportGate    = 1u << 5,
+            syncEnabled      = 1u << 6,
+            shouldRun        = 1u << 7,
+            showUiOn         = 1u << 8,
+            lfoActive        = 1u << 9,
+            runtimeMuted     = 1u << 10,
+            uiAutoOnByNote   = 1u << 11,
+            uiAutoOnByEg     = 1u << 12,
+            egWasForcing     = 1u << 13
+        };
+
+        static constexpr int numFlags = 14;
+    }
+
+    static constexpr const char* flagNames[Flag::numFlags] =
+    {
+        "userButtonOn", "userExplicitStop", "noteForce", "playForce", "egForce",
+        "transportGate", "syncEnabled", "shouldRun", "showUiOn", "lfoActive",
+        "runtimeMuted", "uiAutoOnByNote", "uiAutoOnByEg", "egWasForcing"
+    };
+
+    struct Record
+    {
+        enum class Kind : uint8_t { lfoState, noteOn, noteOff };
+
+        double   timeMs  = 0.0;
+        uint32_t seq     = 0;      // set by the queue
+        uint32_t flags   = 0;      // lfoState: state after the transition
+        uint16_t changed = 0;      // lfoState: flags that moved
+        Kind     kind    = Kind::lfoState;
+        uint8_t  channel = 0;      // notes: 1..16
+        uint8_t  note    = 0;
+        uint8_t  velocity = 0;
+    };
+
+    class Recorder : private juce::Thread
+    {
+    public:
+        static constexpr int historySize = 1 << 16;
+        static constexpr int drainIntervalMs = 50;
+
+        Recorder() : juce::Thread ("ModzTakt LFO trace")
+        {
+            history.resize ((size_t) historySize);
+            startThread (juce::Thread::Priority::low);
+        }
+
+        ~Recorder() override { stopThread (1000); }
+
+        static juce::File getTraceFolder()
+        {
+            return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+                       .getChildFile ("ModzTakt")
+                       .getChildFile ("Traces");
+        }
+
+        // ── Audio thread ──────────────────────────────────────────────────────
+        void traceState (double timeMs, uint32_t flags) noexcept
+        {
+            if (flags == lastFlags)
+                return;
+
+            Record r;
+            r.timeMs  = timeMs;
+            r.flags   = flags;
+            r.changed = (uint16_t) (flags ^ lastFlags);
+            queue.push (r);
+
+            lastFlags = flags;
+        }
+
+        void traceNote (double timeMs, const juce::MidiMessage& msg) noexcept
+        {
+            Record r;
+            r.timeMs   = timeMs;
+            r.kind     = msg.isNoteOn() ? Record::Kind::noteOn : Record::Kind::noteOff;
+            r.channel  = (uint8_t) msg.getChannel();
+            r.note     = (uint8_t) msg.getNoteNumber();
+            r.velocity = msg.getVelocity();
+            queue.push (r);
+        }
+
+        // ── Message thread ────────────────────────────────────────────────────
+        // Writes the history to `file` (Chrome trace-event JSON).
+        juce::Result exportChromeTrace (const juce::File& file)
+        {
+            std::vector<Record> records;
+            uint64_t lost = 0;
+
+            {
+                const juce::ScopedLock sl (historyLock);
+                drainLocked();
+
+                const auto n = juce::jmin (written, (uint64_t) historySize);
+                records.reserve ((size_t) n);
+
+                for (auto i = written - n; i < written; ++i)
+                    records.push_back (history[(size_t) (i % historySize)]);
+
+                lost = dropped;
+            }
+
+            juce::MemoryOutputStream json;
+            json << "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedRecords\":" << juce::String ((juce::int64) lost)
+                 << "},\"traceEvents\":[\n";
+
+            json << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"LFO state\"}},\n"
+                    "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"MIDI in\"}}";
+
+            for (const auto& r : records)
+            {
+                const auto ts = juce::String (r.timeMs * 1000.0, 1);
+
+                if (r.kind == Record::Kind::lfoState)
+                {
+                    juce::StringArray changedNames;
+                    juce::String args;
+
+                    for (int f = 0; f < Flag::numFlags; ++f)
+                    {
+                        if ((r.changed & (1u << f)) != 0)
+                            changedNames.add (flagNames[f]);
+
+                        args << (f > 0 ? "," : "") << "\"" << flagNames[f] << "\":" << (int) ((r.flags >> f) & 1u);
+                    }
+
+                    json << ",\n{\"name\":\"" << changedNames.joinIntoString (" ") << "\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":1,\"ts\":"
+                         << ts << ",\"args\":{" << args << "}}";
+
+                    json << ",\n{\"name\":\"LFO running\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":" << ts
+                         << ",\"args\":{\"running\":" << (int) ((r.flags & Flag::shouldRun) != 0) << "}}";
+                }
+                else
+                {
+                    json << ",\n{\"name\":\"" << (r.kind == Record::Kind::noteOn ? "noteOn" : "noteOff")
+                         << "\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":2,\"ts\":" << ts
+                         << ",\"args\":{\"channel\":" << (int) r.channel << ",\"note\":" << (int) r.note
+                         << ",\"velocity\":" << (int) r.velocity << "}}";
+                }
+            }
+
+            json << "\n]}\n";
+
+            if (! file.getParentDirectory().createDirectory() || ! file.replaceWithData (json.getData(), json.getDataSize()))
+                return juce::Result::fail ("could not write " + file.getFullPathName());
+
+            return juce::Result::ok();
+        }
+
+    private:
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                {
+                    const juce::ScopedLock sl (historyLock);
+                    drainLocked();
+                }
+
+                wait (drainIntervalMs);
+            }
+        }
+
+        // Single consumer: callers hold historyLock.
+        void drainLocked() noexcept
+        {
+            const auto d = queue.drain ([this] (const Record& r)
+            {
+                history[(size_t) (written++ % historySize)] = r;
+            });
+
+            dropped += d.lost;
+        }
+
+        ui::MessageQueue<Record, 4096> queue;
+        uint32_t lastFlags = 0;   // audio thread only
+
+        juce::CriticalSection historyLock;
+        std::vector<Record> history;    // ring of the last historySize records
+        uint64_t written = 0;
+        uint64_t dropped = 0;
+
+        JUCE_DECLARE_NON_COPYABLE (Recorder)
+    };
+} // namespace modztakt::trace
@@ -6,18 +6,24 @@
 #include "EnvelopeEditorComponent.h"
 #include "DelayEditorComponent.h"
 #include "ScopeModalComponent.h"
+#include "MidiPortsEditorComponent.h"
 #include "Cosmetic.h"
+#include "UiRefresh.h"
+#include "UiEventQueue.h"
+#include "RouteOccupancy.h"
+#include "LatencyProbe.h"
 
 class MainComponent : public juce::Component,
-                      private juce::Timer,
                       private juce::AudioProcessorValueTreeState::Listener
 {
 public:
     MainComponent (ModzTaktAudioProcessor& p)
                                             : processor (p),
                                               apvts (p.getAPVTS()),
-                                              envelopeEditor (apvts),
-                                              delayEditor (apvts)
+                                              uiRefresh (apvts, p.getUiChanges()),
+                                              routeOccupancy (apvts, p.getInstrumentMap()),
+                                              envelopeEditor (apvts, p.getInstrumentMaps(), routeOccupancy, uiRefresh),
+                                              delayEditor (apvts, p.getInstrumentMaps(), routeOccupancy, uiRefresh)
     {
         // frame
         lfoGroup.setText("LFO");
@@ -303,7 +309,7 @@ public:
         oneShotLabel.setColour (juce::Label::textColourId, SetupUI::labelsColor);
         addAndMakeVisible(oneShotLabel);
 
-        // Multi-CC Routing (3 routes)
+        // Multi-CC Routing (maxRoutes routes, visibleRoutes rows on screen, the rest scroll)
         for (int i = 0; i < maxRoutes; ++i)
         {
             const auto rs = juce::String(i);
@@ -311,7 +317,7 @@ public:
             // Label
             routeLabels[i].setText("Route " + juce::String(i + 1), juce::dontSendNotification);
             routeLabels[i].setColour (juce::Label::textColourId, SetupUI::labelsColor);
-            addAndMakeVisible(routeLabels[i]);
+            routeRowsContent.addAndMakeVisible(routeLabels[i]);
 
             // Channel box: must match APVTS choice order: Disabled, Ch1..Ch16
             routeChannelBoxes[i].clear();
@@ -320,26 +326,25 @@ public:
             
             for (int ch = 1; ch <= 16; ++ch)
                 routeChannelBoxes[i].addItem("Ch " + juce::String(ch), ch + 1);
-            addAndMakeVisible(routeChannelBoxes[i]);
+            routeRowsContent.addAndMakeVisible(routeChannelBoxes[i]);
 
-            // Parameter box: must match syntaktParamNames order (p+1 IDs)
+            // Parameter box: must match the instrument map order (p+1 IDs)
             routeParameterBoxes[i].clear();
-            for (int p = 0; p < juce::numElementsInArray(syntaktParameters); ++p)
-                routeParameterBoxes[i].addItem(syntaktParameters[p].name, p + 1);
-            addAndMakeVisible(routeParameterBoxes[i]);
+            routeParameterBoxes[i].addItemList(processor.getInstrumentMap().getParameterNames(), 1);
+            routeRowsContent.addAndMakeVisible(routeParameterBoxes[i]);
 
             // Toggles
             routeBipolarToggles[i] = std::make_unique<LedToggleButton>("+/-", SetupUI::LedColour::Green);
             routeBipolarToggles[i]->setButtonText("+/-");
-            addAndMakeVisible(*routeBipolarToggles[i]);
+            routeRowsContent.addAndMakeVisible(*routeBipolarToggles[i]);
 
             routeInvertToggles[i] = std::make_unique<LedToggleButton>("Inv", SetupUI::LedColour::Green);
             routeInvertToggles[i]->setButtonText("Inv");
-            addAndMakeVisible(*routeInvertToggles[i]);
+            routeRowsContent.addAndMakeVisible(*routeInvertToggles[i]);
 
             routeOneShotToggles[i] = std::make_unique<LedToggleButton>("1-Shot", SetupUI::LedColour::Orange);
             routeOneShotToggles[i]->setButtonText("1-Shot");
-            addAndMakeVisible(*routeOneShotToggles[i]);
+            routeRowsContent.addAndMakeVisible(*routeOneShotToggles[i]);
 
             // --- Attachments (must exist BEFORE you rely on parameter-driven state) ---
             routeChannelAttach[i] = std::make_unique<ChoiceAttachment>(apvts, "route" + rs + "_channel", routeChannelBoxes[i]);
@@ -382,10 +387,11 @@ public:
 
                 // After enforcement, read the (possibly corrected) selection
                 const int idx = routeParameterBoxes[i].getSelectedId() - 1;
-                if (idx < 0 || idx >= juce::numElementsInArray(syntaktParameters))
+                const auto& map = processor.getInstrumentMap();
+                if (!map.isValidIndex(idx))
                     return;
 
-                const bool paramIsBipolar = syntaktParameters[idx].isBipolar;
+                const bool paramIsBipolar = map[idx].isBipolar;
 
                 if (auto* p = apvts.getParameter("route" + juce::String(i) + "_bipolar"))
                 {
@@ -405,9 +411,17 @@ public:
             routeOneShotToggles[i]->setVisible(enabledNow && noteRestartNow);
         }
 
+        routeViewport.setViewedComponent(&routeRowsContent, false);
+        routeViewport.setScrollBarsShown(true, false);
+        routeViewport.setScrollBarThickness(8);
+        addAndMakeVisible(routeViewport);
+
         refreshRouteParamAvailability();
         for (int i = 0; i < maxRoutes; ++i)
             enforceRouteExclusivity(i);
+        delayEditor.refreshRouteAvailability();
+
+        lastInstrumentMapSerial = processor.getInstrumentMaps().getSerial();
 
         // scope image button
         scopeIcon = juce::ImageCache::getFromMemory(
@@ -458,16 +472,21 @@ public:
             juce::PopupMenu menu;
             juce::PopupMenu throttleSub;
             juce::PopupMenu limiterSub;
+            juce::PopupMenu curveSub;
             
             // Get current indices from APVTS
             int currentThrottleIndex = 0;
             int currentLimiterIndex = 0;
+            int currentCurveIndex = 0;
             
             if (auto* throttleParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("midiDataThrottle")))
                 currentThrottleIndex = throttleParam->getIndex();
             
             if (auto* limiterParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("midiRateLimiter")))
                 currentLimiterIndex = limiterParam->getIndex();
+
+            if (auto* curveParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("midiCurveTolerance")))
+                currentCurveIndex = curveParam->getIndex();
             
             // Build menus
             throttleSub.addItem(1, "Off (send every change)", true, currentThrottleIndex == 0);
@@ -483,11 +502,108 @@ public:
             limiterSub.addItem(10, "2.0ms",                   true, currentLimiterIndex == 4);
             limiterSub.addItem(11, "3.0ms",                   true, currentLimiterIndex == 5);
             limiterSub.addItem(12, "5.0ms",                   true, currentLimiterIndex == 6);
+
+            // LFO / EG / per-note EG: send only where a straight line from the last value drifts off
+            curveSub.addItem(193, "Off (send every change)", true, currentCurveIndex == 0);
+            curveSub.addItem(194, "0.5 step (fine)",         true, currentCurveIndex == 1);
+            curveSub.addItem(195, "1 step",                  true, currentCurveIndex == 2);
+            curveSub.addItem(196, "2 steps",                 true, currentCurveIndex == 3);
+            curveSub.addItem(197, "4 steps (coarse)",        true, currentCurveIndex == 4);
             
             menu.addSectionHeader("Performance");
             menu.addSubMenu("MIDI Data throttle", throttleSub);
             menu.addSubMenu("MIDI Rate limiter", limiterSub);
+            menu.addSubMenu("MIDI Curve tolerance", curveSub);
+
+            // Standalone only: drive the processor from a MIDI timing thread
+            // instead of the audio device callback.
+            if (modztakt::standalone::MidiTimingEngine::isAvailable())
+            {
+                auto& timing = processor.getMidiTimingEngine();
+                const bool running = timing.isRunning();
+                const double tick  = timing.getTickMs();
+
+                juce::PopupMenu timingSub;
+                timingSub.addItem(20, "Off (audio device clock)", true, !running);
+                timingSub.addItem(21, "0.5 ms tick", true, running && tick == 0.5);
+                timingSub.addItem(22, "1 ms tick",   true, running && tick == 1.0);
+                timingSub.addItem(23, "2 ms tick",   true, running && tick == 2.0);
+                timingSub.addItem(24, "5 ms tick",   true, running && tick == 5.0);
+                menu.addSubMenu("MIDI-only timing engine", timingSub);
+            }
+
+            // Instrument: 37 = knob follow, 38 = rescan maps folder, 39 = open folder, 40.. = select map
+            {
+                const auto& maps = processor.getInstrumentMaps();
+                const auto& selectedName = maps.getSelected().getName();
+
+                juce::PopupMenu instrumentSub;
+                for (int m = 0; m < maps.getNumMaps(); ++m)
+                    instrumentSub.addItem(40 + m, maps.getMap(m).getName(), true, maps.getMap(m).getName() == selectedName);
+
+                instrumentSub.addSeparator();
+                instrumentSub.addItem(38, "Reload maps folder");
+                instrumentSub.addItem(39, "Show maps folder...");
+
+                menu.addSectionHeader("Instrument");
+                menu.addSubMenu("Instrument map (" + selectedName + ")", instrumentSub);
+                menu.addItem(37, "Modulate around knob position", true,
+                             apvts.getRawParameterValue("knobFollow")->load() > 0.5f);
+            }
+
+            // Presets: 100.. = recall, 120.. = store, 140.. = reset toggle, 160.. = program change channel
+            {
+                const auto& bank = processor.getPresetBank();
+                namespace presets = modztakt::presets;
+
+                juce::PopupMenu recallSub, storeSub, resetSub, channelSub;
+
+                for (int s = 0; s < presets::numSlots; ++s)
+                {
+                    const auto* preset = bank.getPreset(s);
+                    const auto label = juce::String(s + 1) + ": " + bank.getSlotName(s);
+
+                    recallSub.addItem(100 + s, label, preset != nullptr, preset != nullptr && bank.getCurrentProgram() == s);
+                    storeSub.addItem(120 + s, label);
+                    resetSub.addItem(140 + s, label, preset != nullptr, preset != nullptr && preset->resetEngine);
+                }
+
+                const int pcChannel = (int) apvts.getRawParameterValue("presetProgramChannel")->load();
+                channelSub.addItem(160 + presets::programChannelOff,  "Off",  true, pcChannel == presets::programChannelOff);
+                channelSub.addItem(160 + presets::programChannelOmni, "Omni", true, pcChannel == presets::programChannelOmni);
+                for (int ch = 1; ch <= 16; ++ch)
+                    channelSub.addItem(161 + ch, "Ch " + juce::String(ch), true, pcChannel == ch + 1);
+
+                menu.addSectionHeader("Presets");
+                menu.addSubMenu("Recall preset", recallSub);
+                menu.addSubMenu("Store current settings", storeSub);
+                menu.addSubMenu("Reset LFO / echoes on recall", resetSub);
+                menu.addSubMenu("Program change channel", channelSub);
+            }
+
+            // Morph: 180 / 181 = store snapshot A / B, 182 = morph on / off (host parameter "Morph" moves A → B)
+            {
+                const auto& snapshots = processor.getMorphSnapshots();
+                namespace morph = modztakt::morph;
+
+                menu.addSectionHeader("Morph");
+                menu.addItem(180, "Store current settings as A", true, snapshots.hasSnapshot(morph::A));
+                menu.addItem(181, "Store current settings as B", true, snapshots.hasSnapshot(morph::B));
+                menu.addItem(182, "Morph A/B",
+                             snapshots.hasSnapshot(morph::A) && snapshots.hasSnapshot(morph::B),
+                             apvts.getRawParameterValue("morphEnabled")->load() > 0.5f);
+            }
+
+            menu.addSectionHeader("Outputs");
+            menu.addItem(30, "MIDI output ports...");
             menu.addSeparator();
+            menu.addItem(190, "Export LFO trace...");
+            if (modztakt::standalone::LatencyProbe::isAvailable())
+            {
+                const bool measuring = latencyProbe != nullptr && latencyProbe->isRunning();
+                menu.addItem(192, measuring ? "Measuring MIDI latency..." : "Measure MIDI latency (ALSA virtual ports)", !measuring);
+            }
+            menu.addItem(98, "Benchmark state formats");
             menu.addItem(99, "zaOum");
             
             menu.showMenuAsync(juce::PopupMenu::Options(),
@@ -510,6 +626,103 @@ public:
                             *param = index;  // Simple assignment works!
                         }
                     }
+                    else if (result >= 193 && result <= 197)
+                    {
+                        const int index = result - 193;
+                        if (auto* param = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("midiCurveTolerance")))
+                        {
+                            *param = index;
+                        }
+                    }
+                    else if (result == 20)
+                    {
+                        processor.getMidiTimingEngine().stop();
+                    }
+                    else if (result >= 21 && result <= 24)
+                    {
+                        static constexpr double tickMs[] = { 0.5, 1.0, 2.0, 5.0 };
+                        processor.getMidiTimingEngine().start (tickMs[result - 21]);
+                    }
+                    else if (result == 30)
+                    {
+                        showPortsEditor();
+                    }
+                    else if (result == 37)
+                    {
+                        if (auto* p = apvts.getParameter("knobFollow"))
+                        {
+                            p->beginChangeGesture();
+                            p->setValueNotifyingHost(p->getValue() > 0.5f ? 0.0f : 1.0f);
+                            p->endChangeGesture();
+                        }
+                    }
+                    else if (result == 38)
+                    {
+                        reloadInstrumentMaps();
+                    }
+                    else if (result == 39)
+                    {
+                        auto folder = modztakt::instrument::MapLibrary::getUserMapsFolder();
+                        folder.createDirectory();
+                        folder.startAsProcess();
+                    }
+                    else if (result == 190)
+                    {
+                        exportLfoTrace();
+                    }
+                    else if (result == 192)
+                    {
+                        measureMidiLatency();
+                    }
+                    else if (result == 98)
+                    {
+                        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon,
+                                                               "Plugin state (per round trip, 200 runs)",
+                                                               processor.runStateBenchmark(200));
+                    }
+                    else if (result >= 100 && result < 120)
+                    {
+                        processor.setCurrentProgram(result - 100);
+                    }
+                    else if (result >= 120 && result < 140)
+                    {
+                        auto& bank = processor.getPresetBank();
+                        const int slot = result - 120;
+                        const auto* cur = bank.getPreset(slot);
+
+                        bank.store(slot,
+                                   cur != nullptr ? cur->name : "Preset " + juce::String(slot + 1),
+                                   cur != nullptr && cur->resetEngine);
+                    }
+                    else if (result >= 140 && result < 160)
+                    {
+                        auto& bank = processor.getPresetBank();
+                        if (const auto* cur = bank.getPreset(result - 140))
+                            bank.setResetEngine(result - 140, ! cur->resetEngine);
+                    }
+                    else if (result >= 160 && result < 178)
+                    {
+                        if (auto* param = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("presetProgramChannel")))
+                            *param = result - 160;
+                    }
+                    else if (result == 180 || result == 181)
+                    {
+                        processor.getMorphSnapshots().capture(result == 180 ? modztakt::morph::A : modztakt::morph::B);
+                    }
+                    else if (result == 182)
+                    {
+                        if (auto* p = apvts.getParameter("morphEnabled"))
+                        {
+                            p->beginChangeGesture();
+                            p->setValueNotifyingHost(p->getValue() > 0.5f ? 0.0f : 1.0f);
+                            p->endChangeGesture();
+                        }
+                    }
+                    else if (result >= 40 && result < 98)
+                    {
+                        processor.getInstrumentMaps().select(result - 40);
+                        refreshInstrumentMap();
+                    }
                 });
         };
         // Listen to settings parameters
@@ -533,13 +746,34 @@ public:
         // Delay
         addAndMakeVisible (delayEditor);
 
-        // Timer
-        startTimerHz(30); // UI refresh, don't need to be faster
+        // Standalone: re-apply the saved MIDI timing engine choice
+        processor.getMidiTimingEngine().restoreFromSettings();
+
+        // UI refresh: only what changed since the last tick
+        namespace Changed = modztakt::ui::Changed;
+
+        uiRefresh.subscribe (Changed::instrumentMap, [this] (uint32_t) { refreshInstrumentMap(); });
+        uiRefresh.subscribe (Changed::events,        [this] (uint32_t) { drainProcessorEvents(); });
+        uiRefresh.subscribe (Changed::lfoParams,     [this] (uint32_t) { updateRandomShapeState(); });
+        uiRefresh.subscribe (Changed::lfoParams | Changed::clock, [this] (uint32_t) { refreshBpmDisplay(); });
+
+        // Keep LFO / EG / Delay route boxes consistent with each other.
+        uiRefresh.subscribe (Changed::routeParams | Changed::delayParams | Changed::instrumentMap,
+                             [this] (uint32_t) { syncRouteOccupancy(); });
+
+        // Events queued while no editor was open are stale: drop them and let
+        // the processor post its current state again.
+        processor.getUiEvents().drain ([] (const modztakt::ui::Event&) {});
+        processor.getUiCommands().push ({ modztakt::ui::Command::Type::resync });
+        showLfoRunning (processor.isLfoRunningForUi());
+        bpmFromProcessor = processor.getBpmForUi();
+
+        uiRefresh.start();
     }
 
     ~MainComponent() override
     {
-        stopTimer();
+        uiRefresh.stop();
 
         rateSlider.setLookAndFeel (nullptr);
         depthSlider.setLookAndFeel (nullptr);
@@ -666,10 +900,15 @@ public:
 
         lfoAreaContent.removeFromTop(6);
 
-        // Place route selectors
+        // Place route selectors: visibleRoutes rows of the scrolling container
+        const int routeRowPitch = rowHeight + 10;
+
+        routeViewport.setBounds(lfoAreaContent.removeFromTop(visibleRoutes * routeRowPitch));
+        routeRowsContent.setSize(routeViewport.getMaximumVisibleWidth(), maxRoutes * routeRowPitch);
+
         for (int i = 0; i < maxRoutes; ++i)
         {
-            auto rowArea = lfoAreaContent.removeFromTop(rowHeight);
+            auto rowArea = juce::Rectangle<int>(0, i * routeRowPitch, routeRowsContent.getWidth(), rowHeight);
 
             juce::FlexBox fb;
             fb.flexDirection = juce::FlexBox::Direction::row;
@@ -726,7 +965,6 @@ public:
             );
 
             fb.performLayout(rowArea);
-            lfoAreaContent.removeFromTop(10);
         }
 
         placeRow(shapeLabel, shapeBox);
@@ -858,6 +1096,57 @@ public:
         delayEditor.setBounds (delayColumn);
     }
 
+    // Re-read the instrument maps folder; report files that failed to load.
+    void reloadInstrumentMaps()
+    {
+        const auto errors = processor.getInstrumentMaps().rescan();
+        refreshInstrumentMap();
+
+        if (!errors.isEmpty())
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                                   "Instrument maps",
+                                                   errors.joinIntoString("\n"));
+    }
+
+    // Selected instrument map changed (menu, preset load): rebuild the parameter lists.
+    void refreshInstrumentMap()
+    {
+        if (lastInstrumentMapSerial == processor.getInstrumentMaps().getSerial())
+            return;
+
+        lastInstrumentMapSerial = processor.getInstrumentMaps().getSerial();
+
+        const auto& names = processor.getInstrumentMap().getParameterNames();
+
+        for (int i = 0; i < maxRoutes; ++i)
+        {
+            // Re-attach so the box picks the parameter's index up again.
+            routeParamAttach[i].reset();
+            routeParameterBoxes[i].clear(juce::dontSendNotification);
+            routeParameterBoxes[i].addItemList(names, 1);
+            routeParamAttach[i] = std::make_unique<ChoiceAttachment>(
+                apvts, "route" + juce::String(i) + "_param", routeParameterBoxes[i]);
+
+            lastValidRouteParamId[i] = routeParameterBoxes[i].getSelectedId();
+        }
+
+        // Claims move with the map's roles and EG destinations
+        routeOccupancy.sync(processor.getInstrumentMap());
+
+        refreshRouteParamAvailability();
+        envelopeEditor.refreshInstrumentMap();
+        delayEditor.refreshRouteAvailability();
+    }
+
+    // MIDI output ports: device per port + route → port matrix
+    void showPortsEditor()
+    {
+        juce::CallOutBox::launchAsynchronously (
+            std::make_unique<MidiPortsEditorComponent> (apvts, processor.getOutputPorts()),
+            settingsButton.getBounds(),
+            this);
+    }
+
     // Oscilloscope pop-up view (not modal)
     void toggleScope()
     {
@@ -867,12 +1156,12 @@ public:
             return;
         }
 
-        auto& scopeValues = processor.getScopeValues();
+        auto& scopeStreams = processor.getScopeStreams();
         auto& scopeRoutes = processor.getScopeRoutesEnabled();
 
         scopeRoutes[0].store(true, std::memory_order_relaxed); // route 1 active by default
 
-        scopeOverlay.reset(new ScopeModalComponent<maxRoutes>(scopeValues, scopeRoutes));
+        scopeOverlay.reset(new ScopeModalComponent<numScopeRoutes>(scopeStreams, scopeRoutes));
 
 
         scopeOverlay->onAllRoutesDisabled = [this]()
@@ -919,12 +1208,21 @@ private:
     ModzTaktAudioProcessor& processor;
     ModzTaktAudioProcessor::APVTS& apvts;
 
+    // Single UI refresh timer, shared with the child editors (see UiRefresh.h)
+    modztakt::ui::RefreshScheduler uiRefresh;
+
+    // (channel, parameter) → routes driving it, shared with the child editors
+    // (see RouteOccupancy.h); synced here on the message thread only.
+    modztakt::routing::Occupancy routeOccupancy;
+
     EnvelopeEditorComponent envelopeEditor;
 
     DelayEditorComponent delayEditor;
 
 
-    static constexpr int maxRoutes = 3;
+    static constexpr int maxRoutes      = modztakt::lfo::maxRoutes;   // LFO routes
+    static constexpr int visibleRoutes  = 3;                           // route rows shown, the rest scroll
+    static constexpr int numScopeRoutes = maxRoutes;                   // scope traces: one per LFO route
 
     juce::GroupComponent lfoGroup;
 
@@ -954,6 +1252,10 @@ private:
 
     std::unique_ptr<LedToggleButton> routeBipolarToggles[maxRoutes], routeInvertToggles[maxRoutes], routeOneShotToggles[maxRoutes];
 
+    // Route rows are children of routeRowsContent, scrolled by routeViewport
+    juce::Component routeRowsContent;
+    juce::Viewport  routeViewport;
+
     #if JUCE_DEBUG
     // EG test: to scope Route 0.
     juce::ToggleButton showEGinScopeToggle{ "EG to Scope" };
@@ -967,7 +1269,10 @@ private:
     // Oscilloscope
     juce::Image scopeIcon;
     juce::ImageButton scopeButton;
-    std::unique_ptr<ScopeModalComponent<maxRoutes>> scopeOverlay;
+    std::unique_ptr<ScopeModalComponent<numScopeRoutes>> scopeOverlay;
+
+    // Settings → Measure MIDI latency (created on first use)
+    std::unique_ptr<modztakt::standalone::LatencyProbe> latencyProbe;
 
     std::atomic<bool> pendingSyncModeChange { false };
 
@@ -988,12 +1293,12 @@ private:
     std::unique_ptr<ChoiceAttachment> syncDivisionAttach;
 
     // LFO Routes UI
-    std::array<std::unique_ptr<ChoiceAttachment>, 3> routeChannelAttach;
-    std::array<std::unique_ptr<ChoiceAttachment>, 3> routeParamAttach;
+    std::array<std::unique_ptr<ChoiceAttachment>, maxRoutes> routeChannelAttach;
+    std::array<std::unique_ptr<ChoiceAttachment>, maxRoutes> routeParamAttach;
 
-    std::array<std::unique_ptr<ButtonAttachment>, 3> routeBipolarAttach;
-    std::array<std::unique_ptr<ButtonAttachment>, 3> routeInvertAttach;
-    std::array<std::unique_ptr<ButtonAttachment>, 3> routeOneShotAttach;
+    std::array<std::unique_ptr<ButtonAttachment>, maxRoutes> routeBipolarAttach;
+    std::array<std::unique_ptr<ButtonAttachment>, maxRoutes> routeInvertAttach;
+    std::array<std::unique_ptr<ButtonAttachment>, maxRoutes> routeOneShotAttach;
 
     // Scope
     std::unique_ptr<ButtonAttachment> scopeButtonAttach;
@@ -1006,6 +1311,7 @@ private:
     // BPM smoothing / throttling
     double displayedBpm = 0.0;
     juce::int64 lastBpmUpdateMs = 0;
+    double bpmFromProcessor = 0.0;   // last tempo event
 
     // settings - Dithering and MIDI throttle
     int changeThreshold = 1; // difference needed before sending
@@ -1039,49 +1345,97 @@ private:
         }
     }
 
-    void timerCallback() override
+    // LFO run-state trace → Chrome trace JSON in the traces folder (see LfoTrace.h)
+    void exportLfoTrace()
     {
-        // UI update
-        const bool lfoRunning = processor.isLfoRunningForUi();
+        const auto file = modztakt::trace::Recorder::getTraceFolder()
+                              .getChildFile ("lfo-trace-" + juce::Time::getCurrentTime().formatted ("%Y%m%d-%H%M%S") + ".json");
 
-        const juce::String lfoStartStopText = lfoRunning ? "Stop LFO" : "Start LFO";
-        if (startButton.getButtonText() != lfoStartStopText)
-            startButton.setButtonText(lfoStartStopText);
+        if (auto r = processor.getLfoTrace().exportChromeTrace (file); r.failed())
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "LFO trace", r.getErrorMessage());
+        else
+            file.revealToUser();
+    }
 
-        if (processor.uiRequestSetLfoActiveOn.exchange(false, std::memory_order_acq_rel))
+    // Standalone on Linux: round trip through ALSA virtual ports (see LatencyProbe.h)
+    void measureMidiLatency()
+    {
+        if (latencyProbe == nullptr)
+            latencyProbe = std::make_unique<modztakt::standalone::LatencyProbe>(processor);
+
+        const auto r = latencyProbe->start([] (const juce::String& report)
         {
-            if (auto* p = apvts.getParameter("lfoActive"))
-            {
-                p->beginChangeGesture();
-                p->setValueNotifyingHost(1.0f);  // turn ON
-                p->endChangeGesture();
-            }
-        }
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon, "MIDI latency (ms)", report);
+        });
+
+        if (r.failed())
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "MIDI latency", r.getErrorMessage());
+    }
+
+    // Events posted by the audio thread (see UiEventQueue.h), oldest first
+    void drainProcessorEvents()
+    {
+        using Type = modztakt::ui::Event::Type;
 
-        if (processor.uiRequestSetLfoActiveOff.exchange(false, std::memory_order_acq_rel))
+        const auto drained = processor.getUiEvents().drain ([this] (const modztakt::ui::Event& e)
         {
-            if (auto* p = apvts.getParameter("lfoActive"))
+            switch (e.type)
             {
-                p->beginChangeGesture();
-                p->setValueNotifyingHost(0.0f);
-                p->endChangeGesture();
-            }
-        }
+                case Type::lfoRunning:
+                    showLfoRunning (e.flag);
+                    break;
 
-        if (processor.uiRequestSetRateHz.exchange(false, std::memory_order_acq_rel))
-        {
-            const float hz = processor.uiRateHzToSet.load(std::memory_order_relaxed);
+                case Type::setLfoActive:
+                    if (auto* p = apvts.getParameter("lfoActive"))
+                    {
+                        p->beginChangeGesture();
+                        p->setValueNotifyingHost(e.flag ? 1.0f : 0.0f);
+                        p->endChangeGesture();
+                    }
+                    break;
 
-            if (auto* p = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("lfoRateHz")))
-            {
-                p->beginChangeGesture();
-                p->setValueNotifyingHost(p->convertTo0to1(hz));
-                p->endChangeGesture();
+                case Type::setLfoRate:
+                    if (auto* p = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("lfoRateHz")))
+                    {
+                        p->beginChangeGesture();
+                        p->setValueNotifyingHost(p->convertTo0to1((float) e.value));
+                        p->endChangeGesture();
+                    }
+                    break;
+
+                case Type::tempo:
+                    bpmFromProcessor = e.value;
+                    uiRefresh.markChanged(modztakt::ui::Changed::clock);
+                    break;
+
+                case Type::oneShotFinished:
+                case Type::transportStart:
+                case Type::transportStop:
+                    break;  // nothing shown for these yet
             }
+        });
+
+        // Events dropped while the queue was full: catch up from the current state.
+        if (drained.lost > 0)
+        {
+            showLfoRunning (processor.isLfoRunningForUi());
+            bpmFromProcessor = processor.getBpmForUi();
+            uiRefresh.markChanged(modztakt::ui::Changed::clock);
         }
+    }
+
+    void showLfoRunning (bool lfoRunning)
+    {
+        const juce::String lfoStartStopText = lfoRunning ? "Stop LFO" : "Start LFO";
+        if (startButton.getButtonText() != lfoStartStopText)
+            startButton.setButtonText(lfoStartStopText);
+    }
 
-        const int shapeId = shapeBox.getSelectedId();
-        const bool isRandom = (shapeId == 5);
+    // Random shape: bipolar / invert / one-shot don't apply
+    void updateRandomShapeState()
+    {
+        // Parameter, not shapeBox: the box may not have caught up with automation yet.
+        const bool isRandom = ((int) apvts.getRawParameterValue("lfoShape")->load() == 4);
 
         if (isRandom != lastWasRandomShape)
         {
@@ -1121,51 +1475,49 @@ private:
                 }
             }
         }
+    }
 
-        // Display bpm
+    void refreshBpmDisplay()
+    {
         const int syncModeIndex = (int) processor.getAPVTS().getRawParameterValue("syncMode")->load(); // 0 or 1
         const bool syncEnabled = (syncModeIndex == 1);
 
-        // Always update BPM display if sync mode is active
-        if (syncEnabled)
+        if (!syncEnabled)
         {
-            const double bpm = processor.getBpmForUi();
-            const auto nowMs = juce::Time::getMillisecondCounterHiRes();
-
-            if (bpm > 0.0)
-            {
-                // Smooth & rate-limit UI updates
-                displayedBpm = 0.9 * displayedBpm + 0.1 * bpm;
-                if (nowMs - lastBpmUpdateMs > 250.0)
-                {
-                    bpmLabel.setText(juce::String(displayedBpm, 1), juce::dontSendNotification);
-                    lastBpmUpdateMs = nowMs;
-                }
-            }
-            else
-            {
-                // No clock yet: show placeholder
-                if (nowMs - lastBpmUpdateMs > 500.0)
-                {
-                    bpmLabel.setText("--", juce::dontSendNotification);
-                    lastBpmUpdateMs = nowMs;
-                }
-            }
+            bpmLabel.setText("--", juce::dontSendNotification);
+            return;
         }
-        else
+
+        const double bpm = bpmFromProcessor;
+
+        if (bpm <= 0.0)
         {
+            // No clock yet: show placeholder
             bpmLabel.setText("--", juce::dontSendNotification);
+            return;
         }
 
-        // Keep LFO param boxes consistent with changes made in EG or Delay routes.
-        refreshRouteParamAvailability();
+        // Smooth & rate-limit UI updates
+        const auto nowMs = juce::Time::getMillisecondCounterHiRes();
+        displayedBpm = 0.9 * displayedBpm + 0.1 * bpm;
+
+        if (nowMs - lastBpmUpdateMs > 250.0)
+        {
+            bpmLabel.setText(juce::String(displayedBpm, 1), juce::dontSendNotification);
+            lastBpmUpdateMs = (juce::int64) nowMs;
+        }
+
+        // Still settling (or rate-limited): come back on the next tick.
+        if (std::abs(displayedBpm - bpm) > 0.05 || bpmLabel.getText() != juce::String(displayedBpm, 1))
+            uiRefresh.markChanged(modztakt::ui::Changed::clock);
     }
 
     // --- Route exclusivity UI (channel + parameter must be unique per channel) ---
-    std::array<int, maxRoutes> lastValidRouteParamId { 1, 1, 1 };  // ComboBox IDs (p+1)
-    std::array<int, maxRoutes> lastValidRouteChanId  { 1, 1, 1 };  // ComboBox IDs (1=Disabled, 2..17=Ch)
+    std::array<int, maxRoutes> lastValidRouteParamId {};  // ComboBox IDs (p+1), set in the constructor
+    std::array<int, maxRoutes> lastValidRouteChanId  {};  // ComboBox IDs (1=Disabled, 2..17=Ch)
 
     bool updatingRouteCombos = false;
+    int  lastInstrumentMapSerial = 0;   // MapLibrary serial the menus were built from
 
     int getRouteChannelNumber(int routeIndex) const
     {
@@ -1183,96 +1535,27 @@ private:
 
     bool isParamTakenOnChannel(int channel, int paramIdx, int exceptRoute) const
     {
-        if (channel <= 0 || paramIdx < 0) return false;
-
-        // Check other LFO routes (existing logic).
-        for (int r = 0; r < maxRoutes; ++r)
-        {
-            if (r == exceptRoute) continue;
-
-            if (getRouteChannelNumber(r) == channel && getRouteParamIndex(r) == paramIdx)
-                return true;
-        }
-
-        // Check EG routes: "egRoute{r}_channel" = 0..16,
-        // "egRoute{r}_dest" = 0-based index into the egDestination=true filtered list.
-        // processor.SyntaktParameterEgIndex maps that to the global syntaktParameters[] index.
-        for (int r = 0; r < maxRoutes; ++r)
-        {
-            const int egCh = (int) apvts.getRawParameterValue (
-                "egRoute" + juce::String (r) + "_channel")->load();
-            if (egCh != channel) continue;
-
-            const int egDest = (int) apvts.getRawParameterValue (
-                "egRoute" + juce::String (r) + "_dest")->load();
-
-            const auto& egIdx = processor.SyntaktParameterEgIndex;
-            if (egDest >= 0 && egDest < egIdx.size() && egIdx[egDest] == paramIdx)
-                return true;
-        }
-
-        return false;
+        // Other LFO routes and EG routes (delay claims: isParamClaimedByDelayEg)
+        namespace Owner = modztakt::routing::Owner;
+        return routeOccupancy.isClaimed(channel, paramIdx, (Owner::anyLfo | Owner::anyEg) & ~Owner::lfo(exceptRoute));
     }
 
-    // Returns the global syntaktParameters[] index for a parameter by name.
-    static int findGlobalParamByName (const char* name) noexcept
+    // Occupancy changed since the last sync: refresh every route box that depends on it.
+    void syncRouteOccupancy()
     {
-        for (int i = 0; i < juce::numElementsInArray (syntaktParameters); ++i)
-            if (juce::String (syntaktParameters[i].name) == name)
-                return i;
-        return -1;
+        if (!routeOccupancy.sync(processor.getInstrumentMap()))
+            return;
+
+        refreshRouteParamAvailability();
+        envelopeEditor.refreshRouteAvailability();
+        delayEditor.refreshRouteAvailability();
     }
 
     // Returns true when the Delay EG shaping feature has claimed (channel, globalParamIdx) —
-    // i.e. the delay engine is sending Amp:Volume or Track Level on that channel.
+    // i.e. the delay engine is sending Amp:Volume, Track Level or Pan on that channel.
     bool isParamClaimedByDelayEg (int channel, int globalParamIdx) const
     {
-        if (channel <= 0 || globalParamIdx < 0)
-            return false;
-
-        const int delayEgShape =
-            (int) apvts.getRawParameterValue ("delayEgShape")->load();
-
-        if (delayEgShape == 0)
-            return false;
-
-        const int delayTargetParam =
-            (delayEgShape == 1)
-                ? findGlobalParamByName ("Amp: Volume")
-                : findGlobalParamByName ("Track Level");
-
-        if (globalParamIdx != delayTargetParam)
-            return false;
-
-        for (int dr = 0; dr < maxRoutes; ++dr)
-        {
-            const int dCh = (int) apvts.getRawParameterValue (
-                "delayRoute" + juce::String (dr) + "_channel")->load();
-            if (dCh == channel)
-                return true;
-        }
-
-        // Delay auto-pan claims "Amp: Pan" on every active delay route channel.
-        const bool delayPanEnabled =
-            apvts.getRawParameterValue ("delayPanEnabled")->load() > 0.5f;
-
-        if (delayPanEnabled)
-        {
-            const int panGlobalIdx = findGlobalParamByName ("Amp: Pan");
-            if (globalParamIdx == panGlobalIdx)
-            {
-                for (int dr = 0; dr < modztakt::delay::maxDelayRoutes; ++dr)
-                {
-                    const int dCh = (int) apvts.getRawParameterValue (
-                        "delayRoute" + juce::String (dr) + "_channel")->load();
-                    if (dCh == channel)
-                        return true;
-                }
-            }
-        }
-
-        return false;
-        return false;
+        return routeOccupancy.isClaimed (channel, globalParamIdx, modztakt::routing::Owner::anyDelay);
     }
 
     // Disable items that are already used by other routes on same MIDI channel.
@@ -1282,7 +1565,7 @@ private:
         if (updatingRouteCombos) return;
         updatingRouteCombos = true;
 
-        const int numParams = juce::numElementsInArray(syntaktParameters);
+        const int numParams = processor.getInstrumentMap().size();
 
         for (int i = 0; i < maxRoutes; ++i)
         {
@@ -1319,6 +1602,10 @@ private:
     void enforceRouteExclusivity(int routeIndex)
     {
         if (updatingRouteCombos) return;
+
+        // Check against the other routes as they are now (earlier corrections included)
+        syncRouteOccupancy();
+
         updatingRouteCombos = true;
 
         const int ch = getRouteChannelNumber(routeIndex);
@@ -1351,7 +1638,7 @@ private:
             else
             {
                 // Find first available param
-                const int numParams = juce::numElementsInArray(syntaktParameters);
+                const int numParams = processor.getInstrumentMap().size();
                 int foundParamId = 0;
 
                 for (int p = 0; p < numParams; ++p)
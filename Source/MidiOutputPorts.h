@@ -0,0 +1,667 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+
+#include "MidiPortBuffers.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Multiple MIDI output ports
+//
+// Port 0 is the main output (the host's MIDI out, or the standalone default
+// output). Ports 1..3 are extra MidiOutput devices opened by the plugin
+// itself, so each route can drive a different physical MIDI link.
+//
+// Every port has its own preallocated buffer for the block; generated events
+// are written into the port the route is assigned to, and endBlock() queues
+// each extra buffer for the port sender thread, which hands it to the device
+// (sendBlockOfMessages, one block ahead so in-block offsets are kept).  A
+// port without a device falls back to the main output, so assignments never
+// silently swallow events.
+//
+// Optional per-port bandwidth accounting models a 5-pin DIN link
+// (31 250 baud): once the estimated wire backlog exceeds maxBacklogMs,
+// controller traffic on that port is dropped (notes always pass), so one
+// busy link can no longer delay the notes of another route or port.
+//
+// An extra port can also be opened as a MIDI 2.0 (UMP) endpoint.  The
+// processor then adds high-resolution packets (32-bit controllers, per-note
+// controllers) with addUmp() next to the regular MIDI 1.0 events; endBlock()
+// merges both in sample order and the sender thread sends them in one go.
+// ump::Output has no timestamped send, so in-block offsets collapse to the
+// block boundary — use the standalone MIDI timing engine for sub-millisecond
+// spacing.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::ports
+{
+    // Choice list shared by every "*_port" APVTS parameter.
+    inline juce::StringArray makePortChoices()
+    {
+        return { "Main", "Port 2", "Port 3", "Port 4" };
+    }
+
+    // ─────────────────────────────────────────────────────────────────────────
+    // DIN bandwidth gate
+    //
+    // Tracks when the wire becomes free (in the processor's ms timeline).
+    // Each forwarded message advances it by numBytes × 0.32 ms.  Controller
+    // messages sharing a channel and sample offset (NRPN 99/98/6/38 groups,
+    // primer CCs) are kept or dropped as a whole.
+    // ─────────────────────────────────────────────────────────────────────────
+    class BandwidthGate
+    {
+    public:
+        static constexpr double msPerByte    = 0.32;  // 10 bits per byte at 31 250 baud
+        static constexpr double maxBacklogMs = 10.0;
+
+        void reset() noexcept
+        {
+            wireFreeAtMs = 0.0;
+        }
+
+        // Copies `in` to `out`, skipping controllers while backlogged.
+        // Returns the number of dropped messages.
+        int process (const juce::MidiBuffer& in, juce::MidiBuffer& out,
+                     double blockStartMs, double msPerSample) noexcept
+        {
+            int dropped = 0;
+
+            int  groupChannel = -1;
+            int  groupOffset  = -1;
+            bool groupDropped = false;
+
+            for (const auto meta : in)
+            {
+                const double t = blockStartMs + (double) meta.samplePosition * msPerSample;
+
+                const bool isController = meta.numBytes == 3 && (meta.data[0] & 0xF0) == 0xB0;
+
+                if (isController)
+                {
+                    const int ch = meta.data[0] & 0x0F;
+
+                    if (ch != groupChannel || meta.samplePosition != groupOffset)
+                    {
+                        groupChannel = ch;
+                        groupOffset  = meta.samplePosition;
+                        groupDropped = (wireFreeAtMs - t) > maxBacklogMs;
+                    }
+
+                    if (groupDropped)
+                    {
+                        ++dropped;
+                        continue;
+                    }
+                }
+                else
+                {
+                    groupChannel = -1;
+                }
+
+                wireFreeAtMs = juce::jmax (wireFreeAtMs, t) + (double) meta.numBytes * msPerByte;
+                out.addEvent (meta.data, meta.numBytes, meta.samplePosition);
+            }
+
+            return dropped;
+        }
+
+        double getBacklogMs (double nowMs) const noexcept
+        {
+            return juce::jmax (0.0, wireFreeAtMs - nowMs);
+        }
+
+    private:
+        double wireFreeAtMs = 0.0;
+    };
+
+    // ─────────────────────────────────────────────────────────────────────────
+    // Extra-port events on their way from the audio thread to the sender
+    //
+    // A preallocated single-producer / single-consumer ring of fixed-size
+    // records: endBlock() pushes, the sender thread drains.  Generated events
+    // are at most 3 bytes (notes, controllers, NRPN parts); UMP records carry
+    // one or two words.  A block that doesn't fit as a whole is dropped and
+    // counted, which only happens if the sender stalls for seconds.
+    // ─────────────────────────────────────────────────────────────────────────
+    struct QueuedEvent
+    {
+        double                  timeMs   = 0.0;   // Time::getMillisecondCounterHiRes() timeline
+        uint8_t                 port     = 0;
+        uint8_t                 numBytes = 0;     // MIDI 1.0 message, 0 for a UMP packet
+        std::array<uint8_t, 3>  bytes {};
+        std::array<uint32_t, 2> words {};
+    };
+
+    class EventRing
+    {
+    public:
+        static constexpr int capacity = 4096;   // power of two
+
+        // ── Audio thread ──────────────────────────────────────────────────────
+        int getFreeSpace() const noexcept
+        {
+            return capacity - (int) (writePos.load (std::memory_order_relaxed) - readPos.load (std::memory_order_acquire));
+        }
+
+        // Call getFreeSpace() first: push() doesn't check.
+        void push (const QueuedEvent& e) noexcept
+        {
+            const auto w = writePos.load (std::memory_order_relaxed);
+            ring[w & (capacity - 1)] = e;
+            writePos.store (w + 1, std::memory_order_release);
+        }
+
+        // ── Sender thread ─────────────────────────────────────────────────────
+        template <typename Fn>
+        int drain (Fn&& fn)
+        {
+            const auto w = writePos.load (std::memory_order_acquire);
+            auto r = readPos.load (std::memory_order_relaxed);
+
+            int n = 0;
+            for (; r != w; ++r, ++n)
+                fn (ring[r & (capacity - 1)]);
+
+            readPos.store (r, std::memory_order_release);
+            return n;
+        }
+
+    private:
+        static_assert ((capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+
+        std::array<QueuedEvent, capacity> ring {};
+        std::atomic<uint32_t> writePos { 0 }, readPos { 0 };
+    };
+
+    // ─────────────────────────────────────────────────────────────────────────
+    // OutputPorts — owned by the processor.
+    //
+    // Audio thread: prepare(), beginBlock(), isUmpPort(), addUmp(), endBlock().
+    // Message thread: device assignment, DIN / UMP flags, state load/save.
+    // Sender thread (started with the first extra device): drains the event
+    // ring every millisecond and sends to the devices.  Devices are swapped
+    // under a lock only the message and sender threads take; the audio thread
+    // never locks, allocates or calls into a device.
+    // ─────────────────────────────────────────────────────────────────────────
+    class OutputPorts : private juce::AsyncUpdater,
+                        private juce::Thread
+    {
+    public:
+        OutputPorts() : juce::Thread ("ModzTakt MIDI ports")
+        {
+            for (auto& b : sendBuffers)
+                b.ensureSize (4096);
+
+            for (auto& packets : sendPackets)
+                packets.reserve (2 * EventRing::capacity);
+        }
+
+        ~OutputPorts() override
+        {
+            cancelPendingUpdate();
+            stopThread (1000);
+
+            for (int p = 1; p < maxPorts; ++p)
+                openDevice (p, {});
+        }
+
+        // ── Audio thread ──────────────────────────────────────────────────────
+        void prepare (double sampleRate)
+        {
+            msPerSample = 1000.0 / juce::jmax (1.0, sampleRate);
+
+            for (auto& b : portBuffers)
+                b.ensureSize (4096);
+
+            gatedBuffer.ensureSize (4096);
+
+            for (auto& g : gates)
+                g.reset();
+        }
+
+        PortBuffers beginBlock (juce::MidiBuffer& mainOut) noexcept
+        {
+            PortBuffers out;
+            out.buffers[0] = &mainOut;
+
+            for (int p = 1; p < maxPorts; ++p)
+            {
+                const bool open = portOpen[(std::size_t) p].load (std::memory_order_acquire);
+                auto& buf = portBuffers[(std::size_t) p];
+                buf.clear();
+
+                out.buffers[(std::size_t) p] = open ? &buf : &mainOut;
+                routedThisBlock[(std::size_t) p] = open;
+                umpThisBlock[(std::size_t) p]    = open && portIsUmp[(std::size_t) p].load (std::memory_order_acquire);
+                numUmpEvents[(std::size_t) p]    = 0;
+            }
+
+            return out;
+        }
+
+        // True when `port` is an open MIDI 2.0 endpoint for this block.
+        bool isUmpPort (int port) const noexcept
+        {
+            return isValidExtraPort (port) && umpThisBlock[(std::size_t) port];
+        }
+
+        // Queue one high-resolution packet (kept sorted by sample offset).
+        void addUmp (int port, int sampleOffset, const juce::ump::PacketX2& packet) noexcept
+        {
+            if (! isUmpPort (port))
+                return;
+
+            const auto idx = (std::size_t) port;
+            auto& events = umpEvents[idx];
+            int&  n      = numUmpEvents[idx];
+
+            if (n >= maxUmpEventsPerBlock)
+            {
+                dropped[idx].fetch_add (1, std::memory_order_relaxed);
+                return;
+            }
+
+            int i = n++;
+            while (i > 0 && events[(std::size_t) i - 1].sampleOffset > sampleOffset)
+            {
+                events[(std::size_t) i] = events[(std::size_t) i - 1];
+                --i;
+            }
+            events[(std::size_t) i] = { sampleOffset, packet };
+        }
+
+        // Applies the DIN gates and queues the extra ports for the sender thread.
+        void endBlock (juce::MidiBuffer& mainOut, double blockStartMs, int numSamples) noexcept
+        {
+            const double blockEndMs = blockStartMs + (double) numSamples * msPerSample;
+
+            if (dinLimited[0].load (std::memory_order_relaxed))
+            {
+                gatedBuffer.clear();
+                dropped[0].fetch_add (gates[0].process (mainOut, gatedBuffer, blockStartMs, msPerSample),
+                                      std::memory_order_relaxed);
+                mainOut.swapWith (gatedBuffer);
+            }
+            backlogMs[0].store ((float) gates[0].getBacklogMs (blockEndMs), std::memory_order_relaxed);
+
+            // One block of constant latency, like the host path.
+            const double sendAtMs = juce::Time::getMillisecondCounterHiRes()
+                                  + (double) numSamples * msPerSample;
+
+            for (int p = 1; p < maxPorts; ++p)
+            {
+                const auto idx = (std::size_t) p;
+
+                if (umpThisBlock[idx])
+                {
+                    queueUmpBlock (p, sendAtMs);
+                    continue;
+                }
+
+                if (! routedThisBlock[idx])
+                    continue;
+
+                const juce::MidiBuffer* toSend = &portBuffers[idx];
+
+                if (dinLimited[idx].load (std::memory_order_relaxed))
+                {
+                    gatedBuffer.clear();
+                    dropped[idx].fetch_add (gates[idx].process (portBuffers[idx], gatedBuffer,
+                                                                blockStartMs, msPerSample),
+                                            std::memory_order_relaxed);
+                    toSend = &gatedBuffer;
+                }
+                backlogMs[idx].store ((float) gates[idx].getBacklogMs (blockEndMs), std::memory_order_relaxed);
+
+                queueBlock (p, *toSend, sendAtMs);
+            }
+        }
+
+        // ── Any thread ────────────────────────────────────────────────────────
+        bool isPortOpen (int port) const noexcept
+        {
+            return port == 0 || (isValidExtraPort (port) && portOpen[(std::size_t) port].load (std::memory_order_acquire));
+        }
+
+        bool isPortUmp (int port) const noexcept
+        {
+            return isValidExtraPort (port) && umpMode[(std::size_t) port].load (std::memory_order_relaxed);
+        }
+
+        bool isDinLimited (int port) const noexcept
+        {
+            return isValidPort (port) && dinLimited[(std::size_t) port].load (std::memory_order_relaxed);
+        }
+
+        int   getDroppedCount (int port) const noexcept { return isValidPort (port) ? dropped[(std::size_t) port].load (std::memory_order_relaxed) : 0; }
+        float getBacklogMs (int port) const noexcept    { return isValidPort (port) ? backlogMs[(std::size_t) port].load (std::memory_order_relaxed) : 0.0f; }
+
+        // ── Message thread ────────────────────────────────────────────────────
+        // Empty identifier closes the port.  Returns false if the device
+        // could not be opened (the identifier is kept so the choice persists).
+        bool setPortDevice (int port, const juce::String& identifier)
+        {
+            if (! isValidExtraPort (port))
+                return false;
+
+            deviceIds[(std::size_t) port] = identifier;
+            return openDevice (port, identifier);
+        }
+
+        juce::String getPortDevice (int port) const
+        {
+            return isValidExtraPort (port) ? deviceIds[(std::size_t) port] : juce::String();
+        }
+
+        void setDinLimited (int port, bool shouldLimit) noexcept
+        {
+            if (isValidPort (port))
+                dinLimited[(std::size_t) port].store (shouldLimit, std::memory_order_relaxed);
+        }
+
+        // MIDI 2.0 output: reopens the port's device as a UMP endpoint.
+        bool setPortUmp (int port, bool shouldUseUmp)
+        {
+            if (! isValidExtraPort (port))
+                return false;
+
+            umpMode[(std::size_t) port].store (shouldUseUmp, std::memory_order_relaxed);
+            return openDevice (port, deviceIds[(std::size_t) port]);
+        }
+
+        // Persisted as a "MidiPorts" child of the APVTS state.
+        void saveToState (juce::ValueTree& state) const
+        {
+            auto node = state.getOrCreateChildWithName (stateId, nullptr);
+
+            for (int p = 0; p < maxPorts; ++p)
+            {
+                const auto ps = juce::String (p);
+                node.setProperty ("din" + ps, isDinLimited (p), nullptr);
+
+                if (p > 0)
+                {
+                    node.setProperty ("device" + ps, deviceIds[(std::size_t) p], nullptr);
+                    node.setProperty ("ump" + ps, isPortUmp (p), nullptr);
+                }
+            }
+        }
+
+        // Devices are (re)opened asynchronously on the message thread.
+        void loadFromState (const juce::ValueTree& state)
+        {
+            const auto node = state.getChildWithName (stateId);
+
+            for (int p = 0; p < maxPorts; ++p)
+            {
+                const auto ps = juce::String (p);
+                setDinLimited (p, node.isValid() && (bool) node.getProperty ("din" + ps, false));
+
+                if (p > 0)
+                {
+                    deviceIds[(std::size_t) p] = node.isValid() ? node.getProperty ("device" + ps).toString()
+                                                                : juce::String();
+                    umpMode[(std::size_t) p].store (node.isValid() && (bool) node.getProperty ("ump" + ps, false),
+                                                    std::memory_order_relaxed);
+                }
+            }
+
+            triggerAsyncUpdate();
+        }
+
+    private:
+        static bool isValidPort (int port) noexcept      { return port >= 0 && port < maxPorts; }
+        static bool isValidExtraPort (int port) noexcept { return port >= 1 && port < maxPorts; }
+
+        void handleAsyncUpdate() override
+        {
+            for (int p = 1; p < maxPorts; ++p)
+            {
+                const auto idx = (std::size_t) p;
+                if (deviceIds[idx] != openIds[idx] || umpMode[idx].load() != portIsUmp[idx].load())
+                    openDevice (p, deviceIds[idx]);
+            }
+        }
+
+        bool openDevice (int port, const juce::String& identifier)
+        {
+            const auto idx = (std::size_t) port;
+            const bool wantUmp = umpMode[idx].load (std::memory_order_relaxed) && identifier.isNotEmpty();
+
+            std::unique_ptr<juce::MidiOutput>  device;
+            std::unique_ptr<juce::ump::Output> umpDevice;
+
+            if (wantUmp)
+            {
+                // MidiOutput identifiers are valid UMP destination ids.
+                if (! umpSession.has_value())
+                    if (auto* endpoints = juce::ump::Endpoints::getInstance())
+                        umpSession = endpoints->makeSession ("ModzTakt");
+
+                if (umpSession.has_value())
+                {
+                    umpDevice = std::make_unique<juce::ump::Output> (umpSession->connectOutput (
+                        juce::ump::EndpointId::make (juce::ump::IOKind::dst, identifier)));
+
+                    if (! umpDevice->isAlive())
+                        umpDevice.reset();
+                }
+            }
+            else if (identifier.isNotEmpty())
+            {
+                device = juce::MidiOutput::openDevice (identifier);
+
+                if (device != nullptr)
+                    device->startBackgroundThread();
+            }
+
+            const bool ok = identifier.isEmpty() || device != nullptr || umpDevice != nullptr;
+
+            if ((device != nullptr || umpDevice != nullptr) && ! isThreadRunning())
+                startThread (juce::Thread::Priority::high);
+
+            {
+                const juce::ScopedLock sl (deviceLock);
+                std::swap (outputs[idx], device);
+                std::swap (umpOutputs[idx], umpDevice);
+                portIsUmp[idx].store (umpOutputs[idx] != nullptr, std::memory_order_release);
+                portOpen[idx].store (outputs[idx] != nullptr || umpOutputs[idx] != nullptr,
+                                     std::memory_order_release);
+            }
+
+            // `device` / `umpDevice` now hold the previous outputs, closed outside the lock.
+            if (device != nullptr)
+                device->stopBackgroundThread();
+
+            umpDevice.reset();
+
+            openIds[idx] = identifier;
+            gates[idx].reset();
+            return ok;
+        }
+
+        // ── Audio thread: into the event ring ────────────────────────────────
+        void queueBlock (int port, const juce::MidiBuffer& buffer, double sendAtMs) noexcept
+        {
+            const int n = buffer.getNumEvents();
+
+            if (n == 0)
+                return;
+
+            if (n > queued.getFreeSpace())
+            {
+                dropped[(std::size_t) port].fetch_add (n, std::memory_order_relaxed);
+                return;
+            }
+
+            for (const auto meta : buffer)
+            {
+                if (meta.numBytes > 3)
+                {
+                    dropped[(std::size_t) port].fetch_add (1, std::memory_order_relaxed);
+                    continue;
+                }
+
+                QueuedEvent e;
+                e.timeMs   = sendAtMs + (double) meta.samplePosition * msPerSample;
+                e.port     = (uint8_t) port;
+                e.numBytes = (uint8_t) meta.numBytes;
+                std::copy (meta.data, meta.data + meta.numBytes, e.bytes.begin());
+                queued.push (e);
+            }
+        }
+
+        // MIDI 1.0 events are wrapped as MIDI 1.0 UMPs and merged with the
+        // high-resolution packets.  At equal offsets the packets go first
+        // (primers before note-ons).
+        void queueUmpBlock (int port, double sendAtMs) noexcept
+        {
+            const auto idx = (std::size_t) port;
+            const auto& packets = umpEvents[idx];
+            const int   n       = numUmpEvents[idx];
+            int         e       = 0;
+
+            // MIDI 1.0 events of up to 3 bytes become one packet each
+            if (n + portBuffers[idx].getNumEvents() > queued.getFreeSpace())
+            {
+                dropped[idx].fetch_add (n + portBuffers[idx].getNumEvents(), std::memory_order_relaxed);
+                return;
+            }
+
+            const auto queue = [&] (const juce::ump::View& v)
+            {
+                if (v.size() > 2)
+                    return;
+
+                QueuedEvent q;
+                q.timeMs = sendAtMs;
+                q.port   = (uint8_t) port;
+                std::copy (v.begin(), v.end(), q.words.begin());
+                queued.push (q);
+            };
+
+            for (const auto meta : portBuffers[idx])
+            {
+                while (e < n && packets[(std::size_t) e].sampleOffset <= meta.samplePosition)
+                    queue (juce::ump::View (packets[(std::size_t) e++].packet.data()));
+
+                if (meta.numBytes > 3)
+                {
+                    dropped[idx].fetch_add (1, std::memory_order_relaxed);
+                    continue;
+                }
+
+                const juce::ump::BytesOnGroup bytes { 0, { reinterpret_cast<const std::byte*> (meta.data),
+                                                           (std::size_t) meta.numBytes } };
+                juce::ump::Conversion::toMidi1 (bytes, queue);
+            }
+
+            while (e < n)
+                queue (juce::ump::View (packets[(std::size_t) e++].packet.data()));
+        }
+
+        // ── Sender thread ─────────────────────────────────────────────────────
+        // Polls instead of being woken: the audio thread never signals.  The
+        // devices' own background threads keep the in-block timing; only a
+        // block queued less than a millisecond before its time goes out late.
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                sendQueued();
+                wait (1);
+            }
+        }
+
+        void sendQueued()
+        {
+            for (auto& b : sendBuffers)
+                b.clear();
+
+            for (auto& packets : sendPackets)
+                packets.clear();
+
+            std::array<double, maxPorts> startMs {};
+
+            // One drain: per-port buffers in µs from the first event of each port
+            queued.drain ([&] (const QueuedEvent& e)
+            {
+                const auto idx = (std::size_t) e.port;
+
+                if (e.numBytes == 0)
+                {
+                    sendPackets[idx].add (juce::ump::View (e.words.data()));
+                    return;
+                }
+
+                auto& buffer = sendBuffers[idx];
+
+                if (buffer.isEmpty())
+                    startMs[idx] = e.timeMs;
+
+                const int positionUs = (int) std::round ((e.timeMs - startMs[idx]) * 1000.0);
+                buffer.addEvent (e.bytes.data(), e.numBytes, juce::jmax (0, positionUs));
+            });
+
+            const juce::ScopedLock sl (deviceLock);
+
+            for (int p = 1; p < maxPorts; ++p)
+            {
+                const auto idx = (std::size_t) p;
+
+                if (auto* device = outputs[idx].get(); device != nullptr && ! sendBuffers[idx].isEmpty())
+                    device->sendBlockOfMessages (sendBuffers[idx], startMs[idx], 1.0e6);
+
+                if (auto* device = umpOutputs[idx].get(); device != nullptr && sendPackets[idx].size() > 0)
+                    device->send (sendPackets[idx].begin(), sendPackets[idx].end());
+            }
+        }
+
+        static inline const juce::Identifier stateId { "MidiPorts" };
+
+        double msPerSample = 1000.0 / 48000.0;
+
+        // Audio thread
+        std::array<juce::MidiBuffer, maxPorts> portBuffers;   // [0] unused (main buffer is the host's)
+        juce::MidiBuffer                       gatedBuffer;
+        std::array<BandwidthGate, maxPorts>    gates;
+        std::array<bool, maxPorts>             routedThisBlock {};
+        std::array<bool, maxPorts>             umpThisBlock {};
+
+        struct UmpEvent
+        {
+            int                    sampleOffset = 0;
+            juce::ump::PacketX2    packet;
+        };
+
+        static constexpr int maxUmpEventsPerBlock = 512;
+        std::array<std::array<UmpEvent, maxUmpEventsPerBlock>, maxPorts> umpEvents {};
+        std::array<int, maxPorts>                                        numUmpEvents {};
+
+        // Sender thread
+        std::array<juce::MidiBuffer, maxPorts>   sendBuffers;   // [0] unused
+        std::array<juce::ump::Packets, maxPorts> sendPackets;
+
+        // Shared
+        EventRing                                        queued;
+        juce::CriticalSection                            deviceLock;   // message + sender threads only
+        std::array<std::unique_ptr<juce::MidiOutput>, maxPorts> outputs;   // [0] unused
+        std::array<std::unique_ptr<juce::ump::Output>, maxPorts> umpOutputs;
+        std::array<std::atomic<bool>,  maxPorts>         portIsUmp  {};   // opened as UMP
+        std::array<std::atomic<bool>,  maxPorts>         umpMode    {};   // requested
+        std::array<std::atomic<bool>,  maxPorts>         portOpen   {};
+        std::array<std::atomic<bool>,  maxPorts>         dinLimited {};
+        std::array<std::atomic<int>,   maxPorts>         dropped    {};
+        std::array<std::atomic<float>, maxPorts>         backlogMs  {};
+
+        // Message thread
+        std::array<juce::String, maxPorts> deviceIds;   // requested
+        std::array<juce::String, maxPorts> openIds;     // currently opened
+        std::optional<juce::ump::Session>  umpSession;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OutputPorts)
+    };
+} // namespace modztakt::ports
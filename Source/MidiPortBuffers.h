@@ -0,0 +1,40 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Per-port output buffers
+//
+// The part of the output port model the engines write into: one MidiBuffer
+// per port for the current block.  Devices, MIDI 2.0 endpoints and the DIN
+// bandwidth gate live in MidiOutputPorts.h, which the engines never include
+// (see EngineCore.h: the engine library links juce_audio_basics only).
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::ports
+{
+    static constexpr int maxPorts = 4;
+
+    // ─────────────────────────────────────────────────────────────────────────
+    // Per-port output targets for one processBlock().
+    // Out-of-range ports resolve to the main output.
+    // ─────────────────────────────────────────────────────────────────────────
+    struct PortBuffers
+    {
+        std::array<juce::MidiBuffer*, maxPorts> buffers {};
+
+        juce::MidiBuffer& operator[] (int port) const noexcept
+        {
+            auto* b = (port > 0 && port < maxPorts) ? buffers[(std::size_t) port] : nullptr;
+            return b != nullptr ? *b : *buffers[0];
+        }
+
+        // Every port writes into the same buffer (single-output callers).
+        static PortBuffers allTo (juce::MidiBuffer& b) noexcept
+        {
+            PortBuffers p;
+            p.buffers.fill (&b);
+            return p;
+        }
+    };
+} // namespace modztakt::ports
@@ -0,0 +1,280 @@
+#pragma once
+#include <JuceHeader.h>
+
+#include "Cosmetic.h"
+#include "MidiOutputPorts.h"
+#include "LfoEngine.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// MIDI output ports — shown in a CallOutBox from the Settings menu.
+//
+// Top:    one row per port  [Port | Device | DIN rate | MIDI 2.0 | backlog / dropped]
+//         Port 1 ("Main") is the host / default output and has no device box
+//         or MIDI 2.0 toggle (hosts only take MIDI 1.0 from plugins).
+// Bottom: route → port matrix  [Route N | LFO | EG | Delay]
+//         (routes past the third have an LFO route only)
+//
+// Device choices are applied to OutputPorts immediately (and saved with the
+// plugin state); the matrix boxes are bound to the "*_port" APVTS parameters.
+// Multi-tap ports live in the tap editor.
+// ─────────────────────────────────────────────────────────────────────────────
+class MidiPortsEditorComponent : public juce::Component, private juce::Timer
+{
+public:
+    using APVTS            = juce::AudioProcessorValueTreeState;
+    using ChoiceAttachment = APVTS::ComboBoxAttachment;
+
+    static constexpr int maxPorts  = modztakt::ports::maxPorts;
+    static constexpr int numRoutes   = modztakt::lfo::maxRoutes;   // LFO routes
+    static constexpr int numEgRoutes = 3;                           // EG / delay routes
+
+    static constexpr int rowHeight = 24;
+    static constexpr int rowGap    = 6;
+
+    MidiPortsEditorComponent (APVTS& apvtsRef, modztakt::ports::OutputPorts& portsRef)
+        : apvts (apvtsRef), ports (portsRef)
+    {
+        setName ("MIDI Output Ports");
+
+        const auto devices = juce::MidiOutput::getAvailableDevices();
+        const auto portNames = modztakt::ports::makePortChoices();
+
+        for (int p = 0; p < maxPorts; ++p)
+        {
+            auto& row = portRows[(size_t) p];
+
+            setupLabel (row.label, portNames[p]);
+
+            if (p == 0)
+            {
+                setupLabel (row.hostLabel, "Host / default output");
+            }
+            else
+            {
+                const auto current = ports.getPortDevice (p);
+
+                // ComboBox IDs: 1 = None, 2.. = devices
+                row.deviceBox.addItem ("None", 1);
+                int selectedId = 1;
+
+                for (int d = 0; d < devices.size(); ++d)
+                {
+                    row.deviceBox.addItem (devices[d].name, d + 2);
+                    if (devices[d].identifier == current)
+                        selectedId = d + 2;
+                }
+
+                // Saved device not present on this machine: keep the choice visible.
+                if (current.isNotEmpty() && selectedId == 1)
+                {
+                    selectedId = devices.size() + 2;
+                    row.deviceBox.addItem ("(unavailable device)", selectedId);
+                }
+
+                row.deviceBox.setSelectedId (selectedId, juce::dontSendNotification);
+
+                row.umpToggle.setButtonText ("MIDI 2.0");
+                row.umpToggle.setTooltip ("Open the device as a MIDI 2.0 (UMP) endpoint: 32-bit controllers, per-note EG controllers");
+                row.umpToggle.setColour (juce::ToggleButton::textColourId, SetupUI::labelsColor);
+                row.umpToggle.setToggleState (ports.isPortUmp (p), juce::dontSendNotification);
+                row.umpToggle.onClick = [this, p]
+                {
+                    ports.setPortUmp (p, portRows[(size_t) p].umpToggle.getToggleState());
+                };
+                addAndMakeVisible (row.umpToggle);
+
+                row.deviceBox.onChange = [this, p, devices]
+                {
+                    const int d = portRows[(size_t) p].deviceBox.getSelectedId() - 2;
+
+                    if (d < 0)
+                        ports.setPortDevice (p, {});
+                    else if (d < devices.size())
+                        ports.setPortDevice (p, devices[d].identifier);
+                };
+                addAndMakeVisible (row.deviceBox);
+            }
+
+            row.dinToggle.setButtonText ("DIN rate");
+            row.dinToggle.setTooltip ("Model a 31.25 kbaud DIN link: drop CCs on this port when the wire is backlogged (notes always pass)");
+            row.dinToggle.setColour (juce::ToggleButton::textColourId, SetupUI::labelsColor);
+            row.dinToggle.setToggleState (ports.isDinLimited (p), juce::dontSendNotification);
+            row.dinToggle.onClick = [this, p]
+            {
+                ports.setDinLimited (p, portRows[(size_t) p].dinToggle.getToggleState());
+            };
+            addAndMakeVisible (row.dinToggle);
+
+            setupLabel (row.statusLabel, {});
+        }
+
+        for (const auto* h : { "", "LFO", "EG", "Delay" })
+        {
+            auto* l = headerLabels.add (new juce::Label ({}, h));
+            l->setColour (juce::Label::textColourId, SetupUI::labelsColor);
+            l->setJustificationType (juce::Justification::centredLeft);
+            addAndMakeVisible (l);
+        }
+
+        for (int r = 0; r < numRoutes; ++r)
+        {
+            const auto rs = juce::String (r);
+            auto& row = routeRows[(size_t) r];
+
+            setupLabel (row.label, "Route " + juce::String (r + 1));
+
+            setupPortBox (row.lfoBox);
+            row.lfoAttach = std::make_unique<ChoiceAttachment> (apvts, "route" + rs + "_port", row.lfoBox);
+
+            // Routes past the EG / delay count: LFO column only
+            if (r >= numEgRoutes)
+                continue;
+
+            setupPortBox (row.egBox);
+            setupPortBox (row.delayBox);
+
+            row.egAttach    = std::make_unique<ChoiceAttachment> (apvts, "egRoute"    + rs + "_port", row.egBox);
+            row.delayAttach = std::make_unique<ChoiceAttachment> (apvts, "delayRoute" + rs + "_port", row.delayBox);
+        }
+
+        setSize (600, (rowHeight + rowGap) * (maxPorts + numRoutes + 1) + 24);
+
+        updateStatus();
+        startTimerHz (10);
+    }
+
+    ~MidiPortsEditorComponent() override
+    {
+        stopTimer();
+
+        // Reset all APVTS attachments before components are destroyed.
+        for (auto& row : routeRows)
+        {
+            row.lfoAttach.reset();
+            row.egAttach.reset();
+            row.delayAttach.reset();
+        }
+    }
+
+    void paint (juce::Graphics& g) override
+    {
+        g.fillAll (SetupUI::background);
+
+        g.setColour (SetupUI::labelsColor.withAlpha (0.3f));
+        g.drawHorizontalLine (separatorY, 8.0f, (float) getWidth() - 8.0f);
+    }
+
+    void resized() override
+    {
+        auto area = getLocalBounds().reduced (8, 6);
+
+        for (int p = 0; p < maxPorts; ++p)
+        {
+            auto& row = portRows[(size_t) p];
+            auto  line = area.removeFromTop (rowHeight);
+
+            row.label.setBounds (line.removeFromLeft (60).reduced (2, 0));
+
+            auto device = line.removeFromLeft (200).reduced (2, 0);
+            (p == 0 ? static_cast<juce::Component&> (row.hostLabel)
+                    : static_cast<juce::Component&> (row.deviceBox)).setBounds (device);
+
+            row.dinToggle.setBounds (line.removeFromLeft (90).reduced (2, 0));
+            row.umpToggle.setBounds (line.removeFromLeft (84).reduced (2, 0));
+            row.statusLabel.setBounds (line.reduced (2, 0));
+
+            area.removeFromTop (rowGap);
+        }
+
+        separatorY = area.getY() + rowGap;
+        area.removeFromTop (rowGap * 2);
+
+        // Column widths: Route | LFO | EG | Delay
+        const std::array<int, 4> widths { 80, 100, 100, 100 };
+
+        auto layoutColumns = [&] (juce::Rectangle<int> row, std::array<juce::Component*, 4> comps)
+        {
+            for (size_t c = 0; c < comps.size(); ++c)
+                comps[c]->setBounds (row.removeFromLeft (widths[c]).reduced (2, 0));
+        };
+
+        layoutColumns (area.removeFromTop (rowHeight),
+                       { headerLabels[0], headerLabels[1], headerLabels[2], headerLabels[3] });
+        area.removeFromTop (rowGap);
+
+        for (auto& row : routeRows)
+        {
+            layoutColumns (area.removeFromTop (rowHeight),
+                           { &row.label, &row.lfoBox, &row.egBox, &row.delayBox });
+            area.removeFromTop (rowGap);
+        }
+    }
+
+private:
+    // ── Timer: refresh per-port status ────────────────────────────────────────
+    void timerCallback() override
+    {
+        updateStatus();
+    }
+
+    void updateStatus()
+    {
+        for (int p = 0; p < maxPorts; ++p)
+        {
+            auto& row = portRows[(size_t) p];
+
+            juce::String text;
+
+            if (! ports.isPortOpen (p))
+                text = (p > 0 && ports.isPortUmp (p) && ports.getPortDevice (p).isNotEmpty())
+                     ? "UMP unavailable -> Main" : "-> Main";
+            else if (ports.isDinLimited (p))
+                text = juce::String (ports.getBacklogMs (p), 1) + " ms, "
+                     + juce::String (ports.getDroppedCount (p)) + " dropped";
+
+            row.statusLabel.setText (text, juce::dontSendNotification);
+        }
+    }
+
+    void setupLabel (juce::Label& l, const juce::String& text)
+    {
+        l.setText (text, juce::dontSendNotification);
+        l.setColour (juce::Label::textColourId, SetupUI::labelsColor);
+        l.setJustificationType (juce::Justification::centredLeft);
+        addAndMakeVisible (l);
+    }
+
+    void setupPortBox (juce::ComboBox& box)
+    {
+        // ComboBox IDs: 1 = Main, 2..4 = Port 2..4
+        box.addItemList (modztakt::ports::makePortChoices(), 1);
+        addAndMakeVisible (box);
+    }
+
+    // ─────────────────────────────────────────────────────────────────────────
+    APVTS& apvts;
+    modztakt::ports::OutputPorts& ports;
+
+    struct PortRow
+    {
+        juce::Label        label, hostLabel, statusLabel;
+        juce::ComboBox     deviceBox;
+        juce::ToggleButton dinToggle, umpToggle;
+    };
+
+    struct RouteRow
+    {
+        juce::Label    label;
+        juce::ComboBox lfoBox, egBox, delayBox;
+
+        std::unique_ptr<ChoiceAttachment> lfoAttach, egAttach, delayAttach;
+    };
+
+    std::array<PortRow,  maxPorts>  portRows;
+    std::array<RouteRow, numRoutes> routeRows;
+    juce::OwnedArray<juce::Label>   headerLabels;
+
+    int separatorY = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiPortsEditorComponent)
+};
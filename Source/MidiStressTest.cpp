@@ -0,0 +1,855 @@
+// MIDI stress / fuzz run (StressTest/ModzTakt_stress.jucer → console app)
+//
+// Drives a headless ModzTaktAudioProcessor through processBlock(), block by
+// block, with generated input far denser than a player produces:
+//   chords        dense chords (half of them on the EG / delay source channel),
+//                 random releases
+//   orphanOffs    note-offs for notes never played, note-off before note-on
+//                 at the same sample
+//   clock         300 BPM MIDI clock with ±30 % jitter, paced in real time:
+//                 the clock handler times clocks on arrival
+//   transport     Start / Stop / Continue storms, Start on Play toggled
+//   ccFlood       CC floods on the route channels (the knobFollow path), with
+//                 the DIN gate on the main output
+//   presets       program changes (MIDI and host) into a bank of random
+//                 presets, with and without engine reset, on random program
+//                 channels
+//   mixed         all of the above at once, sync mode toggled too
+// plus random parameter automation between blocks (edge values included) and
+// the LFO Start/Stop button flipped now and then.  setLfoActive events are
+// applied to the parameter the way the editor does.
+//
+// LFO, EG and delay routes are spread over the four output ports.  No device
+// is opened here, so ports 2-4 fall back to the main output; their DIN flag
+// is set and must not gate the fallback.
+//
+// Invariants checked on every block:
+//   - no operator new inside processBlock (replaced below; counts while a
+//     block runs).  JUCE containers use std::malloc directly: the output
+//     buffer's size is compared to the capacity reserved up front
+//   - every output data byte is a valid 7-bit value
+//   - LFO run state (LfoRunIntent): an explicit Stop always wins; with clock
+//     sync on, a stopped transport keeps the LFO off unless EG → LFO can
+//     force it; a Start with Start on Play runs it
+//   - tempo: finite and within the clock handler's range
+//   - delay primers: each echo note-on has its auto-pan CC and per-note EG
+//     primer on its channel, at the same sample, ahead of it
+//   - preset recall: the requested program is current and every preset
+//     parameter holds the stored value; a preset that resets the engine
+//     releases every sounding echo in that block
+//   - processBlock time against the block's real-time duration
+// and at the end of a phase / the run:
+//   - tempo ≈ 300 BPM after the clock phase (when it ran for a second or more)
+//   - the DIN gate dropped controllers during the CC flood, and never on a
+//     port without a device
+//   - after a drain (input released, feedback off, silence until the delay
+//     schedule empties): no echo left scheduled, every echo note-on on the
+//     output got its note-off
+//
+// Usage: ModzTaktStress [--seed N] [--blocks N]   (blocks per phase)
+// Exit code 0 when every invariant held, 1 otherwise.
+#include "PluginProcessor.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Headless: no editor in the stress run
+juce::AudioProcessorEditor* ModzTaktAudioProcessor::createEditor()
+{
+    return nullptr;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Allocation counter
+//
+// Replaces the global allocator for the whole program; only allocations made
+// while the calling thread is inside processBlock are counted.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace
+{
+    thread_local bool countAllocations = false;
+    std::atomic<int> allocationsCounted { 0 };
+
+    void* allocate (std::size_t size)
+    {
+        if (countAllocations)
+            allocationsCounted.fetch_add (1, std::memory_order_relaxed);
+
+        if (void* p = std::malloc (size == 0 ? 1 : size))
+            return p;
+
+        throw std::bad_alloc();
+    }
+
+    // Counts the allocations made by `fn` on this thread.
+    template <typename Fn>
+    int countAllocationsIn (Fn&& fn)
+    {
+        const int before = allocationsCounted.load (std::memory_order_relaxed);
+        countAllocations = true;
+        fn();
+        countAllocations = false;
+        return allocationsCounted.load (std::memory_order_relaxed) - before;
+    }
+}
+
+void* operator new (std::size_t size)                                  { return allocate (size); }
+void* operator new[] (std::size_t size)                                { return allocate (size); }
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept   { try { return allocate (size); } catch (...) { return nullptr; } }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept { try { return allocate (size); } catch (...) { return nullptr; } }
+void operator delete (void* p) noexcept                                { std::free (p); }
+void operator delete[] (void* p) noexcept                              { std::free (p); }
+void operator delete (void* p, std::size_t) noexcept                   { std::free (p); }
+void operator delete[] (void* p, std::size_t) noexcept                 { std::free (p); }
+void operator delete (void* p, const std::nothrow_t&) noexcept          { std::free (p); }
+void operator delete[] (void* p, const std::nothrow_t&) noexcept        { std::free (p); }
+
+namespace modztakt::stress
+{
+    struct Options
+    {
+        double sampleRate     = 48000.0;
+        int    blockSize      = 128;
+        int    blocksPerPhase = 3000;      // ≈ 8 s of audio per phase at 48 kHz / 128
+        int    seed           = 1;
+        double maxDrainMs     = 70000.0;   // 32 echoes of 2 s, the longest chain
+    };
+
+    class Fuzzer
+    {
+    public:
+        Fuzzer (ModzTaktAudioProcessor& p, const Options& o)
+            : processor (p), apvts (p.getAPVTS()), opts (o), rng (o.seed)
+        {
+            // Room for the densest block: the output must not grow inside processBlock
+            in.ensureSize (outputCapacity);
+            io.ensureSize (outputCapacity);
+            audio.setSize (juce::jmax (p.getTotalNumInputChannels(), p.getTotalNumOutputChannels()), opts.blockSize);
+
+            for (auto* param : p.getParameters())
+            {
+                if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (param))
+                {
+                    if (! isOneOf (ranged->paramID, scenarioIds))
+                        automatable.push_back (ranged);
+
+                    if (! isOneOf (ranged->paramID, presets::excludedIds))
+                        presetParams.push_back (ranged);   // PresetBank's parameter order
+                }
+            }
+        }
+
+        // Runs every phase on the prepared processor; returns the number of failed checks.
+        int run()
+        {
+            processor.setRateAndBufferSizeDetails (opts.sampleRate, opts.blockSize);
+            processor.prepareToPlay (opts.sampleRate, opts.blockSize);
+
+            setInitialState();
+            fillPresetBank();
+            setInitialState();
+
+            for (int phase = 0; phase < numPhases; ++phase)
+            {
+                beginPhase ((Phase) phase);
+
+                for (int b = 0; b < opts.blocksPerPhase; ++b)
+                    runBlock ((Phase) phase, b);
+
+                endPhase ((Phase) phase);
+            }
+
+            drain();
+            processor.releaseResources();
+            return numFailures;
+        }
+
+        juce::String makeReport() const
+        {
+            juce::String r;
+            r << blocksRun << " blocks (" << juce::String (blocksRun * budgetMs() / 1000.0, 1) << " s of audio)\n"
+              << "processBlock: avg " << juce::String (totalBlockMs / juce::jmax (1, blocksRun), 4)
+              << " ms, max " << juce::String (maxBlockMs, 3) << " ms, "
+              << blocksOverBudget << " over the " << juce::String (budgetMs(), 2) << " ms budget\n"
+              << "tempo after the clock phase: " << juce::String (clockPhaseBpm, 1) << " BPM\n"
+              << "preset recalls: " << recalls << " (" << resetRecalls << " with engine reset)\n"
+              << "DIN drops on the main output: " << processor.getOutputPorts().getDroppedCount (0) << "\n";
+
+            if (numFailures == 0)
+                r << "All invariants held.";
+            else
+                r << numFailures << " failure(s):\n" << failures.joinIntoString ("\n");
+
+            return r;
+        }
+
+    private:
+        static constexpr int outputCapacity = 1 << 16;   // bytes
+        static constexpr int numPresets     = 6;         // slots 0..5 filled, the rest empty
+        static constexpr double clockBpm    = 300.0;
+
+        enum Phase { chords, orphanOffs, clock, transport, ccFlood, presets, mixed, numPhases };
+
+        static constexpr const char* phaseNames[numPhases] = { "chords", "orphanOffs", "clock", "transport", "ccFlood", "presets", "mixed" };
+
+        // Set by the phases only: random automation leaves them alone, so the
+        // run-state and tempo checks know what the processor sees.  Morph stays
+        // off, so the processor reads the live parameters.
+        static constexpr const char* scenarioIds[] = { "lfoActive", "syncMode", "playStart", "presetProgramChannel",
+                                                       "morphEnabled", "morphAmount" };
+
+        enum class Gate { open, closed, unknown };   // transport gate as the input left it
+
+        template <typename Ids>
+        static bool isOneOf (const juce::String& id, const Ids& ids)
+        {
+            for (const auto* i : ids)
+                if (id == i)
+                    return true;
+            return false;
+        }
+
+        // ── Parameters ────────────────────────────────────────────────────────
+        // Plain (denormalised) values, as the processor reads them.
+        void set (const juce::String& id, float value)
+        {
+            if (auto* p = apvts.getParameter (id))
+                p->setValueNotifyingHost (p->convertTo0to1 (value));
+        }
+
+        float get (const juce::String& id) const
+        {
+            return apvts.getRawParameterValue (id)->load();
+        }
+
+        void toggle (const juce::String& id) { set (id, get (id) > 0.5f ? 0.0f : 1.0f); }
+
+        // LFO routes at both ends of the table and EG / delay routes, spread
+        // over the four ports; every engine and primer on, clock sync on.
+        void setInitialState()
+        {
+            set ("syncMode", 1.0f);
+            set ("playStart", 1.0f);
+            set ("lfoActive", 1.0f);
+            set ("morphEnabled", 0.0f);
+            set ("presetProgramChannel", (float) presets::programChannelOmni);
+            set ("noteRestart", 1.0f);
+            set ("noteOffStop", 1.0f);
+            set ("knobFollow", 1.0f);
+            set ("scope", 1.0f);
+
+            const int numMapParams = processor.getInstrumentMap().size();
+            const int lfoRoutes[] = { 0, 5, 10, lfo::maxRoutes - 1 };
+
+            for (int i = 0; i < 4; ++i)
+            {
+                const auto rs = "route" + juce::String (lfoRoutes[i]);
+                set (rs + "_channel", (float) (1 + i));
+                set (rs + "_param", (float) rng.nextInt (numMapParams));
+                set (rs + "_port", (float) i);
+                set (rs + "_oneshot", 0.0f);
+
+                processor.getScopeRoutesEnabled()[(size_t) lfoRoutes[i]].store (true);
+            }
+
+            set ("egEnabled", 1.0f);
+            set ("egNoteSourceChannel", 1.0f);
+            set ("egToLfoRate", 1.0f);
+            set ("delayEnabled", 1.0f);
+            set ("delayNoteSourceChannel", 1.0f);
+            set ("delayRate", 120.0f);
+            set ("feedback", 0.6f);
+            set ("delayEgShape", 1.0f);
+            set ("delayEgPerNote", 1.0f);
+            set ("delayPanEnabled", 1.0f);
+            set ("delayPanWidth", 0.8f);
+
+            for (int r = 0; r < engine::maxEgRoutes; ++r)
+            {
+                const auto eg = "egRoute" + juce::String (r);
+                set (eg + "_channel", (float) (5 + r));
+                set (eg + "_port", (float) (1 + r));
+
+                const auto delay = "delayRoute" + juce::String (r);
+                set (delay + "_channel", (float) (8 + r));
+                set (delay + "_port", (float) (3 - r));
+            }
+
+            auto& ports = processor.getOutputPorts();
+            ports.setDinLimited (0, false);
+            for (int p = 1; p < ports::maxPorts; ++p)
+                ports.setDinLimited (p, true);
+        }
+
+        // Slots 0..numPresets-1: random setups (the scenario parameters as
+        // set up), every other one resetting the engine on recall.
+        void fillPresetBank()
+        {
+            for (int s = 0; s < numPresets; ++s)
+            {
+                for (int n = 0; n < 40; ++n)
+                    randomChange();
+
+                processor.getPresetBank().store (s, "Stress " + juce::String (s), s % 2 == 0);
+            }
+        }
+
+        void randomChange()
+        {
+            auto* p = automatable[(size_t) rng.nextInt ((int) automatable.size())];
+            const float x = rng.nextFloat();
+            p->setValueNotifyingHost (x < 0.25f ? 0.0f : x < 0.5f ? 1.0f : rng.nextFloat());
+        }
+
+        // One to three random changes, plus the Start/Stop button and, in the
+        // transport and mixed phases, Start on Play / sync mode.
+        void automate (Phase phase)
+        {
+            if (rng.nextFloat() < 0.2f)
+                for (int n = 1 + rng.nextInt (3); --n >= 0;)
+                    randomChange();
+
+            if (rng.nextFloat() < 0.02f)
+                toggle ("lfoActive");
+
+            if ((phase == transport || phase == mixed) && rng.nextFloat() < 0.01f)
+                toggle ("playStart");
+
+            if (phase == mixed && rng.nextFloat() < 0.005f)
+                toggle ("syncMode");
+        }
+
+        // ── Input generators ──────────────────────────────────────────────────
+        void addChords()
+        {
+            if (rng.nextFloat() < 0.3f)
+            {
+                // Half on channel 1: the EG / delay source channel of the initial setup
+                const int ch  = rng.nextBool() ? 1 : 1 + rng.nextInt (16);
+                const int pos = rng.nextInt (opts.blockSize);
+
+                for (int n = 3 + rng.nextInt (10); --n >= 0;)
+                {
+                    const int note = 24 + rng.nextInt (72);
+                    in.addEvent (juce::MidiMessage::noteOn (ch, note, (juce::uint8) (1 + rng.nextInt (127))), pos);
+                    held[(size_t) ch - 1][(size_t) note] = true;
+                }
+            }
+
+            if (rng.nextFloat() < 0.3f)
+            {
+                for (int ch = 1; ch <= 16; ++ch)
+                    for (int note = 0; note < 128; ++note)
+                        if (held[(size_t) ch - 1][(size_t) note] && rng.nextFloat() < 0.5f)
+                        {
+                            in.addEvent (juce::MidiMessage::noteOff (ch, note), rng.nextInt (opts.blockSize));
+                            held[(size_t) ch - 1][(size_t) note] = false;
+                        }
+            }
+        }
+
+        void addOrphanOffs()
+        {
+            const int ch   = 1 + rng.nextInt (16);
+            const int note = rng.nextInt (128);
+            const int pos  = rng.nextInt (opts.blockSize);
+
+            in.addEvent (juce::MidiMessage::noteOff (ch, note), pos);
+
+            // Off then on at the same sample: the note is held afterwards
+            if (rng.nextBool())
+            {
+                in.addEvent (juce::MidiMessage::noteOn (ch, note, (juce::uint8) 100), pos);
+                held[(size_t) ch - 1][(size_t) note] = true;
+            }
+        }
+
+        void addClock (double blockStartSample)
+        {
+            const double interval = opts.sampleRate * 60.0 / (clockBpm * 24.0);
+            const double blockEnd = blockStartSample + opts.blockSize;
+
+            while (nextClockSample < blockEnd)
+            {
+                const int pos = juce::jlimit (0, opts.blockSize - 1, (int) (nextClockSample - blockStartSample));
+                in.addEvent (juce::MidiMessage::midiClock(), pos);
+
+                nextClockSample += interval * (0.7 + 0.6 * rng.nextDouble());
+            }
+        }
+
+        void addTransport()
+        {
+            for (int n = rng.nextInt (4); --n >= 0;)
+            {
+                const int pos = rng.nextInt (opts.blockSize);
+
+                switch (rng.nextInt (3))
+                {
+                    case 0:  in.addEvent (juce::MidiMessage::midiStart(), pos);    break;
+                    case 1:  in.addEvent (juce::MidiMessage::midiStop(), pos);     break;
+                    default: in.addEvent (juce::MidiMessage::midiContinue(), pos); break;
+                }
+            }
+        }
+
+        void addCcFlood()
+        {
+            // The channels routes send to: incoming knob moves for those take the knobFollow path
+            std::vector<int> channels;
+            for (int r = 0; r < lfo::maxRoutes; ++r)
+                channels.push_back ((int) get ("route" + juce::String (r) + "_channel"));
+
+            for (int r = 0; r < engine::maxEgRoutes; ++r)
+            {
+                channels.push_back ((int) get ("egRoute" + juce::String (r) + "_channel"));
+                channels.push_back ((int) get ("delayRoute" + juce::String (r) + "_channel"));
+            }
+
+            for (int n = 0; n < 32; ++n)
+            {
+                int ch = channels[(size_t) rng.nextInt ((int) channels.size())];
+                if (ch < 1 || ch > 16)
+                    ch = 1 + rng.nextInt (16);
+
+                in.addEvent (juce::MidiMessage::controllerEvent (ch, rng.nextInt (128), rng.nextInt (128)),
+                             rng.nextInt (opts.blockSize));
+            }
+        }
+
+        // MIDI program changes (empty slots and programs past the bank
+        // included), host program changes, and the program channel moved.
+        void addProgramChanges (Phase phase)
+        {
+            if (rng.nextFloat() < 0.05f)
+                in.addEvent (juce::MidiMessage::programChange (1 + rng.nextInt (16), rng.nextInt (presets::numSlots + 8)),
+                             rng.nextInt (opts.blockSize));
+
+            if (rng.nextFloat() < 0.02f)
+            {
+                hostProgram = rng.nextInt (presets::numSlots);
+                processor.setCurrentProgram (hostProgram);
+            }
+
+            if (phase == presets && rng.nextFloat() < 0.01f)
+                set ("presetProgramChannel", (float) rng.nextInt (18));
+        }
+
+        // ── Phases ────────────────────────────────────────────────────────────
+        void beginPhase (Phase phase)
+        {
+            if (phase == clock)
+                phaseStartMs = juce::Time::getMillisecondCounterHiRes();
+
+            if (phase == ccFlood)
+            {
+                processor.getOutputPorts().setDinLimited (0, true);
+                dinDropsBefore = processor.getOutputPorts().getDroppedCount (0);
+            }
+        }
+
+        void endPhase (Phase phase)
+        {
+            if (phase == clock)
+            {
+                clockPhaseBpm = processor.getBpmForUi();
+
+                // The handler averages 48 clocks and smooths: give it a second
+                if (opts.blocksPerPhase * budgetMs() >= 1000.0 && std::abs (clockPhaseBpm - clockBpm) > 0.1 * clockBpm)
+                    fail ("clock: tempo " + juce::String (clockPhaseBpm, 1) + " BPM after "
+                          + juce::String (clockBpm, 0) + " BPM of MIDI clock");
+            }
+
+            if (phase == ccFlood)
+            {
+                if (processor.getOutputPorts().getDroppedCount (0) == dinDropsBefore)
+                    fail ("ccFlood: the DIN gate on the main output dropped nothing");
+
+                processor.getOutputPorts().setDinLimited (0, false);
+            }
+        }
+
+        // ── One block + checks ────────────────────────────────────────────────
+        void runBlock (Phase phase, int blockInPhase)
+        {
+            in.clear();
+            hostProgram = -1;
+            const double blockStartSample = (double) blocksRun * opts.blockSize;
+
+            const bool all = (phase == mixed);
+            if (all || phase == chords || phase == presets) addChords();
+            if (all || phase == orphanOffs) addOrphanOffs();
+            if (all || phase == clock)      addClock (blockStartSample);
+            if (all || phase == transport)  addTransport();
+            if (all || phase == ccFlood)    addCcFlood();
+            if (all || phase == presets)    addProgramChanges (phase);
+
+            automate (phase);
+
+            if (phase == clock)
+                waitUntil (phaseStartMs + blockInPhase * budgetMs());
+
+            process (phaseNames[phase]);
+        }
+
+        void process (const char* phaseName)
+        {
+            const int expectedProgram = getExpectedProgram();
+            const int programBefore = processor.getPresetBank().getCurrentProgram();
+            const auto soundingBefore = sounding;
+            const bool dinOnMain = processor.getOutputPorts().isDinLimited (0);
+
+            io.clear();
+            io.addEvents (in, 0, -1, 0);
+
+            const auto t0 = juce::Time::getHighResolutionTicks();
+            int allocations = countAllocationsIn ([this] { processor.processBlock (audio, io); });
+            const auto ms = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - t0) * 1000.0;
+
+            // JUCE containers grow through std::realloc, not operator new
+            if (io.data.size() > outputCapacity)
+                ++allocations;
+
+            ++blocksRun;
+            maxBlockMs = juce::jmax (maxBlockMs, ms);
+            totalBlockMs += ms;
+            if (ms > budgetMs())
+                ++blocksOverBudget;
+
+            if (allocations > 0)
+                fail (juce::String (phaseName) + ": " + juce::String (allocations) + " allocation(s) in processBlock()");
+
+            checkOutput (phaseName, dinOnMain);
+            checkRunState (phaseName);
+            checkTempo (phaseName);
+            checkPresetRecall (phaseName, expectedProgram, programBefore, soundingBefore);
+
+            // The editor's side of the Start/Stop button
+            processor.getUiEvents().drain ([this] (const ui::Event& e)
+            {
+                if (e.type == ui::Event::Type::setLfoActive)
+                    set ("lfoActive", e.flag ? 1.0f : 0.0f);
+            });
+        }
+
+        // Data bytes, echo notes, and the primers ahead of each echo note-on
+        // (skipped while the DIN gate may drop the primer CCs).
+        void checkOutput (const char* phaseName, bool dinOnMain)
+        {
+            const auto& map = processor.getInstrumentMap();
+
+            const int panIndex = map.getRoleIndex (instrument::Role::Pan);
+            const bool panActive = ! dinOnMain && get ("delayPanEnabled") > 0.5f && get ("delayPanWidth") > 0.0f
+                                && panIndex >= 0 && map[panIndex].isCC;
+            const int panCc = panActive ? map[panIndex].ccNumber : -1;
+            const int panDeviation = juce::roundToInt (get ("delayPanWidth") * 63.0f);
+
+            const int egShape = (int) get ("delayEgShape");
+            const int egIndex = egShape > 0 ? map.getRoleIndex (egShape == 1 ? instrument::Role::Volume : instrument::Role::Level) : -1;
+            const bool egPrimeActive = ! dinOnMain && get ("delayEgPerNote") > 0.5f && egIndex >= 0;
+            const int egController = egPrimeActive ? (map[egIndex].isCC ? map[egIndex].ccNumber : 99) : -1;   // NRPN: parameter MSB first
+
+            std::array<bool, 17> panSeen {}, egSeen {};
+            int position = -1;
+
+            for (auto& ch : offsThisBlock)
+                ch.fill (0);
+
+            for (const auto meta : io)
+            {
+                const auto msg = meta.getMessage();
+
+                if (! hasValidDataBytes (msg))
+                    fail (juce::String (phaseName) + ": invalid data byte in " + msg.getDescription());
+
+                if (meta.samplePosition != position)
+                {
+                    position = meta.samplePosition;
+                    panSeen.fill (false);
+                    egSeen.fill (false);
+                }
+
+                const int ch = juce::jlimit (1, 16, msg.getChannel());
+
+                if (msg.isController())
+                {
+                    const int cc = msg.getControllerNumber();
+                    const int value = msg.getControllerValue();
+
+                    if (cc == panCc && (value == juce::jlimit (0, 127, 64 + panDeviation) || value == juce::jlimit (0, 127, 64 - panDeviation)))
+                        panSeen[(size_t) ch] = true;
+
+                    if (cc == egController)
+                        egSeen[(size_t) ch] = true;
+                }
+                else if (msg.isNoteOn())
+                {
+                    if (panActive && ! panSeen[(size_t) ch])
+                        fail (juce::String (phaseName) + ": echo note-on without its auto-pan CC on channel " + juce::String (ch));
+
+                    if (egPrimeActive && ! egSeen[(size_t) ch])
+                        fail (juce::String (phaseName) + ": echo note-on without its per-note EG primer on channel " + juce::String (ch));
+
+                    panSeen[(size_t) ch] = egSeen[(size_t) ch] = false;
+                    ++sounding[(size_t) ch - 1][(size_t) msg.getNoteNumber()];
+                }
+                else if (msg.isNoteOff())
+                {
+                    auto& n = sounding[(size_t) ch - 1][(size_t) msg.getNoteNumber()];
+                    if (n > 0)
+                        --n;
+
+                    ++offsThisBlock[(size_t) ch - 1][(size_t) msg.getNoteNumber()];
+                }
+            }
+        }
+
+        // LfoRunIntent against the state the input and the parameters left.
+        void checkRunState (const char* phaseName)
+        {
+            const bool active = get ("lfoActive") > 0.5f;
+            const bool explicitStop = lastLfoActive && ! active;
+            lastLfoActive = active;
+
+            bool gotStart = false, gotStop = false, gotNoteOff = false;
+            for (const auto meta : in)
+            {
+                const auto msg = meta.getMessage();
+                gotStart   = gotStart || msg.isMidiStart();
+                gotStop    = gotStop || msg.isMidiStop();
+                gotNoteOff = gotNoteOff || msg.isNoteOff();
+            }
+
+            const bool sync = (int) get ("syncMode") == 1;
+
+            if (! sync)
+                gate = Gate::open;
+            else if (gotStart && gotStop)
+                gate = Gate::unknown;      // both in one block: not pinned down here
+            else if (gotStop)
+                gate = Gate::closed;
+            else if (gotStart)
+                gate = Gate::open;
+
+            const bool running = processor.isLfoRunningForUi();
+            const bool egCanForce = get ("egToLfoDepth") > 0.5f || get ("egToLfoRate") > 0.5f;
+
+            if (explicitStop && running)
+                fail (juce::String (phaseName) + ": LFO still running after an explicit Stop");
+
+            if (sync && gate == Gate::closed && ! egCanForce && running)
+                fail (juce::String (phaseName) + ": LFO running with the transport stopped");
+
+            if (sync && gotStart && ! gotStop && ! gotNoteOff && ! explicitStop && get ("playStart") > 0.5f && ! running)
+                fail (juce::String (phaseName) + ": Start with Start on Play left the LFO stopped");
+        }
+
+        void checkTempo (const char* phaseName)
+        {
+            const double bpm = processor.getBpmForUi();
+
+            if (! std::isfinite (bpm) || bpm < 0.0 || bpm >= 400.0)
+                fail (juce::String (phaseName) + ": tempo out of range: " + juce::String (bpm));
+        }
+
+        // Last program change the processor acts on this block (host first,
+        // then the MIDI input on the program channel), -1 for none.
+        int getExpectedProgram() const
+        {
+            int program = hostProgram;
+            const int pcChannel = (int) get ("presetProgramChannel");
+
+            if (pcChannel == presets::programChannelOff)
+                return program;
+
+            for (const auto meta : in)
+            {
+                const auto msg = meta.getMessage();
+
+                if (msg.isProgramChange() && msg.getProgramChangeNumber() < presets::numSlots
+                    && (pcChannel == presets::programChannelOmni || msg.getChannel() == pcChannel - 1))
+                    program = msg.getProgramChangeNumber();
+            }
+
+            return program;
+        }
+
+        void checkPresetRecall (const char* phaseName, int program, int programBefore,
+                                const std::array<std::array<int, 128>, 16>& soundingBefore)
+        {
+            if (program < 0)
+                return;
+
+            auto& bank = processor.getPresetBank();
+            const auto* preset = bank.getPreset (program);
+
+            if (preset == nullptr)
+            {
+                if (bank.getCurrentProgram() != programBefore)
+                    fail (juce::String (phaseName) + ": program change to empty slot " + juce::String (program) + " recalled something");
+                return;
+            }
+
+            ++recalls;
+
+            if (bank.getCurrentProgram() != program)
+                fail (juce::String (phaseName) + ": program " + juce::String (program) + " requested, "
+                      + juce::String (bank.getCurrentProgram()) + " current");
+
+            for (size_t i = 0; i < presetParams.size(); ++i)
+            {
+                if (std::abs (presetParams[i]->getValue() - preset->values[i]) > 1.0e-4f)
+                {
+                    fail (juce::String (phaseName) + ": program " + juce::String (program) + " did not recall "
+                          + presetParams[i]->paramID);
+                    break;
+                }
+            }
+
+            if (! preset->resetEngine)
+                return;
+
+            ++resetRecalls;
+
+            for (size_t ch = 0; ch < 16; ++ch)
+                for (size_t note = 0; note < 128; ++note)
+                    if (offsThisBlock[ch][note] < soundingBefore[ch][note])
+                        fail (juce::String (phaseName) + ": echo " + juce::String ((int) note) + " on channel "
+                              + juce::String ((int) ch + 1) + " left sounding by a preset engine reset");
+        }
+
+        // Release the input, stop feeding echoes and let the schedule empty.
+        void drain()
+        {
+            in.clear();
+            hostProgram = -1;
+
+            for (int ch = 1; ch <= 16; ++ch)
+                for (int note = 0; note < 128; ++note)
+                    if (std::exchange (held[(size_t) ch - 1][(size_t) note], false))
+                        in.addEvent (juce::MidiMessage::noteOff (ch, note), 0);
+
+            set ("feedback", 0.0f);
+
+            process ("drain");
+            in.clear();
+
+            const double blockMs = budgetMs();
+            for (double t = 0.0; t < opts.maxDrainMs && processor.getPendingEchoCount() > 0; t += blockMs)
+                process ("drain");
+
+            if (const int pending = processor.getPendingEchoCount(); pending > 0)
+                fail (juce::String (pending) + " echoes still scheduled after "
+                      + juce::String (opts.maxDrainMs / 1000.0, 0) + " s of silence");
+
+            int stuck = 0;
+            for (const auto& ch : sounding)
+                for (const auto n : ch)
+                    stuck += n;
+
+            if (stuck > 0)
+                fail (juce::String (stuck) + " output notes without a note-off");
+
+            for (int p = 1; p < ports::maxPorts; ++p)
+                if (const int dropped = processor.getOutputPorts().getDroppedCount (p); dropped > 0)
+                    fail ("port " + juce::String (p + 1) + " has no device but its DIN gate dropped "
+                          + juce::String (dropped) + " events");
+        }
+
+        static bool hasValidDataBytes (const juce::MidiMessage& msg) noexcept
+        {
+            const auto* data = msg.getRawData();
+            const int size = msg.getRawDataSize();
+
+            if (msg.isSysEx() || size < 1)
+                return true;
+
+            for (int i = 1; i < size; ++i)
+                if ((data[i] & 0x80) != 0)
+                    return false;
+
+            return true;
+        }
+
+        static void waitUntil (double targetMs)
+        {
+            for (;;)
+            {
+                const double left = targetMs - juce::Time::getMillisecondCounterHiRes();
+
+                if (left <= 0.0)
+                    return;
+
+                if (left > 2.0)
+                    juce::Thread::sleep (1);
+                else
+                    juce::Thread::yield();
+            }
+        }
+
+        double budgetMs() const noexcept { return 1000.0 * opts.blockSize / opts.sampleRate; }
+
+        void fail (const juce::String& what)
+        {
+            if (failures.size() < 20)
+                failures.add (what);
+            ++numFailures;
+        }
+
+        ModzTaktAudioProcessor& processor;
+        juce::AudioProcessorValueTreeState& apvts;
+        Options opts;
+        juce::Random rng;
+
+        std::vector<juce::RangedAudioParameter*> automatable;    // all but scenarioIds
+        std::vector<juce::RangedAudioParameter*> presetParams;   // all but presets::excludedIds
+
+        juce::AudioBuffer<float> audio;
+        juce::MidiBuffer in, io;
+
+        std::array<std::array<bool, 128>, 16> held {};            // input notes held
+        std::array<std::array<int, 128>, 16>  sounding {};        // output notes on - off
+        std::array<std::array<int, 128>, 16>  offsThisBlock {};   // output note-offs, last block
+        double nextClockSample = 0.0;
+
+        bool lastLfoActive = true;
+        Gate gate = Gate::open;
+        int  hostProgram = -1;
+
+        double phaseStartMs = 0.0, clockPhaseBpm = 0.0;
+        int    dinDropsBefore = 0, recalls = 0, resetRecalls = 0;
+
+        int    blocksRun = 0, blocksOverBudget = 0, numFailures = 0;
+        double maxBlockMs = 0.0, totalBlockMs = 0.0;
+        juce::StringArray failures;
+    };
+} // namespace modztakt::stress
+
+int main (int argc, char* argv[])
+{
+    // Parameters, state and the processor's timers need the message manager
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    modztakt::stress::Options options;
+    const juce::StringArray args (argv + 1, argc - 1);
+
+    if (const int i = args.indexOf ("--seed"); i >= 0)
+        options.seed = args[i + 1].getIntValue();
+
+    if (const int i = args.indexOf ("--blocks"); i >= 0)
+        options.blocksPerPhase = juce::jmax (1, args[i + 1].getIntValue());
+
+    ModzTaktAudioProcessor processor;
+    modztakt::stress::Fuzzer fuzzer (processor, options);
+    const int failures = fuzzer.run();
+
+    std::cout << "MIDI stress test (seed " << options.seed << ")\n"
+              << fuzzer.makeReport() << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
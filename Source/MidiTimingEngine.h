@@ -0,0 +1,219 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <chrono>
+#include <thread>
+
+#if JucePlugin_Build_Standalone
+ #include <juce_audio_plugin_client/Standalone/juce_StandaloneFilterWindow.h>
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Standalone MIDI-only timing engine
+//
+// ModzTakt produces no audio, yet in the standalone wrapper processBlock() only
+// runs from the audio device callback: MIDI timing then depends on the audio
+// buffer size, and nothing runs at all without a usable audio interface.
+//
+// When started, this engine:
+//   - detaches the processor from the wrapper's AudioProcessorPlayer,
+//   - collects incoming MIDI from the inputs enabled in the standalone
+//     "Audio/MIDI Settings" (same device selection as before),
+//   - calls processBlock() from its own real-time thread every tickMs
+//     (1 ms by default) with a virtual 48 kHz sample clock,
+//   - hands the resulting buffer to MidiOutput::sendBlockOfMessages() on the
+//     default MIDI output, timestamped one tick ahead so every event lands at
+//     its sample-accurate position with a constant one-tick latency.
+//
+// stop() re-attaches the processor to the audio player.
+// Outside the standalone build (or without a StandalonePluginHolder) the
+// engine reports itself unavailable and start() is a no-op.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::standalone
+{
+    class MidiTimingEngine : private juce::Thread
+    {
+    public:
+        static constexpr double defaultTickMs     = 1.0;
+        static constexpr double minTickMs         = 0.5;
+        static constexpr double maxTickMs         = 5.0;
+        static constexpr double virtualSampleRate = 48000.0;
+
+        explicit MidiTimingEngine (juce::AudioProcessor& p)
+            : juce::Thread ("ModzTakt MIDI timing"), processor (p) {}
+
+        ~MidiTimingEngine() override { stop (false); }
+
+        // True when running inside the standalone wrapper.
+        static bool isAvailable() noexcept
+        {
+           #if JucePlugin_Build_Standalone
+            return juce::PluginHostType::getPluginLoadedAs() == juce::AudioProcessor::wrapperType_Standalone
+                && juce::StandalonePluginHolder::getInstance() != nullptr;
+           #else
+            return false;
+           #endif
+        }
+
+        bool isRunning() const noexcept   { return isThreadRunning(); }
+        double getTickMs() const noexcept { return tickMs; }
+
+        // ── Message thread only ───────────────────────────────────────────────
+        bool start (double newTickMs = defaultTickMs)
+        {
+           #if JucePlugin_Build_Standalone
+            auto* holder = juce::StandalonePluginHolder::getInstance();
+            if (holder == nullptr || !isAvailable())
+                return false;
+
+            stop (false);
+
+            tickMs         = juce::jlimit (minTickMs, maxTickMs, newTickMs);
+            samplesPerTick = juce::jmax (1, juce::roundToInt (virtualSampleRate * tickMs / 1000.0));
+
+            // The audio callback must no longer drive the processor.
+            holder->player.setProcessor (nullptr);
+
+            processor.setRateAndBufferSizeDetails (virtualSampleRate, samplesPerTick);
+            processor.prepareToPlay (virtualSampleRate, samplesPerTick);
+
+            emptyAudio.setSize (0, samplesPerTick);
+            midi.ensureSize (4096);
+
+            collector.reset (virtualSampleRate);
+            holder->deviceManager.addMidiInputDeviceCallback ({}, &collector);
+
+            output = holder->deviceManager.getDefaultMidiOutput();
+            if (output != nullptr)
+                output->startBackgroundThread();
+
+            if (!startRealtimeThread (juce::Thread::RealtimeOptions{}.withPeriodMs (tickMs)))
+                startThread (juce::Thread::Priority::highest);
+
+            saveSettings (true);
+            return true;
+           #else
+            juce::ignoreUnused (newTickMs);
+            return false;
+           #endif
+        }
+
+        // reattach: hand the processor back to the audio player (false on shutdown).
+        void stop (bool reattach = true)
+        {
+            if (!isThreadRunning())
+                return;
+
+            stopThread (500);
+
+           #if JucePlugin_Build_Standalone
+            if (auto* holder = juce::StandalonePluginHolder::getInstance())
+            {
+                holder->deviceManager.removeMidiInputDeviceCallback ({}, &collector);
+
+                if (output != nullptr)
+                    output->stopBackgroundThread();
+
+                output = nullptr;
+                processor.releaseResources();
+
+                if (reattach)
+                {
+                    holder->player.setProcessor (&processor);
+                    saveSettings (false);
+                }
+            }
+           #else
+            juce::ignoreUnused (reattach);
+           #endif
+        }
+
+        // Re-apply the last saved choice from the standalone settings file.
+        // Call once the wrapper has started playing (i.e. from the editor).
+        void restoreFromSettings()
+        {
+           #if JucePlugin_Build_Standalone
+            if (restored || !isAvailable())
+                return;
+
+            restored = true;
+
+            if (auto* props = juce::StandalonePluginHolder::getInstance()->settings.get())
+                if (props->getBoolValue ("midiTimingEngine", false))
+                    start (props->getDoubleValue ("midiTimingTickMs", defaultTickMs));
+           #endif
+        }
+
+    private:
+        void run() override
+        {
+            using Clock = std::chrono::steady_clock;
+
+            const auto period = std::chrono::duration_cast<Clock::duration> (
+                std::chrono::duration<double, std::milli> (tickMs));
+
+            auto next = Clock::now();
+
+            while (!threadShouldExit())
+            {
+                next += period;
+                tick();
+
+                // Fell far behind (debugger, system stall): resync instead of bursting.
+                const auto now = Clock::now();
+                if (now - next > period * 4)
+                    next = now;
+
+                std::this_thread::sleep_until (next);
+            }
+        }
+
+        void tick()
+        {
+            midi.clear();
+            collector.removeNextBlockOfMessages (midi, samplesPerTick);
+
+            const double tickStartMs = juce::Time::getMillisecondCounterHiRes();
+
+            {
+                const juce::ScopedLock sl (processor.getCallbackLock());
+
+                if (processor.isSuspended())
+                    midi.clear();
+                else
+                    processor.processBlock (emptyAudio, midi);
+            }
+
+            // One tick of constant latency: events keep their in-tick offsets.
+            if (output != nullptr && !midi.isEmpty())
+                output->sendBlockOfMessages (midi, tickStartMs + tickMs, virtualSampleRate);
+        }
+
+        void saveSettings (bool enabled)
+        {
+           #if JucePlugin_Build_Standalone
+            if (auto* holder = juce::StandalonePluginHolder::getInstance())
+                if (auto* props = holder->settings.get())
+                {
+                    props->setValue ("midiTimingEngine", enabled);
+                    props->setValue ("midiTimingTickMs", tickMs);
+                }
+           #else
+            juce::ignoreUnused (enabled);
+           #endif
+        }
+
+        juce::AudioProcessor& processor;
+
+        double tickMs         = defaultTickMs;
+        int    samplesPerTick = 48;
+        bool   restored       = false;
+
+        juce::MidiMessageCollector collector;
+        juce::MidiBuffer           midi;
+        juce::AudioBuffer<float>   emptyAudio;
+        juce::MidiOutput*          output = nullptr;   // owned by the device manager
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiTimingEngine)
+    };
+} // namespace modztakt::standalone
@@ -2,14 +2,24 @@
 #include <JuceHeader.h>
 
 #include <array>
-#include <unordered_map>
 
 #include "MidiInParse.h"
 #include "SyntaktParameterTable.h"
+#include "InstrumentMapLibrary.h"
+#include "IncomingControllers.h"
 #include "MidiInput.h"
-#include "EnvelopeEngine.h"
-#include "LfoEngine.h"
-#include "DelayEngine.h"
+#include "EngineCore.h"
+#include "LfoRouteSync.h"
+#include "MidiOutputPorts.h"
+#include "ScopeStream.h"
+#include "UiRefresh.h"
+#include "UiEventQueue.h"
+#include "LfoTrace.h"
+#include "RouteOccupancy.h"
+#include "PluginState.h"
+#include "PresetBank.h"
+#include "SnapshotMorph.h"
+#include "MidiTimingEngine.h"
 
 // Forward declare editor
 class ModzTaktAudioProcessorEditor;
@@ -33,8 +43,7 @@ public:
 
     // LFO types live in LfoComponent.h
     using LfoShape = modztakt::lfo::LfoShape;
-    using LfoRoute = modztakt::lfo::LfoRoute;
-    using RouteSnapshot = modztakt::lfo::RouteSnapshot;
+    using LfoRouteTable = modztakt::lfo::RouteTable<modztakt::lfo::maxRoutes>;
 
     inline ModzTaktAudioProcessor()
         // For pure MIDI-effect plugins, buses are typically omitted.
@@ -42,12 +51,54 @@ public:
         // : juce::AudioProcessor (BusesProperties()
         //       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
         //       .withOutput ("Output", juce::AudioChannelSet::stereo(), true))
-        : apvts (*this, nullptr, "PARAMS", createParameterLayout())
+        : apvts (*this, nullptr, "PARAMS", createParameterLayout (instrumentMaps))
     {
         midiClock.setListener(this);
+
+        // Instrument maps from the user folder (the built-in Syntakt map is always there)
+        for (const auto& error : instrumentMaps.rescan())
+            DBG ("Instrument map: " << error);
+
+        // Multi-tap delay: resolve the tap parameter pointers once so the audio
+        // thread doesn't rebuild 48 string keys per block.
+        for (int t = 0; t < modztakt::delay::Params::maxTaps; ++t)
+        {
+            const auto ts = "delayTap" + juce::String (t);
+            auto& tp = delayTapParams[(size_t) t];
+            tp.channel   = apvts.getRawParameterValue (ts + "_channel");
+            tp.division  = apvts.getRawParameterValue (ts + "_division");
+            tp.timeMs    = apvts.getRawParameterValue (ts + "_time");
+            tp.velocity  = apvts.getRawParameterValue (ts + "_velocity");
+            tp.transpose = apvts.getRawParameterValue (ts + "_transpose");
+            tp.port      = apvts.getRawParameterValue (ts + "_port");
+        }
+
+        // Same for the EG / delay routes and the sequencer steps
+        for (int r = 0; r < maxRoutes; ++r)
+        {
+            const auto es = "egRoute" + juce::String (r);
+            auto& ep = egRouteParams[(size_t) r];
+            ep.channel = apvts.getRawParameterValue (es + "_channel");
+            ep.dest    = apvts.getRawParameterValue (es + "_dest");
+            ep.port    = apvts.getRawParameterValue (es + "_port");
+
+            const auto ds = "delayRoute" + juce::String (r);
+            auto& dp = delayRouteParams[(size_t) r];
+            dp.channel   = apvts.getRawParameterValue (ds + "_channel");
+            dp.transpose = apvts.getRawParameterValue (ds + "_transpose");
+            dp.port      = apvts.getRawParameterValue (ds + "_port");
+            dp.division  = apvts.getRawParameterValue (ds + "_division");
+        }
+
+        for (int s = 0; s < modztakt::delay::Params::maxSteps; ++s)
+            delaySeqStepParams[(size_t) s] = apvts.getRawParameterValue ("delaySeqStep" + juce::String (s));
     }
 
-    inline ~ModzTaktAudioProcessor() override = default;
+    inline ~ModzTaktAudioProcessor() override
+    {
+        // Stop the standalone timing thread before any member it touches goes away.
+        midiTimingEngine.stop (false);
+    }
 
     //==============================================================================
     inline void prepareToPlay (double sampleRate, int samplesPerBlock) override
@@ -55,13 +106,14 @@ public:
         cachedSampleRate = (sampleRate > 0.0 ? sampleRate : 48000.0);
         cachedBlockSize  = samplesPerBlock; // keep: if audio added
 
-        // EG
-        egEngine.setSampleRate(cachedSampleRate);
-        egEngine.reset();
+        // EG, delay and the send state
+        core.prepare (cachedSampleRate);
 
-        // Delay
-        delayEngine.setSampleRate(cachedSampleRate);
-        delayEngine.reset();
+        // Output ports
+        outputPorts.prepare (cachedSampleRate);
+
+        // Preset bank: blocks may now hold presets until they acknowledge an epoch
+        presetBank.setAudioActive (true);
 
         // MIDI Out throttles/perf - Initialize from parameters
         if (auto* throttleParam = apvts.getParameter("midiDataThrottle"))
@@ -80,7 +132,10 @@ public:
         // engine.prepare(cachedSampleRate, cachedBlockSize);
     }
 
-    inline void releaseResources() override {}
+    inline void releaseResources() override
+    {
+        presetBank.setAudioActive (false);
+    }
 
     inline bool isBusesLayoutSupported (const BusesLayout& layouts) const override
     {
@@ -148,14 +203,33 @@ public:
 
         midi.clear();
 
-        // pass through everything EXCEPT notes
+        // pass through everything EXCEPT notes (traced for the LFO state trace)
         for (const auto meta : midiIn)
         {
             const auto msg = meta.getMessage();
             if (! msg.isNoteOnOrOff())
                 midi.addEvent(msg, meta.samplePosition);
+            else
+                lfoTrace.traceNote (timeMs + 1000.0 * meta.samplePosition / juce::jmax (1.0, getSampleRate()), msg);
         }
 
+        // Per-port output buffers: generated events go to the route's port,
+        // pass-through stays on the main output.
+        const auto out = outputPorts.beginBlock (midi);
+
+        // Editor commands (preset recall, ...) queued since the last block
+        applyUiCommands();
+
+        // Program change → preset recall, before any parameter is read this block
+        recallPendingPreset (midiIn, out);
+
+        // Morph targets for this block: A/B morph when active, else the live parameters
+        namespace morph = modztakt::morph;
+        const auto& morphed = morphSnapshots.resolve();
+
+        // Instrument map for the whole block: a map switch lands here, never mid-block.
+        const auto& imap = instrumentMaps.getForBlock();
+
         const double blockStartMs = timeMs;
 
         const double blockDurationMs = 1000.0 * (double) audio.getNumSamples() / juce::jmax (1.0, getSampleRate());
@@ -165,9 +239,15 @@ public:
 
         const bool lfoActiveParam = apvts.getRawParameterValue("lfoActive")->load() > 0.5f;
 
-        const auto shape = static_cast<LfoShape>( (int) apvts.getRawParameterValue("lfoShape")->load() + 1 );
+        const auto shape = static_cast<LfoShape>( (int) morphed[morph::lfoShape] + 1 );
 
-        modztakt::lfo::syncRoutesFromApvts<maxRoutes> (apvts, shape, lfoRoutes, lastRouteSnapshot, lfoPhase);
+        curveToleranceSteps = getCurveToleranceFromIndex ((int) apvts.getRawParameterValue("midiCurveTolerance")->load());
+
+        // Who drives which (channel, parameter): route exclusivity lookups for this block
+        routeOccupancy.sync (imap);
+
+        // LFO routes: settings, exclusivity and the active-route list
+        lfoRouteSync.sync (routeOccupancy, imap, shape, lfoRoutes);
 
         const int syncModeId = ((int) apvts.getRawParameterValue("syncMode")->load()) + 1;
         const bool syncEnabled = (syncModeId == 2);
@@ -175,8 +255,8 @@ public:
         const bool startOnPlayToggleState = apvts.getRawParameterValue("playStart")->load() > 0.5f;
         startOnPlay.store(startOnPlayToggleState, std::memory_order_release);
 
-        const double rateSliderValueHz = apvts.getRawParameterValue("lfoRateHz")->load();
-        const double depthSliderValue  = apvts.getRawParameterValue("lfoDepth")->load();
+        const double rateSliderValueHz = morphed[morph::lfoRate];
+        const double depthSliderValue  = morphed[morph::lfoDepth];
 
         const bool noteRestartToggleState = apvts.getRawParameterValue("noteRestart")->load() > 0.5f;
         // if (!noteRestartToggleState)
@@ -186,46 +266,16 @@ public:
         const int noteSourceChannel = (int) apvts.getRawParameterValue("noteSourceChannel")->load();
         const int syncDivisionId = (int) apvts.getRawParameterValue("syncDivision")->load() + 1;
 
+        // Start/Stop request reached the parameter: a new one may be posted
+        if (requestedLfoActive >= 0 && lfoActiveParam == (requestedLfoActive == 1))
+            requestedLfoActive = -1;
+
         // Detect user explicit stop (button OFF)
         const bool userExplicitStop = lastLfoActiveParam && !lfoActiveParam;
         lastLfoActiveParam = lfoActiveParam;
 
         // -------------------------------------------------------------------------
 
-        // LFO Routes
-        for (int i = 0; i < maxRoutes; ++i)
-        {
-            const auto rs = juce::String(i);
-
-            // CLEANED: Removed redundant ternary - chChoice0 is already the channel value we need
-            const int midiChannel = (int) apvts.getRawParameterValue("route" + rs + "_channel")->load();
-
-            const int paramIdx = (int) apvts.getRawParameterValue("route" + rs + "_param")->load(); // 0..N-1
-
-            bool bipolar = apvts.getRawParameterValue("route" + rs + "_bipolar")->load() > 0.5f;
-            bool invert  = apvts.getRawParameterValue("route" + rs + "_invert")->load()  > 0.5f;
-            bool oneShot = apvts.getRawParameterValue("route" + rs + "_oneshot")->load() > 0.5f;
-
-            // if Random shape, force these off
-            if (shape == LfoShape::Random)
-            {
-                bipolar = false;
-                invert  = false;
-            }
-
-            // Apply to engine routes
-            auto& r = lfoRoutes[i];
-            r.midiChannel = midiChannel;
-            r.parameterIndex = paramIdx;
-            r.bipolar = bipolar;
-            r.invertPhase = invert;
-
-            // if oneshot is turned off, clear completion state
-            if (!oneShot)
-                r.hasFinishedOneShot = false;
-            r.oneShot = oneShot;
-        }
-
         // Delay
         const int delaySourceChannel = (int) apvts.getRawParameterValue("delayNoteSourceChannel")->load();
 
@@ -240,18 +290,18 @@ public:
         egParams.enabled          = apvts.getRawParameterValue("egEnabled")->load() > 0.5f;
         egIsEnabled.store((bool) egParams.enabled, std::memory_order_release);
 
-        egParams.attackSeconds    = apvts.getRawParameterValue("egAttack")->load();
-        egParams.holdSeconds      = apvts.getRawParameterValue("egHold")->load();
-        egParams.decaySeconds     = apvts.getRawParameterValue("egDecay")->load();
-        egParams.sustain01        = apvts.getRawParameterValue("egSustain")->load();
-        egParams.releaseSeconds   = apvts.getRawParameterValue("egRelease")->load();
-        egParams.velocityAmount01 = apvts.getRawParameterValue("egVelAmount")->load();
+        egParams.attackSeconds    = morphed[morph::egAttack];
+        egParams.holdSeconds      = morphed[morph::egHold];
+        egParams.decaySeconds     = morphed[morph::egDecay];
+        egParams.sustain01        = morphed[morph::egSustain];
+        egParams.releaseSeconds   = morphed[morph::egRelease];
+        egParams.velocityAmount01 = morphed[morph::egVelAmount];
 
-        egParams.attackMode = (modztakt::eg::AttackMode) (int) apvts.getRawParameterValue("egAttackMode")->load();
+        egParams.attackMode = (modztakt::eg::AttackMode) (int) morphed[morph::egAttackMode];
         egParams.releaseLongMode = apvts.getRawParameterValue("egReleaseLong")->load() > 0.5f;
 
-        egParams.decayCurveMode   = (modztakt::eg::CurveShape) (int) apvts.getRawParameterValue("egDecayCurve")->load();
-        egParams.releaseCurveMode = (modztakt::eg::CurveShape) (int) apvts.getRawParameterValue("egReleaseCurve")->load();
+        egParams.decayCurveMode   = (modztakt::eg::CurveShape) (int) morphed[morph::egDecayCurve];
+        egParams.releaseCurveMode = (modztakt::eg::CurveShape) (int) morphed[morph::egReleaseCurve];
 
         egEngine.setParams(egParams);
 
@@ -260,29 +310,32 @@ public:
         {
             int channel = 0;        // 0=disabled
             int destChoice = 0;     // APVTS choice index
+            int port = 0;           // output port (0 = main)
         };
 
         std::array<EgRouteRuntime, maxRoutes> egRoutesRt {};
 
-        const int egMidiDestCount = (int) SyntaktParameterEgIndex.size();
-
         for (int r = 0; r < maxRoutes; ++r)
         {
-            const auto rs = juce::String(r);
+            const auto& ep = egRouteParams[(size_t) r];
 
-            const int chChoice = (int) apvts.getRawParameterValue("egRoute" + rs + "_channel")->load();
+            const int chChoice = (int) ep.channel->load();
             int ch = 0;  // 0=Disabled, -1=LFO, 1..16=MIDI channels
 
             if (chChoice == 0)      ch = 0;   // Disabled
             else                    ch = chChoice ;  // Ch 1..16 (choices 2..17 → 1..16)
 
-            int destChoice = (int) apvts.getRawParameterValue("egRoute" + rs + "_dest")->load(); // master index
+            int destChoice = (int) ep.dest->load(); // master index
+
+            // Choices past the map's EG destinations (smaller map loaded): route off
+            if (destChoice >= imap.getNumEgDestinations())
+                ch = 0;
+
+            destChoice = juce::jmax (0, destChoice);
 
-            // ALSO sanitize MIDI range to avoid out-of-bounds if automation wrote LFO indices:
-            const int midiCount = (int)SyntaktParameterEgIndex.size();
-            destChoice = juce::jlimit(0, midiCount - 1, destChoice);
+            const int port = (int) ep.port->load();
 
-            egRoutesRt[r] = { ch, destChoice };
+            egRoutesRt[r] = { ch, destChoice, port };
         }
 
         // automation safety: enforce EG route exclusivity deterministically
@@ -297,13 +350,19 @@ public:
             auto& cur = egRoutesRt[r];
             if (cur.channel == 0) continue;
 
-            const int globalParamIdx = SyntaktParameterEgIndex[cur.destChoice];
+            const int globalParamIdx = imap.egChoiceToIndex (cur.destChoice);
+
+            // Nobody else on this (ch, param): skip the port-aware checks
+            namespace Owner = modztakt::routing::Owner;
+            if (! routeOccupancy.isClaimed (cur.channel, globalParamIdx, Owner::anyLfo | Owner::egBefore (r)))
+                continue;
 
-            // conflict with LFO (same ch + same global param)
+            // conflict with LFO (same port + ch + same global param)
             bool conflictLfo = false;
-            for (int lr = 0; lr < maxRoutes; ++lr)
+            for (const int lr : lfoRoutes)
             {
-                if (lfoRoutes[lr].midiChannel == cur.channel && lfoRoutes[lr].parameterIndex == globalParamIdx)
+                if (lfoRoutes.port[(size_t) lr] == cur.port && lfoRoutes.channel[(size_t) lr] == cur.channel
+                    && lfoRoutes.paramIndex[(size_t) lr] == globalParamIdx)
                 {
                     conflictLfo = true;
                     break;
@@ -315,14 +374,14 @@ public:
                 continue;
             }
 
-            // conflict with earlier EG routes (same ch + same global param)
+            // conflict with earlier EG routes (same port + ch + same global param)
             for (int j = 0; j < r; ++j)
             {
                 const auto& prev = egRoutesRt[j];
                 if (prev.channel == 0) continue;
 
-                const int prevGlobalParam = SyntaktParameterEgIndex[prev.destChoice];
-                if (prev.channel == cur.channel && prevGlobalParam == globalParamIdx)
+                const int prevGlobalParam = imap.egChoiceToIndex (prev.destChoice);
+                if (prev.port == cur.port && prev.channel == cur.channel && prevGlobalParam == globalParamIdx)
                 {
                     cur.channel = 0;
                     break;
@@ -345,6 +404,10 @@ public:
                                  noteRestartToggleState,
                                  noteOffStopToggleState);
 
+        // Knob positions sent back by the synth (always tracked, used when "knobFollow" is on)
+        incomingControllers.process (midiIn, imap);
+        const bool knobFollow = apvts.getRawParameterValue ("knobFollow")->load() > 0.5f;
+
         applyPendingTransportEvents(shape, syncEnabled);
 
         const double bpm = updateTempoFromHostOrMidiClock(syncEnabled);
@@ -369,7 +432,7 @@ public:
                     requestLfoRestart.store(true, std::memory_order_release);
 
                     // if (!lfoActiveParam)
-                    //     uiRequestSetLfoActiveOn.store(true, std::memory_order_release);
+                    //     requestUiLfoActive (true);
                 }
             }
 
@@ -386,7 +449,7 @@ public:
                 lfoForcedActiveByPlay = false;
 
                 // Update UI param to OFF
-                // uiRequestSetLfoActiveOff.store(true, std::memory_order_release);
+                // requestUiLfoActive (false);
             }
 
             lastHostPlaying = hostPlaying;
@@ -399,10 +462,13 @@ public:
                 rateHz = modztakt::lfo::updateLfoRateFromBpm (rateHz, bpm, syncDivisionId);
                 // only request UI update if it actually changed enough
                 const float current = apvts.getRawParameterValue("lfoRateHz")->load();
-                if (std::abs((float)rateHz - current) > 0.0005f)
+                if (std::abs(current - lastPostedRateHz) <= 0.0005f)
+                    lastPostedRateHz = -1.0f;   // applied: post again if the slider moves away
+
+                if (std::abs((float)rateHz - current) > 0.0005f && std::abs((float)rateHz - lastPostedRateHz) > 0.0005f)
                 {
-                    uiRateHzToSet.store((float)rateHz, std::memory_order_relaxed);
-                    uiRequestSetRateHz.store(true, std::memory_order_release);
+                    lastPostedRateHz = (float) rateHz;
+                    postUiEvent (modztakt::ui::Event::Type::setLfoRate, false, rateHz);
                 }
         }
 
@@ -421,7 +487,7 @@ public:
             if (delayIsEnabled.load (std::memory_order_relaxed) && ch == delaySourceChannel)
             {
                 const int note = pending.pendingNoteNumber.load (std::memory_order_relaxed);
-                delayEngine.noteOn (note, velocity, blockStartMs);
+                delayEngine.noteOn (ch, note, velocity, blockStartMs);
             }
 
             // --- LFO Note Restart ---
@@ -440,8 +506,7 @@ public:
 
                     requestLfoRestart.store(true, std::memory_order_release);
 
-                    for (int i = 0; i < maxRoutes; ++i)
-                        lfoRoutes[i].totalPhaseAdvanced = 0.0;
+                    lfoRoutes.phaseAdvanced.fill (0.0);
                 }
             }
         }
@@ -461,7 +526,7 @@ public:
             if (delayIsEnabled.load (std::memory_order_relaxed) && ch == delaySourceChannel)
             {
                 const int note = pending.pendingNoteNumber.load (std::memory_order_relaxed);
-                delayEngine.noteOff (note, blockStartMs);
+                delayEngine.noteOff (ch, note, blockStartMs);
             }
         }
 
@@ -474,13 +539,10 @@ public:
                 lfoForcedActiveByNote = false;   // note forcing ends
                 lfoForcedActiveByPlay = false;   // note-off as ending forced transport-play too
                 
-                for (int i = 0; i < maxRoutes; ++i)
-                {
-                    lfoRouteSuppressedByNoteOff[i] = false;
-                    lfoRoutes[i].totalPhaseAdvanced = 0.0;
-                    lfoRoutes[i].hasFinishedOneShot = true;
-                    lfoRoutes[i].passedPeak = true;
-                }
+                lfoRoutes.phaseAdvanced.fill (0.0);
+                lfoRoutes.setAll (modztakt::lfo::RouteFlag::suppressed, false);
+                lfoRoutes.setAll (modztakt::lfo::RouteFlag::finished | modztakt::lfo::RouteFlag::passedPeak, true);
+
                 // If the Start button was only ON because noteRestart auto-enabled it,
                 // then noteOffStop must turn it back OFF.
                 if (lfoUiAutoOnByNote)
@@ -489,7 +551,7 @@ public:
 
                     // Only flip the UI param if the user didn't manually latch it ON.
                     // (If user later clicked Start manually, we consider it "real".)
-                    uiRequestSetLfoActiveOff.store(true, std::memory_order_release);
+                    requestUiLfoActive (false);
                 }
 
             }
@@ -504,29 +566,9 @@ public:
 
         // 4) Restart request
         if (requestLfoRestart.exchange(false, std::memory_order_acq_rel))
-        {
-            for (int i = 0; i < maxRoutes; ++i)
-            {
-                auto& route = lfoRoutes[i];
-
-                lfoPhase[i] = modztakt::lfo::getWaveformStartPhase(shape, route.bipolar);
+            lfoRoutes.restartAll (shape);
 
-                route.hasFinishedOneShot = false;
-                route.passedPeak = false;
-                route.totalPhaseAdvanced = 0.0;
-
-                lfoRouteSuppressedByNoteOff[i] = false;
-            }
-        }
-
-        double eg01 = 0.0;
-        bool egHasValue = false;
-
-        if (egParams.enabled)
-        {
-            egHasValue = egEngine.processBlock(audio.getNumSamples(), eg01);
-            eg01 = juce::jlimit(0.0, 1.0, eg01);
-        }
+        const bool egHasValue = core.processEnvelope (audio.getNumSamples(), egParams.enabled);
         
         // EG is forcing LFO if it's modulating depth or rate
         lfoForcedActiveByEg = egHasValue && (egToLfoDepthActive || egToLfoRateActive);
@@ -545,7 +587,7 @@ public:
             // If UI button currently OFF, we auto-turn it ON (for visual consistency)
             if (!lfoActiveParam)
             {
-                uiRequestSetLfoActiveOn.store(true, std::memory_order_release);
+                requestUiLfoActive (true);
                 lfoUiAutoOnByEg = true;
             }
         }
@@ -560,12 +602,12 @@ public:
             {
                 // Stop producing LFO immediately
                 lfoRuntimeMuted = true;
-                uiRequestSetLfoActiveOff.store(true, std::memory_order_release);
+                requestUiLfoActive (false);
 
                 // If the UI was ON only because EG auto-enabled it, turn it OFF now
                 if (lfoUiAutoOnByEg)
                 {
-                    //uiRequestSetLfoActiveOff.store(true, std::memory_order_release);
+                    //requestUiLfoActive (false);
                     lfoUiAutoOnByEg = false;
                 }
             }
@@ -610,11 +652,12 @@ public:
                                    shape,
                                    lfoActive,
                                    lfoRuntimeMuted,
-                                   lfoRoutes,
-                                   lfoPhase);
+                                   lfoRoutes);
 
         uiLfoIsRunning.store(shouldRunLfo && lfoActive && !lfoRuntimeMuted, std::memory_order_release);
 
+        lfoTrace.traceState (blockStartMs, packLfoTraceFlags (intent, shouldRunLfo, shouldShowUiOn));
+
         // SYNCHRONIZE UI BUTTON STATE
         // Detect state changes that require UI update
         const bool egWasDrivingLastBlock = egWasDrivingLfo;
@@ -623,7 +666,7 @@ public:
         // EG started driving: turn UI on if not already
         if (!egWasDrivingLastBlock && lfoForcedActiveByEg && !lfoActiveParam)
         {
-            uiRequestSetLfoActiveOn.store(true, std::memory_order_release);
+            requestUiLfoActive (true);
         }
 
         // EG stopped driving: turn UI off if nothing else is active
@@ -632,19 +675,19 @@ public:
             const bool anyOtherForce = lfoForcedActiveByNote || lfoForcedActiveByPlay;
             if (!lfoActiveParam && !anyOtherForce)
             {
-                uiRequestSetLfoActiveOff.store(true, std::memory_order_release);
+                requestUiLfoActive (false);
             }
         }
 
         // Update UI based on overall state if needed
         if (shouldShowUiOn && !lfoActiveParam)
         {
-            uiRequestSetLfoActiveOn.store(true, std::memory_order_release);
+            requestUiLfoActive (true);
         }
         else if (!shouldShowUiOn && lfoActiveParam && !userExplicitStop)
         {
             // Only auto-update UI to OFF if user didn't manually set it
-            uiRequestSetLfoActiveOff.store(true, std::memory_order_release);
+            requestUiLfoActive (false);
         }
 
         //======================================================================
@@ -656,17 +699,24 @@ public:
         delayIsEnabled.store((bool) delayParams.enabled, std::memory_order_release);
 
         // NOTE: the Params field is delayTimeMs; APVTS id is "delayRate"
-        delayParams.delayTimeMs = apvts.getRawParameterValue("delayRate")->load();
-        delayParams.feedback  = apvts.getRawParameterValue("feedback")->load();
-
-        const int delayEgShapeChoice = (int) apvts.getRawParameterValue ("delayEgShape")->load();
+        delayParams.delayTimeMs = morphed[morph::delayTime];
+        delayParams.feedback  = morphed[morph::delayFeedback];
+
+        // EG shaping target (0 = Off, 1 = volume, 2 = level) from the instrument map
+        // roles; shaping is off when the selected synth has no such parameter.
+        const int delayEgShapeParam = (int) apvts.getRawParameterValue ("delayEgShape")->load();
+        const int delayEgParamIdx   = (delayEgShapeParam > 0)
+                                      ? imap.getRoleIndex (delayEgShapeParam == 1 ? modztakt::instrument::Role::Volume
+                                                                                  : modztakt::instrument::Role::Level)
+                                      : -1;
+        const int delayEgShapeChoice = (delayEgParamIdx >= 0) ? delayEgShapeParam : 0;
 
         const bool delayEgPerNote = apvts.getRawParameterValue ("delayEgPerNote")->load() > 0.5f;
 
         // Sync override: delaySyncDivision choice index 0 = Free, 1..8 = divisions.
         // Uses the same `bpm` and `syncEnabled` variables already computed above for the LFO.
         // If no clock is running (bpm == 0 or syncEnabled == false) the slider value is kept.
-        const int delaySyncDivIdx = (int) apvts.getRawParameterValue("delaySyncDivision")->load();
+        const int delaySyncDivIdx = (int) morphed[morph::delaySyncDivision];
         if (delaySyncDivIdx > 0 && syncEnabled && bpm > 0.0)
         {
             // divisionId is 1-based inside DelayEngine, matching choice index directly.
@@ -676,11 +726,22 @@ public:
         // Read output route channels (0 = Disabled, 1..16 = Ch1..Ch16) and transpose.
         for (int r = 0; r < maxRoutes; ++r)
         {
-            const int chChoice = (int) apvts.getRawParameterValue("delayRoute" + juce::String(r) + "_channel")->load();
+            const auto& dp = delayRouteParams[(size_t) r];
+
+            const int chChoice = (int) dp.channel->load();
 
             delayParams.routeChannels[r]  = (chChoice == 0) ? 0 : chChoice;
 
-            delayParams.routeTranspose[r] = (int) apvts.getRawParameterValue("delayRoute" + juce::String(r) + "_transpose")->load();
+            delayParams.routeTranspose[r] = (int) dp.transpose->load();
+
+            delayParams.routePorts[r] = (int) dp.port->load();
+
+            // Per-route division: choice index 0 = Main (follow delayTimeMs), 1..8 = divisions.
+            // Without a running clock the route falls back to the main interval.
+            const int routeDivIdx = (int) dp.division->load();
+            delayParams.routeDelayTimeMs[r] = (routeDivIdx > 0 && syncEnabled && bpm > 0.0)
+                                            ? (float) modztakt::delay::divisionToMs(bpm, routeDivIdx)
+                                            : 0.0f;
         }
 
         // Step sequencer: the sequencer is "active" as long as at least one step
@@ -690,11 +751,34 @@ public:
         delayParams.seqEnabled = true;
         delayParams.seqTernary = apvts.getRawParameterValue ("delaySeqTernary")->load() > 0.5f;
         for (int s = 0; s < modztakt::delay::Params::maxSteps; ++s)
-            delayParams.seqSteps[s] =
-                apvts.getRawParameterValue ("delaySeqStep" + juce::String (s))->load() > 0.5f;
+            delayParams.seqSteps[s] = delaySeqStepParams[(size_t) s]->load() > 0.5f;
 
-        delayParams.panEnabled = apvts.getRawParameterValue ("delayPanEnabled")->load() > 0.5f;
-        delayParams.panWidth   = apvts.getRawParameterValue ("delayPanWidth")  ->load();        
+        const int delayPanParamIdx = imap.getRoleIndex (modztakt::instrument::Role::Pan);
+        delayParams.panEnabled = morphed[morph::delayPanEnabled] > 0.5f
+                              && delayPanParamIdx >= 0;
+        delayParams.panWidth   = morphed[morph::delayPanWidth];
+
+        // Multi-tap: each tap resolves its own interval — choice index 0 = Free
+        // (time slider), 1..8 = divisions, with the same clock fallback as above.
+        delayParams.multiTapEnabled = apvts.getRawParameterValue ("delayMultiTap")->load() > 0.5f;
+        if (delayParams.multiTapEnabled)
+        {
+            for (int t = 0; t < modztakt::delay::Params::maxTaps; ++t)
+            {
+                const auto& tp  = delayTapParams[(size_t) t];
+                auto&       tap = delayParams.taps[(size_t) t];
+
+                tap.channel   = (int) tp.channel->load();
+                tap.timeMs    = tp.timeMs->load();
+                tap.velScale  = tp.velocity->load();
+                tap.transpose = (int) tp.transpose->load();
+                tap.port      = (int) tp.port->load();
+
+                const int divIdx = (int) tp.division->load();
+                if (divIdx > 0 && syncEnabled && bpm > 0.0)
+                    tap.timeMs = (float) modztakt::delay::divisionToMs (bpm, divIdx);
+            }
+        }
 
         delayEngine.setParams(delayParams);
 
@@ -715,271 +799,86 @@ public:
         delayEngine.setParams (pne);
         
         //======================================================================
-        // LFO GENERATION
+        // GENERATION
+        // LFO routes, EG routes, EG → delay echo shaping, the echoes with their
+        // pan / EG primers and per-note EG, all through the engine core's send
+        // path (EngineCore.h).
         //======================================================================
 
-        if (lfoActive && !lfoRuntimeMuted)
-        {
-            // Apply EG to rate if routing is active
-            double effectiveRateHz = rateHz;
-            if (egToLfoRateActive && egHasValue)
-            {
-                // Scale rate by EG (0 to full rate)
-                effectiveRateHz = rateHz * eg01;
-            }
-
-            // Use effectiveRateHz instead of rateHz in phase calculation
-            const double phaseIncPerSample = effectiveRateHz / juce::jmax(1.0, getSampleRate());
-            
-
-            const int blockSize = audio.getNumSamples();
-
-            int stepSamples = (int) std::round (juce::jmax (1.0, getSampleRate())
-                                    / juce::jmax (0.001, effectiveRateHz) / 128.0);
-
-            stepSamples = juce::jlimit (8, 128, stepSamples);
-            stepSamples = juce::jlimit (1, juce::jmax (1, blockSize), stepSamples);
+        const bool lfoRunning = lfoActive && !lfoRuntimeMuted;
 
-            for (int offset = 0; offset < blockSize; offset += stepSamples)
-            {
-                const int stepThis = juce::jmin (stepSamples, blockSize - offset);
-                const double phaseIncThis = phaseIncPerSample * (double) stepThis;
-
-                for (int i = 0; i < maxRoutes; ++i)
-                {
-                    auto& route = lfoRoutes[i];
-
-                    if (route.midiChannel <= 0 || route.parameterIndex < 0)
-                        continue;
-
-                    if (route.oneShot && route.hasFinishedOneShot)
-                        continue;
-
-                    // If noteOffStop suppressed this route, skip it (unless it's the EG-protected route)
-                    if (lfoRouteSuppressedByNoteOff[i])
-                        continue;
-
-                    // Accumulate before advancing
-                    route.totalPhaseAdvanced += phaseIncThis;
-
-                    const bool wrapped = modztakt::lfo::advancePhase (lfoPhase[i], phaseIncThis);
-
-                    double shapeComputed = modztakt::lfo::computeWaveform (shape,
-                                                                          lfoPhase[i],
-                                                                          route.bipolar,
-                                                                          route.invertPhase,
-                                                                          random);
-
-                    // One-shot: complete after full cycle
-                    if (route.oneShot && route.totalPhaseAdvanced >= 1.0)
-                        route.hasFinishedOneShot = true;
-
-                    const auto& param = syntaktParameters[route.parameterIndex];
-
-                    // Apply EG modulation to depth or rate (globally)
-                    double depth = depthSliderValue;
-                    if (egToLfoDepthActive && egHasValue)
-                    {
-                        depth = depth * eg01;  // Scale depth by EG
-                    }
-                    
-                    // MIDI mapping
-                    int midiVal = 0;
-
-                    if (route.bipolar)
-                    {
-                        const int center = (param.minValue + param.maxValue) / 2;
-                        const int range  = (param.maxValue - param.minValue) / 2;
-                        midiVal = center + int (std::round (shapeComputed * depth * range));
-                    }
-                    else
-                    {
-                        const double uni = juce::jlimit (0.0, 1.0, (shapeComputed + 1.0) * 0.5);
-                        midiVal = param.minValue + int (std::round (uni * depth * (param.maxValue - param.minValue)));
-                    }
-
-                    midiVal = juce::jlimit (param.minValue, param.maxValue, midiVal);
-
-                    sendThrottledParamValueToBuffer (midi, i, route.midiChannel, param, midiVal, offset);
-
-                    if (scopeRoutesEnabled[i].load(std::memory_order_relaxed))
-                        scopeValues[i].store((float)(shapeComputed * depth), std::memory_order_relaxed);
-
-                    juce::ignoreUnused(wrapped);
-                }
-            }
+        modztakt::engine::Block block;
+        block.map        = &imap;
+        block.startMs    = blockStartMs;
+        block.numSamples = audio.getNumSamples();
 
-            // AUTO-STOP AFTER ONE-SHOT
-            {
-                bool anyEnabledRoute = false;
-                bool anyRouteStillRunning = false;
-
-                for (int i = 0; i < maxRoutes; ++i)
-                {
-                    const auto& r = lfoRoutes[i];
-
-                    if (r.midiChannel <= 0 || r.parameterIndex < 0)
-                        continue;
-
-                    anyEnabledRoute = true;
+        block.lfoRunning   = lfoRunning;
+        block.lfo          = { shape, rateHz, depthSliderValue, getSampleRate(), audio.getNumSamples() };
+        block.egToLfoRate  = egToLfoRateActive;
+        block.egToLfoDepth = egToLfoDepthActive;
 
-                    if (!r.oneShot || !r.hasFinishedOneShot)
-                    {
-                        anyRouteStillRunning = true;
-                        break;
-                    }
-                }
+        for (int r = 0; r < maxRoutes; ++r)
+        {
+            const auto& er = egRoutesRt[r];
 
-                if (anyEnabledRoute && !anyRouteStillRunning)
-                {
-                    lfoRuntimeMuted = true;
-                    lfoForcedActiveByNote = false;
-                    uiRequestSetLfoActiveOff.store(true, std::memory_order_release);
-                }
-            }
+            if (er.channel != 0)
+                block.egRoutes[(size_t) r] = { er.channel, imap.egChoiceToIndex (er.destChoice), er.port };
         }
 
-        // EG MIDI OUTPUT
-        if (egHasValue)
-        {
-           #if JUCE_DEBUG
-            const float egScopeValue = (float)(eg01 * 2.0 - 1.0);
-            scopeValues[2].store(egScopeValue, std::memory_order_relaxed);
-           #endif
+        block.delayEnabled       = delayParams.enabled;
+        block.delayEgParamIndex  = delayEgParamIdx;
+        block.delayEgPerNote     = pne.perNoteEg;
+        block.delayPanParamIndex = delayPanParamIdx;
 
-            for (int r = 0; r < maxRoutes; ++r)
-            {
-                const auto& er = egRoutesRt[r];
-                if (er.channel == 0) continue;
-
-                const int globalParamIdx = SyntaktParameterEgIndex[er.destChoice];
-                const int egValue = mapEgToMidi(eg01, globalParamIdx);
-                const auto& param = syntaktParameters[globalParamIdx];
-
-                // Use a unique routeIndex key per EG route (not 0x7FFF for all)
-                const int egRouteKey = (EG_ROUTE_KEY + r); // e.g. 0x7FFF, 0x8000, 0x8001
-                sendThrottledParamValueToBuffer(midi,
-                                                egRouteKey,
-                                                er.channel,
-                                                param,
-                                                egValue,
-                                                0);
-            }
-        }
+        block.changeThreshold = changeThreshold.load (std::memory_order_relaxed);
+        block.rateLimitMs     = msFloofThreshold.load (std::memory_order_relaxed);
+        block.curveTolerance  = curveToleranceSteps;
+        block.knobFollow      = knobFollow;
 
-        //======================================================================
-        // EG → DELAY ECHO SHAPING
-        // When delayEgShape > 0 and the EG is producing a value, we send the
-        // current EG level as a CC / NRPN volume message to every MIDI channel
-        // that currently has delay notes sounding.  This shapes the perceived
-        // amplitude envelope of each echo using the Syntakt's own amp-EG input.
-        //
-        // The note-off cap in DelayEngine limits echo duration to 70 % of the
-        // delay interval (or the original note duration if shorter), so the EG
-        // attack + hold + early-decay stages are what naturally get applied —
-        // matching the spirit of "EG shapes the echo, not the whole reverb tail".
-        //======================================================================
+        BlockSink sink { *this, out, blockStartMs };
+        core.render (block, sink);
 
-        if (delayEgShapeChoice > 0 && !delayEgPerNote && egHasValue && delayParams.enabled)
+        // AUTO-STOP AFTER ONE-SHOT
+        if (lfoRunning)
         {
-            // Resolve parameter without hardcoding CC numbers: use the same
-            // syntaktParameters[] table entry that the LFO/EG routes use.
-            const int paramIdx = (delayEgShapeChoice == 1)
-                                 ? delayEgVolumeParamIdx    // "Amp: Volume"
-                                 : delayEgTrackLvlParamIdx; // "Track Level"
+            namespace RouteFlag = modztakt::lfo::RouteFlag;
 
-            const auto& param   = syntaktParameters[paramIdx];
-            const int   egValue = mapEgToMidi (eg01, paramIdx);
+            const bool anyEnabledRoute = lfoRoutes.getNumActive() > 0;
+            bool anyRouteStillRunning = false;
 
-            // Ask the engine which channels have notes currently sounding.
-            std::array<bool, 17> soundingChannels {};
-            delayEngine.getActiveSoundingChannels (soundingChannels);
-
-            for (int ch = 1; ch <= 16; ++ch)
+            for (const int i : lfoRoutes)
             {
-                if (!soundingChannels[ch])
-                    continue;
-
-                // One throttle-map slot per channel so rate-limiting works per-channel.
-                sendThrottledParamValueToBuffer (midi,
-                                                 DELAY_EG_SHAPE_KEY_BASE + ch,
-                                                 ch,
-                                                 param,
-                                                 egValue,
-                                                 0 /*sampleOffset*/);
+                if (! lfoRoutes.has (i, RouteFlag::oneShot) || ! lfoRoutes.has (i, RouteFlag::finished))
+                {
+                    anyRouteStillRunning = true;
+                    break;
+                }
             }
-        }
-
-        //======================================================================
-        // DELAY MIDI OUTPUT
-        // Must run every block (engine advances its internal clock even when idle)
-        //======================================================================
 
-        // Auto-pan: inject pan CC before each echo note-on so the synth's pan
-        // register is set before the note event arrives (same prefire pattern as
-        // the per-note EG CC). Pan is not throttled — it must fire every echo.
-        if (delayParams.panEnabled && delayParams.panWidth > 0.0f)
-        {
-            std::vector<modztakt::delay::Engine::PanPrefire> panPrefires;
-            delayEngine.collectPanPrefires (blockStartMs, audio.getNumSamples(), panPrefires);
-            const auto& panParam = syntaktParameters[delayPanParamIdx];
-            for (const auto& pf : panPrefires)
+            if (anyEnabledRoute && !anyRouteStillRunning)
             {
-                if (panParam.isCC)
-                    midi.addEvent (
-                        juce::MidiMessage::controllerEvent (pf.channel, panParam.ccNumber, pf.panCcValue),
-                        pf.sampleOffset);
-                // (NRPN path omitted — "Amp: Pan" is a CC in SyntaktParameterTable.h)
+                lfoRuntimeMuted = true;
+                lfoForcedActiveByNote = false;
+                requestUiLfoActive (false);
             }
         }
 
-        delayEngine.processBlock (audio.getNumSamples(), blockStartMs, midi);
+        // DIN bandwidth gates + hand the extra port buffers to their devices
+        outputPorts.endBlock (midi, blockStartMs, audio.getNumSamples());
 
-        //======================================================================
-        // PER-NOTE EG OUTPUT
-        //
-        // When "delayEgPerNote" is true AND a destination is selected, each echo
-        // has its own EG retriggered at its note-on.  We mirror the UI rule:
-        // egPerNoteBtn is only visible when delayEgShape > 0, so the processor
-        // matches by also requiring delayEgShapeChoice > 0 here.
-        //
-        // NOTE: delayEgShapeChoice and delayEgPerNote are already declared above
-        // in the "EG → DELAY ECHO SHAPING" block (section 6) — do not re-declare.
-        //======================================================================
-        if (delayEgPerNote && delayEgShapeChoice > 0 && delayParams.enabled)
-        {
-            const auto& pnEgOut = delayEngine.getPerNoteEgOutput();
-
-            if (pnEgOut.hasAnyValue)
-            {
-                const int  paramIdx = (delayEgShapeChoice == 1)
-                                      ? delayEgVolumeParamIdx
-                                      : delayEgTrackLvlParamIdx;
-                const auto& param   = syntaktParameters[paramIdx];
+        // Flags moved later in the block (note-off stop, one-shot auto-stop)
+        lfoTrace.traceState (blockStartMs, packLfoTraceFlags (intent, shouldRunLfo, shouldShowUiOn));
 
-                for (int ch = 1; ch <= 16; ++ch)
-                {
-                    const float eg01 = pnEgOut.maxEg01[ch];
-                    if (eg01 <= 0.0f)
-                        continue;
-
-                    const int midiVal = mapEgToMidi (static_cast<double> (eg01), paramIdx);
-
-                    // Throttle key range: DELAY_EG_SHAPE_KEY_BASE + 0x20 + ch
-                    // (distinct from the global EG shaping keys at +0x00..+0x10).
-                    sendThrottledParamValueToBuffer (midi,
-                                                     DELAY_EG_SHAPE_KEY_BASE + 0x20 + ch,
-                                                     ch,
-                                                     param,
-                                                     midiVal,
-                                                     0 /*sampleOffset*/);
-                }
-            }
-        }
+        publishUiChanges();
 
         // Advance global time after processing the block
         timeMs = blockStartMs + blockDurationMs;
 
+        // Scope: the values sent are held up to here
+        for (size_t r = 0; r < scopeStreams.size(); ++r)
+            if (scopeRoutesEnabled[r].load (std::memory_order_relaxed))
+                scopeStreams[r].setTime (timeMs);
+
     }
 
     //==============================================================================
@@ -997,25 +896,69 @@ public:
     inline double getTailLengthSeconds() const override { return 0.0; }
 
     //==============================================================================
-    inline int getNumPrograms() override                               { return 1; }
-    inline int getCurrentProgram() override                            { return 0; }
-    inline void setCurrentProgram (int) override                       {}
-    inline const juce::String getProgramName (int) override            { return {}; }
-    inline void changeProgramName (int, const juce::String&) override  {}
+    // Programs are the preset bank slots (see PresetBank.h)
+    inline int getNumPrograms() override                                          { return modztakt::presets::numSlots; }
+    inline int getCurrentProgram() override                                       { return juce::jmax (0, presetBank.getCurrentProgram()); }
+    inline void setCurrentProgram (int index) override                            { presetBank.requestProgram (index); }   // any thread: an atomic, not uiCommands
+    inline const juce::String getProgramName (int index) override                 { return presetBank.getSlotName (index); }
+    inline void changeProgramName (int index, const juce::String& name) override  { presetBank.rename (index, name); }
 
     //==============================================================================
     inline void getStateInformation (juce::MemoryBlock& destData) override
     {
-        // Save APVTS state
-        if (auto xml = apvts.copyState().createXml())
-            copyXmlToBinary (*xml, destData);
+        // Parameters + engine state (output port devices, instrument map), see PluginState.h
+        stateCodec.write (destData, makeEngineState());
     }
 
     inline void setStateInformation (const void* data, int sizeInBytes) override
     {
-        // Restore APVTS state
+        juce::ValueTree engineState;
+
+        if (stateCodec.read (data, sizeInBytes, engineState))
+            applyEngineState (engineState);
+        else
+            setStateFromXml (data, sizeInBytes);   // sessions saved before the binary format
+    }
+
+    // XML state (the format before PluginState.h): still loaded, and kept for the
+    // benchmark.  Same content as the binary state: parameters + engine nodes.
+    inline void getStateAsXml (juce::MemoryBlock& destData)
+    {
+        auto state = apvts.copyState();
+        saveEngineState (state);
+
+        if (auto xml = state.createXml())
+            copyXmlToBinary (*xml, destData);
+    }
+
+    inline void setStateFromXml (const void* data, int sizeInBytes)
+    {
         if (auto xml = getXmlFromBinary (data, sizeInBytes))
+        {
             apvts.replaceState (juce::ValueTree::fromXml (*xml));
+            applyEngineState (apvts.state);
+        }
+    }
+
+    // Binary vs XML state, per save / load round trip (Settings menu)
+    inline juce::String runStateBenchmark (int iterations)
+    {
+        juce::MemoryBlock saved;
+        getStateInformation (saved);   // restored afterwards
+
+        const auto binary = modztakt::state::benchmark (
+            [this] (juce::MemoryBlock& b) { getStateInformation (b); },
+            [this] (const juce::MemoryBlock& b) { setStateInformation (b.getData(), (int) b.getSize()); },
+            iterations);
+
+        const auto xml = modztakt::state::benchmark (
+            [this] (juce::MemoryBlock& b) { getStateAsXml (b); },
+            [this] (const juce::MemoryBlock& b) { setStateFromXml (b.getData(), (int) b.getSize()); },
+            iterations);
+
+        setStateInformation (saved.getData(), (int) saved.getSize());
+
+        return "Binary: " + binary + "\nXML: " + xml;
     }
 
     // Helper to convert APVTS choice index to changeThreshold value
@@ -1046,6 +989,13 @@ public:
         return (index >= 0 && index < 7) ? values[index] : 0.0;
     }
 
+    // Helper to convert APVTS choice index to curve tolerance (7-bit steps)
+    static inline double getCurveToleranceFromIndex(int index)
+    {
+        const double values[] = {0.0, 0.5, 1.0, 2.0, 4.0};
+        return (index >= 0 && index < 5) ? values[index] : 0.0;
+    }
+
     // Helper to convert msFloofThreshold value to APVTS choice index
     static inline int getIndexFromMsFloofThreshold(double threshold)
     {
@@ -1063,46 +1013,62 @@ public:
     // PUBLIC INTERFACE FOR UI
     //==============================================================================
 public:
+    // Declared before apvts: parameter value texts read the selected map.
+    modztakt::instrument::MapLibrary instrumentMaps;
+
     APVTS apvts;
 
-    // LFO Start/Stop label refresh
+    // Current LFO state / tempo: the editor's starting point, and its resync
+    // when events were dropped (updates come through getUiEvents())
     bool isLfoRunningForUi() const noexcept
     {
         return uiLfoIsRunning.load(std::memory_order_acquire);
     }
 
-    std::atomic<bool> uiRequestSetLfoActiveOn { false };
-    std::atomic<bool> uiRequestSetLfoActiveOff { false };
-
     // Scope accessors for UI (safe: atomics)
-    inline auto& getScopeValues() noexcept { return scopeValues; }
+    inline auto& getScopeStreams() noexcept { return scopeStreams; }
     inline auto& getScopeRoutesEnabled() noexcept { return scopeRoutesEnabled; }
 
     double getBpmForUi() const noexcept { return bpmForUi.load(std::memory_order_relaxed); }
 
-    std::atomic<bool>  uiRequestSetRateHz { false };
-    std::atomic<float> uiRateHzToSet { 0.0f };
+    // What changed for the UI since the editor's last refresh (see UiRefresh.h)
+    inline modztakt::ui::ChangeMask& getUiChanges() noexcept { return uiChanges; }
+
+    // Processor ⇄ editor queues (see UiEventQueue.h)
+    inline modztakt::ui::EventQueue&   getUiEvents() noexcept   { return uiEvents; }
+    inline modztakt::ui::CommandQueue& getUiCommands() noexcept { return uiCommands; }
 
     // Settings parameters (accessed by UI and audio thread)
     std::atomic<int> changeThreshold { 0 };
     std::atomic<double> msFloofThreshold { 0.0 };
+    double curveToleranceSteps = 0.0;   // "midiCurveTolerance", read each block (audio thread)
 
     inline APVTS&       getAPVTS()       noexcept { return apvts; }
 
+    // Standalone only: MIDI-only timing engine (see MidiTimingEngine.h)
+    inline modztakt::standalone::MidiTimingEngine& getMidiTimingEngine() noexcept { return midiTimingEngine; }
+
+    // Extra MIDI output ports (see MidiOutputPorts.h)
+    inline modztakt::ports::OutputPorts& getOutputPorts() noexcept { return outputPorts; }
+
     inline double getSampleRateCached() const noexcept { return cachedSampleRate; }
     inline int    getBlockSizeCached()  const noexcept { return cachedBlockSize; }
 
-    // EG filtered destinations (MIDI-capable only)
-    static inline juce::Array<int> SyntaktParameterEgIndex = []()
-    {
-        juce::Array<int> indices;
-        for (int i = 0; i < (int) juce::numElementsInArray(syntaktParameters); ++i)
-            if (syntaktParameters[i].egDestination)
-                indices.add(i);
-        return indices;
-    }();
+    // Preset bank recalled by program change (see PresetBank.h)
+    inline modztakt::presets::Bank& getPresetBank() noexcept { return presetBank; }
 
-    static inline int egMidiDestCount() { return SyntaktParameterEgIndex.size(); }
+    // A/B snapshot morph (see SnapshotMorph.h)
+    inline modztakt::morph::Snapshots& getMorphSnapshots() noexcept { return morphSnapshots; }
+
+    // LFO run-state trace (see LfoTrace.h)
+    inline modztakt::trace::Recorder& getLfoTrace() noexcept { return lfoTrace; }
+
+    // Echoes still scheduled in the delay engine (audio thread, or between blocks)
+    inline int getPendingEchoCount() const noexcept { return core.getPendingEchoCount(); }
+
+    // Instrument maps (see InstrumentMap.h); getInstrumentMap() is the selected one.
+    inline modztakt::instrument::MapLibrary& getInstrumentMaps() noexcept              { return instrumentMaps; }
+    inline const modztakt::instrument::InstrumentMap& getInstrumentMap() const noexcept { return instrumentMaps.getSelected(); }
 
     //==============================================================================
     // PRIVATE IMPLEMENTATION
@@ -1115,7 +1081,9 @@ private:
     // Helpers for per-sample scheduling (updated each processBlock)
     double timeMs = 0.0;
 
-    static constexpr int maxRoutes = 3;
+    static constexpr int maxLfoRoutes   = modztakt::lfo::maxRoutes;
+    static constexpr int maxRoutes      = 3;   // EG / delay routes
+    static constexpr int numScopeRoutes = maxLfoRoutes;   // scope traces: one per LFO route
 
     // LFO state flags
     bool lfoRuntimeMuted = false;
@@ -1141,91 +1109,242 @@ private:
     std::atomic<bool>   hostTransportValid { false };
     bool lastHostPlaying = false; // audio thread only
 
+    // Plugin state: parameter table + engine extension block (see PluginState.h)
+    modztakt::state::Codec stateCodec { apvts };
+
+    inline juce::ValueTree makeEngineState() const
+    {
+        juce::ValueTree state ("ENGINE");
+        saveEngineState (state);
+        return state;
+    }
+
+    // Engine nodes, shared by the binary (makeEngineState) and XML states
+    inline void saveEngineState (juce::ValueTree& state) const
+    {
+        outputPorts.saveToState (state);
+        instrumentMaps.saveToState (state);
+        presetBank.saveToState (state);
+        morphSnapshots.saveToState (state);
+    }
+
+    inline void applyEngineState (const juce::ValueTree& state)
+    {
+        outputPorts.loadFromState (state);
+        instrumentMaps.loadFromState (state);
+        presetBank.loadFromState (state);
+        morphSnapshots.loadFromState (state);
+        uiChanges.mark (modztakt::ui::Changed::instrumentMap);
+    }
+
+    // Preset bank: decoded presets, recalled at block boundaries
+    modztakt::presets::Bank presetBank { apvts };
+
+    // A/B snapshots feeding the engines' Params while the morph is on
+    modztakt::morph::Snapshots morphSnapshots { apvts };
+
+    // Start of block: queue the last matching program change of the block,
+    // then recall whatever is pending (MIDI, host or UI).
+    inline void recallPendingPreset (const juce::MidiBuffer& midiIn, const modztakt::ports::PortBuffers& out)
+    {
+        const int pcChannel = (int) apvts.getRawParameterValue ("presetProgramChannel")->load();
+
+        if (pcChannel != modztakt::presets::programChannelOff)
+        {
+            for (const auto meta : midiIn)
+            {
+                const auto msg = meta.getMessage();
+
+                if (msg.isProgramChange()
+                    && (pcChannel == modztakt::presets::programChannelOmni || msg.getChannel() == pcChannel - 1))
+                    presetBank.requestProgram (msg.getProgramChangeNumber());
+            }
+        }
+
+        const auto* preset = presetBank.applyPending();
+
+        if (preset == nullptr || ! preset->resetEngine)
+            return;
+
+        // Fresh start for the new song: LFO phases (restart request below),
+        // pending echoes (sounding ones get their note-off), EG.
+        delayEngine.clearEchoes (out);
+        egEngine.reset();
+        requestLfoRestart.store (true, std::memory_order_release);
+    }
+
+    // UI change mask (audio thread marks, editor takes)
+    modztakt::ui::ChangeMask uiChanges;
+
+    // Processor ⇄ editor queues: audio thread produces events, consumes commands
+    modztakt::ui::EventQueue   uiEvents;
+    modztakt::ui::CommandQueue uiCommands;
+
+    bool   lastPublishedLfoRunning = false;  // audio thread only
+    double lastPublishedBpm = 0.0;           // audio thread only
+    int    requestedLfoActive = -1;          // Start/Stop request not yet applied (-1 = none)
+    float  lastPostedRateHz = -1.0f;         // synced rate last sent to the editor
+
+    inline void postUiEvent (modztakt::ui::Event::Type type, bool flag = false, double value = 0.0, int index = 0) noexcept
+    {
+        uiEvents.push ({ type, 0, index, flag, value });
+        uiChanges.mark (modztakt::ui::Changed::events);
+    }
+
+    // One request per change: repeated until the parameter follows, it would
+    // fill the queue between two UI ticks.
+    inline void requestUiLfoActive (bool on) noexcept
+    {
+        if (requestedLfoActive == (on ? 1 : 0))
+            return;
+
+        requestedLfoActive = on ? 1 : 0;
+        postUiEvent (modztakt::ui::Event::Type::setLfoActive, on);
+    }
+
+    inline void applyUiCommands() noexcept
+    {
+        uiCommands.drain ([this] (const modztakt::ui::Command& c)
+        {
+            switch (c.type)
+            {
+                case modztakt::ui::Command::Type::resync:
+                    // Forget what was posted: the end of this block posts it again
+                    lastPublishedLfoRunning = ! uiLfoIsRunning.load (std::memory_order_relaxed);
+                    lastPublishedBpm = -1.0;
+                    requestedLfoActive = -1;
+                    lastPostedRateHz = -1.0f;
+                    break;
+            }
+        });
+    }
+
+    // End of block: post the state the UI shows, only on change.
+    inline void publishUiChanges() noexcept
+    {
+        const bool running = uiLfoIsRunning.load (std::memory_order_relaxed);
+        if (running != lastPublishedLfoRunning)
+        {
+            lastPublishedLfoRunning = running;
+            postUiEvent (modztakt::ui::Event::Type::lfoRunning, running);
+        }
+
+        const double bpm = bpmForUi.load (std::memory_order_relaxed);
+        if (std::abs (bpm - lastPublishedBpm) > 0.05)
+        {
+            lastPublishedBpm = bpm;
+            postUiEvent (modztakt::ui::Event::Type::tempo, false, bpm);
+        }
+    }
+
     // Pending note flags (replaces GlobalMidiCallback storage)
     PendingMidiFlags pending;
 
     // MIDI clock (same class as you used in MainComponent)
     MidiClockHandler midiClock;
 
-    //
-    static constexpr int EG_ROUTE_KEY = 0x7FFF;  // Named constant for magic number
-
-    // Delay EG-shaping uses one throttle slot per MIDI channel (channels 1..16).
-    // Range 0x9001..0x9010 — no overlap with LFO (0..2) or EG routes (0x7FFF..0x8001).
-    static constexpr int DELAY_EG_SHAPE_KEY_BASE = 0x9001;
-    
-    std::array<RouteSnapshot, maxRoutes> lastRouteSnapshot {};
-
-    std::array<LfoRoute, maxRoutes> lfoRoutes {};
-    std::array<double,   maxRoutes> lfoPhase  {};
+    // LFO, EG and delay engines with their send path (EngineCore.h); the
+    // instrument map comes with each block.
+    modztakt::engine::Core core { nullptr };
+    static_assert (modztakt::engine::maxEgRoutes == maxRoutes, "EG routes: one per egRoute parameter set");
 
-    // When noteOffStop happens while EG is protecting one route,
-    // we stop the other routes without killing the EG-protected one.
-    std::array<bool, maxRoutes> lfoRouteSuppressedByNoteOff { false, false, false };
+    // LFO routes (struct-of-arrays + active list) and their APVTS reader.
+    // RouteFlag::suppressed: when noteOffStop happens while EG is protecting one
+    // route, we stop the other routes without killing the EG-protected one.
+    LfoRouteTable& lfoRoutes = core.getLfoRoutes();
+    modztakt::lfo::RouteSync<maxLfoRoutes> lfoRouteSync { apvts };
 
     bool lfoUiAutoOnByNote = false;   // UI Start was turned ON by noteRestart (not by the user)
     bool lfoUiAutoOnByEg = false;     // UI Start was turned ON by EG forcing
     bool egWasForcingLfo = false;     // previous-block EG forcing state (edge detector)
 
-    juce::Random random;
+    // Start/stop state machine trace: a record per flag change
+    modztakt::trace::Recorder lfoTrace;
+
+    inline uint32_t packLfoTraceFlags (const LfoRunIntent& intent, bool shouldRun, bool showUiOn) const noexcept
+    {
+        namespace Flag = modztakt::trace::Flag;
+
+        auto bit = [] (bool b, uint32_t f) { return b ? f : 0u; };
+
+        return bit (intent.userButtonOn,      Flag::userButtonOn)
+             | bit (intent.userExplicitStop,  Flag::userExplicitStop)
+             | bit (lfoForcedActiveByNote,    Flag::noteForce)
+             | bit (lfoForcedActiveByPlay,    Flag::playForce)
+             | bit (lfoForcedActiveByEg,      Flag::egForce)
+             | bit (intent.transportGateOpen, Flag::transportGate)
+             | bit (intent.syncEnabled,       Flag::syncEnabled)
+             | bit (shouldRun,                Flag::shouldRun)
+             | bit (showUiOn,                 Flag::showUiOn)
+             | bit (lfoActive,                Flag::lfoActive)
+             | bit (lfoRuntimeMuted,          Flag::runtimeMuted)
+             | bit (lfoUiAutoOnByNote,        Flag::uiAutoOnByNote)
+             | bit (lfoUiAutoOnByEg,          Flag::uiAutoOnByEg)
+             | bit (egWasForcingLfo,          Flag::egWasForcing);
+    }
 
     std::atomic<bool> requestLfoRestart { false };
 
     // EG
-    modztakt::eg::Engine egEngine;
+    modztakt::eg::Engine& egEngine = core.getEnvelope();
     std::atomic<bool> egIsEnabled { false };
 
     bool egWasDrivingLfo = false;  // audio thread only, edge detector for UI
 
     // Delay
-    modztakt::delay::Engine delayEngine;
+    modztakt::delay::Engine& delayEngine = core.getDelay();
     std::atomic<bool> delayIsEnabled { false };
 
-    // Resolved once at class-init time: index into syntaktParameters[] for the two
-    // parameters used by the Delay EG-shaping feature.  Using a name-based lookup
-    // avoids hardcoding CC numbers and automatically picks up NRPN if the table
-    // entry is ever switched to NRPN for higher resolution.
+    // Multi-tap delay parameter pointers (resolved in the constructor)
+    struct DelayTapParamPtrs
+    {
+        std::atomic<float>* channel   = nullptr;
+        std::atomic<float>* division  = nullptr;
+        std::atomic<float>* timeMs    = nullptr;
+        std::atomic<float>* velocity  = nullptr;
+        std::atomic<float>* transpose = nullptr;
+        std::atomic<float>* port      = nullptr;
+    };
+    std::array<DelayTapParamPtrs, modztakt::delay::Params::maxTaps> delayTapParams {};
 
-    static inline int findSyntaktParamIndexByName (const char* name) noexcept
+    struct EgRouteParamPtrs
     {
-        for (int i = 0; i < (int) juce::numElementsInArray (syntaktParameters); ++i)
-            if (juce::String (syntaktParameters[i].name) == name)
-                return i;
-        jassertfalse; // entry not found — check spelling against SyntaktParameterTable.h
-        return 0;
-    }
+        std::atomic<float>* channel = nullptr;
+        std::atomic<float>* dest    = nullptr;
+        std::atomic<float>* port    = nullptr;
+    };
+    std::array<EgRouteParamPtrs, maxRoutes> egRouteParams {};
 
-    // "Amp: Volume"  → CC 7 (or NRPN, depending on the table entry)
-    static inline const int delayEgVolumeParamIdx = findSyntaktParamIndexByName("Amp: Volume");
+    struct DelayRouteParamPtrs
+    {
+        std::atomic<float>* channel   = nullptr;
+        std::atomic<float>* transpose = nullptr;
+        std::atomic<float>* port      = nullptr;
+        std::atomic<float>* division  = nullptr;
+    };
+    std::array<DelayRouteParamPtrs, maxRoutes> delayRouteParams {};
 
-    // "Track Level"  → CC 95 (or NRPN, depending on the table entry)
-    static inline const int delayEgTrackLvlParamIdx = findSyntaktParamIndexByName ("Track Level");
+    std::array<std::atomic<float>*, modztakt::delay::Params::maxSteps> delaySeqStepParams {};
 
-    // "Amp: Pan"  → bipolar CC (centre = 64); used by the Delay auto-pan feature.
-    static inline const int delayPanParamIdx = findSyntaktParamIndexByName ("Amp: Pan");
+    // Last CC / NRPN values received from the synth (see IncomingControllers.h)
+    modztakt::incoming::ControllerTracker& incomingControllers = core.getIncomingControllers();
 
-    // Throttle state for outgoing MIDI
-    std::unordered_map<int, int>    lastSentValuePerParam;
-    std::unordered_map<int, double> lastSendTimePerParam;
+    // (channel, parameter) → routes driving it; audio thread only (see RouteOccupancy.h)
+    modztakt::routing::Occupancy routeOccupancy { apvts, instrumentMaps.getSelected() };
 
     // Scope (shared audio->UI)
-    std::array<std::atomic<float>, maxRoutes> scopeValues { 0.0f, 0.0f, 0.0f };
-    std::array<std::atomic<bool>,  maxRoutes> scopeRoutesEnabled { false, false, false };
+    std::array<modztakt::scope::Stream, numScopeRoutes> scopeStreams;
+    std::array<std::atomic<bool>,  numScopeRoutes> scopeRoutesEnabled {};
+
+    // Extra MIDI outputs; route events are written into per-port buffers
+    modztakt::ports::OutputPorts outputPorts;
+
+    // Standalone MIDI-only timing thread (idle unless started from the settings menu)
+    modztakt::standalone::MidiTimingEngine midiTimingEngine { *this };
 
-    static inline const juce::StringArray SyntaktParameterEG = []()
-    {
-        juce::StringArray filteredEgDest;
-        for (int i = 0; i < (int) juce::numElementsInArray(syntaktParameters); ++i)
-        {
-            if (syntaktParameters[i].egDestination)
-                filteredEgDest.add(syntaktParameters[i].name);
-        }
-        return filteredEgDest;
-    }();
-    
     //==============================================================================
 
-    inline static APVTS::ParameterLayout createParameterLayout()
+    inline static APVTS::ParameterLayout createParameterLayout (const modztakt::instrument::MapLibrary& maps)
     {
         std::vector<std::unique_ptr<juce::RangedAudioParameter>> p;
 
@@ -1286,14 +1405,29 @@ private:
         p.push_back (std::make_unique<juce::AudioParameterInt>("noteSourceChannel", "Note Restart Channel", 1, 16, 1));
         p.push_back (std::make_unique<juce::AudioParameterBool>("noteOffStop", "Stop on Note Off", false));
 
+        // Modulate around the knob positions received from the synth
+        p.push_back (std::make_unique<juce::AudioParameterBool>("knobFollow", "Modulate Around Knob", false));
+
         // Scope view
         p.push_back (std::make_unique<juce::AudioParameterBool>("scope", "Scope View", false));
 
         //LFO routes
-        // Build the syntakt parameter name list for combo boxes
-        juce::StringArray syntaktParamNames;
-        for (int i = 0; i < (int) juce::numElementsInArray(syntaktParameters); ++i)
-            syntaktParamNames.add (syntaktParameters[i].name);
+        // Parameter / EG destination choices are fixed-size slots so any
+        // instrument map fits; the host shows the selected map's names.
+        juce::StringArray mapSlotNames;
+        for (int i = 0; i < modztakt::instrument::maxParams; ++i)
+            mapSlotNames.add ("Parameter " + juce::String (i + 1));
+
+        auto mapParamText = [&maps] (bool egDestinations)
+        {
+            return juce::AudioParameterChoiceAttributes().withStringFromValueFunction (
+                [&maps, egDestinations] (int index, int)
+                {
+                    const auto& map = maps.getSelected();
+                    const auto& names = egDestinations ? map.getEgDestinationNames() : map.getParameterNames();
+                    return juce::isPositiveAndBelow (index, names.size()) ? names[index] : juce::String ("-");
+                });
+        };
 
         // LFO Route channel choices
         auto makeLFOChannelChoices = []()
@@ -1305,7 +1439,7 @@ private:
             return s;
         };
 
-        for (int r = 0; r < maxRoutes; ++r)
+        for (int r = 0; r < maxLfoRoutes; ++r)
         {
             const auto rs = juce::String(r);
 
@@ -1321,8 +1455,9 @@ private:
             p.push_back (std::make_unique<juce::AudioParameterChoice>(
                 "route" + rs + "_param",
                 "Route " + rs + " Parameter",
-                syntaktParamNames,
-                0 // default first param
+                mapSlotNames,
+                0, // default first param
+                mapParamText (false)
             ));
 
             p.push_back (std::make_unique<juce::AudioParameterBool>(
@@ -1342,6 +1477,14 @@ private:
                 "Route " + rs + " OneShot",
                 false
             ));
+
+            // output port: 0=Main, 1..3=extra ports (MidiOutputPorts.h)
+            p.push_back (std::make_unique<juce::AudioParameterChoice>(
+                "route" + rs + "_port",
+                "Route " + rs + " Output Port",
+                modztakt::ports::makePortChoices(),
+                0
+            ));
         }
 
         // EG
@@ -1430,12 +1573,20 @@ private:
                 0   // default: all eg routes Disabled
             ));
 
-            // Destination choice is Ch_x: uses SyntaktParameterEG (EG destinations )
+            // Destination choice: index into the map's EG destinations
             p.push_back (std::make_unique<juce::AudioParameterChoice>(
                 "egRoute" + rs + "_dest",
                 "EG Route " + rs + " Destination",
-                SyntaktParameterEG,
-                0 
+                mapSlotNames,
+                0,
+                mapParamText (true)
+            ));
+
+            p.push_back (std::make_unique<juce::AudioParameterChoice>(
+                "egRoute" + rs + "_port",
+                "EG Route " + rs + " Output Port",
+                modztakt::ports::makePortChoices(),
+                0
             ));
         }
 
@@ -1511,6 +1662,23 @@ private:
                 "Delay Route " + juce::String (r) + " Transpose",
                 -24, 24, 0
             ));
+
+            // Per-route sync division  (0 = Main: follow the main delay interval)
+            p.push_back (std::make_unique<juce::AudioParameterChoice>(
+                "delayRoute" + juce::String (r) + "_division",
+                "Delay Route " + juce::String (r) + " Sync Division",
+                juce::StringArray { "Main",
+                                    "1/1", "1/2", "1/4", "1/8", "1/16", "1/32",
+                                    "1/8 dot", "1/16 dot" },
+                0
+            ));
+
+            p.push_back (std::make_unique<juce::AudioParameterChoice>(
+                "delayRoute" + juce::String (r) + "_port",
+                "Delay Route " + juce::String (r) + " Output Port",
+                modztakt::ports::makePortChoices(),
+                0
+            ));
         }
 
         // ── Step sequencer ────────────────────────────────────────────────────────
@@ -1537,6 +1705,56 @@ private:
             "delayPanWidth", "Delay Pan Width",
             juce::NormalisableRange<float> (0.0f, 1.0f), 0.5f));
 
+        // ── Multi-tap ─────────────────────────────────────────────────────────
+        // When enabled, every input note fires one echo per active tap instead of
+        // the feedback chain across delay routes.
+        p.push_back (std::make_unique<juce::AudioParameterBool> (
+            "delayMultiTap", "Delay Multi-Tap", false));
+
+        for (int t = 0; t < modztakt::delay::Params::maxTaps; ++t)
+        {
+            const auto ts = "delayTap" + juce::String (t);
+            const auto tn = "Delay Tap " + juce::String (t + 1);
+
+            p.push_back (std::make_unique<juce::AudioParameterChoice> (
+                ts + "_channel", tn + " Channel",
+                makeDelayChannelChoices(),
+                0  // default: Disabled
+            ));
+
+            // Same choice list as delaySyncDivision: 0 = Free (use the time slider)
+            p.push_back (std::make_unique<juce::AudioParameterChoice> (
+                ts + "_division", tn + " Sync Division",
+                juce::StringArray { "Free",
+                                    "1/1", "1/2", "1/4", "1/8", "1/16", "1/32",
+                                    "1/8 dot", "1/16 dot" },
+                0
+            ));
+
+            // Tap time  10 ms → 4 000 ms, default spreads taps 125 ms apart
+            p.push_back (std::make_unique<juce::AudioParameterFloat> (
+                ts + "_time", tn + " Time",
+                juce::NormalisableRange<float> (10.0f, 4000.0f, 1.0f, 0.45f),
+                125.0f * (float) (t + 1)));
+
+            // Velocity scale relative to the input note, default fades out
+            p.push_back (std::make_unique<juce::AudioParameterFloat> (
+                ts + "_velocity", tn + " Velocity",
+                juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
+                1.0f - 0.1f * (float) t));
+
+            p.push_back (std::make_unique<juce::AudioParameterInt> (
+                ts + "_transpose", tn + " Transpose",
+                -24, 24, 0
+            ));
+
+            p.push_back (std::make_unique<juce::AudioParameterChoice> (
+                ts + "_port", tn + " Output Port",
+                modztakt::ports::makePortChoices(),
+                0
+            ));
+        }
+
 
         // SETTINGS MENU PARAMETERS (Performance)
         // MIDI Data Throttle (change threshold in steps)
@@ -1554,6 +1772,32 @@ private:
             juce::StringArray{"Off (send every change)", "0.5ms", "1.0ms", "1.5ms", "2.0ms", "3.0ms", "5.0ms"},
             0));  // Default to index 0 = Off
 
+        // MIDI Curve tolerance (CurveSimplifier.h): LFO / EG / per-note EG values are
+        // only sent once the value last sent would be off by more than this many
+        // 7-bit steps.  Options: Off, 0.5, 1, 2, 4 steps
+        p.push_back(std::make_unique<juce::AudioParameterChoice>(
+            "midiCurveTolerance",
+            "MIDI Curve Tolerance",
+            juce::StringArray{"Off (send every change)", "0.5 step", "1 step", "2 steps", "4 steps"},
+            0));  // Default to index 0 = Off
+
+        // A/B snapshot morph (SnapshotMorph.h): 0 = snapshot A, 1 = snapshot B
+        p.push_back (std::make_unique<juce::AudioParameterBool>("morphEnabled", "Morph A/B", false));
+        p.push_back (std::make_unique<juce::AudioParameterFloat>(
+            "morphAmount", "Morph",
+            juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
+
+        // Preset bank: channel whose program changes recall presets (PresetBank.h)
+        {
+            juce::StringArray choices { "Off", "Omni" };
+            for (int ch = 1; ch <= 16; ++ch)
+                choices.add ("Ch " + juce::String (ch));
+
+            p.push_back (std::make_unique<juce::AudioParameterChoice> (
+                "presetProgramChannel", "Preset Program Change", choices,
+                modztakt::presets::programChannelOff));
+        }
+
     return { p.begin(), p.end() };
     }
 
@@ -1635,21 +1879,23 @@ private:
             return;
 
         if (gotStart)
+        {
             transportRunning.store(true, std::memory_order_release);
+            postUiEvent (modztakt::ui::Event::Type::transportStart);
+        }
 
         if (gotStop)
+        {
             transportRunning.store(false, std::memory_order_release);
+            postUiEvent (modztakt::ui::Event::Type::transportStop);
+        }
 
         // Reset phases + one-shot runtime flags
-        for (int i = 0; i < maxRoutes; ++i)
+        for (int i = 0; i < maxLfoRoutes; ++i)
         {
-            auto& route = lfoRoutes[i];
-
-            lfoPhase[i] = modztakt::lfo::getWaveformStartPhase(shape, route.bipolar);
-
-            route.hasFinishedOneShot = false;
-            route.passedPeak = false;
-            route.totalPhaseAdvanced = 0.0;
+            lfoRoutes.phase[(size_t) i] = modztakt::lfo::getWaveformStartPhase (shape, lfoRoutes.has (i, modztakt::lfo::RouteFlag::bipolar));
+            lfoRoutes.phaseAdvanced[(size_t) i] = 0.0;
+            lfoRoutes.set (i, modztakt::lfo::RouteFlag::finished | modztakt::lfo::RouteFlag::passedPeak, false);
         }
 
         requestLfoRestart.store(true, std::memory_order_release);
@@ -1664,7 +1910,7 @@ private:
                 lfoForcedActiveByPlay = false;
 
                 // Update UI param to OFF
-                uiRequestSetLfoActiveOff.store(true, std::memory_order_release);
+                requestUiLfoActive (false);
             }
             else
             {
@@ -1683,69 +1929,41 @@ private:
             if (startOnPlay.load(std::memory_order_relaxed))
             {
                 lfoForcedActiveByPlay = true;
-                uiRequestSetLfoActiveOn.store(true, std::memory_order_release);
+                requestUiLfoActive (true);
             }
         }
     }
 
-    inline int mapEgToMidi (double egVal, int paramId) const
+    // Core::render() output for one block: the port buffers, MIDI 2.0 ports,
+    // the scope and the one-shot UI event
+    struct BlockSink
     {
-        const auto& param = syntaktParameters[paramId];
+        ModzTaktAudioProcessor& processor;
+        const modztakt::ports::PortBuffers& out;
+        double startMs;
 
-        if (param.isBipolar)
-        {
-            const double center = (param.minValue + param.maxValue) * 0.5;
-            const double range  = (param.maxValue - param.minValue) * 0.5;
-            return (int) (center + (egVal * 2.0 - 1.0) * range);
-        }
-
-        return (int) (param.minValue + egVal * (param.maxValue - param.minValue));
-    }
-
-    inline void sendThrottledParamValueToBuffer (juce::MidiBuffer& midiOut,
-                                             int routeIndex,
-                                             int midiChannel,
-                                             const SyntaktParameter& param,
-                                             int midiValue,
-                                             int sampleOffsetInBlock)
-    {
-        // Build per-route + per-parameter key
-        static constexpr int CC_MASK = 0x1000;
-        static constexpr int NRPN_MASK = 0x2000;
-
-        const int paramKey =
-            (routeIndex << 16) |
-            (param.isCC ? CC_MASK : NRPN_MASK) |
-            (param.isCC ? param.ccNumber : ((param.nrpnMsb << 7) | param.nrpnLsb));
+        const modztakt::ports::PortBuffers& buffers() const noexcept { return out; }
 
-        const int lastVal = lastSentValuePerParam[paramKey];
-        if (std::abs (midiValue - lastVal) < changeThreshold)
-            return;
+        bool isUmp (int port) const noexcept { return processor.outputPorts.isUmpPort (port); }
 
-        lastSentValuePerParam[paramKey] = midiValue;
-
-        const double now = timeMs;
-        if (now - lastSendTimePerParam[paramKey] < msFloofThreshold)
-            return;
-
-        lastSendTimePerParam[paramKey] = now;
-
-        if (param.isCC)
+        void addUmp (int port, int sampleOffset, const juce::ump::PacketX2& packet) noexcept
         {
-            midiOut.addEvent (juce::MidiMessage::controllerEvent (midiChannel, param.ccNumber, midiValue),
-                              sampleOffsetInBlock);
-            return;
+            processor.outputPorts.addUmp (port, sampleOffset, packet);
         }
 
-        // NRPN: CC 99,98 then 6,38
-        const int valueMSB = (midiValue >> 7) & 0x7F;
-        const int valueLSB = midiValue & 0x7F;
+        // Scope: what goes out on the wire, at its sample position
+        void lfoSent (int route, double sent01, int sampleOffset)
+        {
+            if (route < numScopeRoutes && processor.scopeRoutesEnabled[(size_t) route].load (std::memory_order_relaxed))
+                processor.scopeStreams[(size_t) route].push ((float) (sent01 * 2.0 - 1.0),
+                                                             startMs + 1000.0 * sampleOffset / juce::jmax (1.0, processor.getSampleRate()));
+        }
 
-        midiOut.addEvent (juce::MidiMessage::controllerEvent (midiChannel, 99, param.nrpnMsb), sampleOffsetInBlock);
-        midiOut.addEvent (juce::MidiMessage::controllerEvent (midiChannel, 98, param.nrpnLsb), sampleOffsetInBlock);
-        midiOut.addEvent (juce::MidiMessage::controllerEvent (midiChannel, 6,  valueMSB),   sampleOffsetInBlock);
-        midiOut.addEvent (juce::MidiMessage::controllerEvent (midiChannel, 38, valueLSB),   sampleOffsetInBlock);
-    }
+        void oneShotFinished (int route)
+        {
+            processor.postUiEvent (modztakt::ui::Event::Type::oneShotFinished, false, 0.0, route);
+        }
+    };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ModzTaktAudioProcessor)
 };
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Binary plugin state
+//
+// Layout (little-endian):
+//   u32  magic            "MZTS"
+//   u16  version          formatVersion
+//   u16  reserved         0
+//   u32  numParams
+//   numParams × { u32 parameter ID hash (FNV-1a of the UTF-8 ID), f32 value }
+//   u32  numExtensions
+//   numExtensions × { u32 tag, u32 size, size bytes }
+//
+// Values are denormalised (as in the APVTS XML), so a range change keeps
+// the meaning of stored values.  Parameters missing from the table are
+// reset to their default, like APVTS::replaceState() does.
+//
+// Extensions carry non-parameter state; unknown tags are skipped, so later
+// versions can add blocks without breaking older readers.  Tag::engineTree
+// holds a ValueTree (binary, not XML) with the output ports and instrument
+// map nodes.
+//
+// Loading is one pass over the blob: no XML, no ValueTree for parameters.
+// Anything without the magic is left to the caller's XML fallback.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::state
+{
+    static constexpr uint32_t magic         = 0x53545a4d;   // "MZTS"
+    static constexpr uint16_t formatVersion = 1;
+
+    namespace Tag
+    {
+        static constexpr uint32_t engineTree = 0x45455254;  // "TREE"
+    }
+
+    inline uint32_t hashParameterId (const juce::String& id) noexcept
+    {
+        uint32_t h = 2166136261u;
+
+        for (auto* p = id.toRawUTF8(); *p != 0; ++p)
+            h = (h ^ (uint8_t) *p) * 16777619u;
+
+        return h;
+    }
+
+    inline bool isBinaryState (const void* data, int size) noexcept
+    {
+        return data != nullptr && size >= 8
+            && juce::ByteOrder::littleEndianInt (data) == magic;
+    }
+
+    class Codec
+    {
+    public:
+        using APVTS = juce::AudioProcessorValueTreeState;
+
+        explicit Codec (APVTS& apvts)
+        {
+            for (auto* p : apvts.processor.getParameters())
+                if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (p))
+                    entries.push_back ({ hashParameterId (ranged->paramID), ranged });
+
+            std::sort (entries.begin(), entries.end(),
+                       [] (const Entry& a, const Entry& b) { return a.hash < b.hash; });
+
+            // Two IDs with the same hash would share a slot: rename one of them.
+            jassert (std::adjacent_find (entries.begin(), entries.end(),
+                                         [] (const Entry& a, const Entry& b) { return a.hash == b.hash; })
+                     == entries.end());
+        }
+
+        void write (juce::MemoryBlock& dest, const juce::ValueTree& engineState) const
+        {
+            juce::MemoryOutputStream out (dest, false);
+
+            out.writeInt ((int) magic);
+            out.writeShort ((short) formatVersion);
+            out.writeShort (0);
+
+            out.writeInt ((int) entries.size());
+            for (const auto& e : entries)
+            {
+                out.writeInt ((int) e.hash);
+                out.writeFloat (e.param->convertFrom0to1 (e.param->getValue()));
+            }
+
+            juce::MemoryOutputStream tree;
+            engineState.writeToStream (tree);
+
+            out.writeInt (1);
+            out.writeInt ((int) Tag::engineTree);
+            out.writeInt ((int) tree.getDataSize());
+            out.write (tree.getData(), tree.getDataSize());
+        }
+
+        // Applies the parameters and returns the engine tree through `engineState`.
+        // Returns false when the data isn't a (readable) binary state.
+        bool read (const void* data, int size, juce::ValueTree& engineState) const
+        {
+            if (! isBinaryState (data, size))
+                return false;
+
+            const auto* bytes = static_cast<const uint8_t*> (data);
+            const auto* end   = bytes + size;
+            const auto* pos   = bytes + 4;
+
+            auto canRead = [&] (size_t n) { return (size_t) (end - pos) >= n; };
+            auto readU32 = [&] { const auto v = juce::ByteOrder::littleEndianInt (pos); pos += 4; return v; };
+
+            const auto version = juce::ByteOrder::littleEndianShort (pos);
+            pos += 4;   // version + reserved
+
+            // A newer layout this build can't parse
+            if (version > formatVersion || ! canRead (4))
+                return false;
+
+            const auto numParams = readU32();
+            if (! canRead ((size_t) numParams * 8 + 4))
+                return false;
+
+            std::vector<bool> seen (entries.size(), false);
+
+            for (uint32_t i = 0; i < numParams; ++i)
+            {
+                const auto hash = readU32();
+                const auto bits = readU32();
+
+                float value;
+                std::memcpy (&value, &bits, sizeof (value));
+
+                const auto it = std::lower_bound (entries.begin(), entries.end(), hash,
+                                                  [] (const Entry& e, uint32_t h) { return e.hash < h; });
+
+                // Parameters removed since the session was saved are skipped.
+                if (it == entries.end() || it->hash != hash)
+                    continue;
+
+                it->param->setValueNotifyingHost (it->param->convertTo0to1 (value));
+                seen[(size_t) (it - entries.begin())] = true;
+            }
+
+            for (size_t i = 0; i < entries.size(); ++i)
+                if (! seen[i])
+                    entries[i].param->setValueNotifyingHost (entries[i].param->getDefaultValue());
+
+            const auto numExtensions = readU32();
+
+            for (uint32_t i = 0; i < numExtensions && canRead (8); ++i)
+            {
+                const auto tag  = readU32();
+                const auto blockSize = readU32();
+
+                if (! canRead (blockSize))
+                    break;
+
+                if (tag == Tag::engineTree)
+                    engineState = juce::ValueTree::readFromData (pos, blockSize);
+
+                pos += blockSize;
+            }
+
+            return true;
+        }
+
+    private:
+        struct Entry
+        {
+            uint32_t hash;
+            juce::RangedAudioParameter* param;
+        };
+
+        std::vector<Entry> entries;   // sorted by hash
+    };
+
+    // Times `iterations` save / load round trips of a state format; returns
+    // "save x ms, load y ms, n bytes" (per round trip).
+    inline juce::String benchmark (const std::function<void (juce::MemoryBlock&)>& save,
+                                   const std::function<void (const juce::MemoryBlock&)>& load,
+                                   int iterations)
+    {
+        juce::MemoryBlock block;
+        double saveMs = 0.0, loadMs = 0.0;
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            block.reset();
+
+            auto t0 = juce::Time::getMillisecondCounterHiRes();
+            save (block);
+            auto t1 = juce::Time::getMillisecondCounterHiRes();
+            load (block);
+            auto t2 = juce::Time::getMillisecondCounterHiRes();
+
+            saveMs += t1 - t0;
+            loadMs += t2 - t1;
+        }
+
+        const auto n = (double) juce::jmax (1, iterations);
+        return "save " + juce::String (saveMs / n, 3) + " ms, load " + juce::String (loadMs / n, 3)
+             + " ms, " + juce::String ((int) block.getSize()) + " bytes";
+    }
+} // namespace modztakt::state
@@ -0,0 +1,343 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "PluginState.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Preset bank (song setups recalled by program change)
+//
+// numSlots presets, each a flat array of normalised parameter values in the
+// bank's parameter order.  Presets are decoded ahead of time on the message
+// thread (store / state load); recalling one on the audio thread is a walk
+// over that array that only touches the parameters whose value differs.
+//
+// Program changes (MIDI in, or the host's setCurrentProgram()) are turned
+// into a pending program and applied at the start of the next block, so a
+// song change lands on a block boundary, never mid-block.  Each preset says
+// whether the engine state (LFO phase, pending echoes, EG) is carried over
+// or reset when it is recalled.
+//
+// Global settings (excludedIds) are not part of presets.
+//
+// Presets are immutable once published, so the audio thread can hold a slot's
+// pointer for the block without locking.  A preset replaced or cleared on the
+// message thread is retired with the bank's epoch; applyPending() acknowledges
+// the epoch at the start of each block, and a retired preset is freed once
+// the audio thread has acknowledged an epoch past it (or right away while no
+// audio is processed, see setAudioActive()).  A state load that brings back
+// identical presets reuses the published ones.
+//
+// State: a "PresetBank" node with one "Preset" child per stored slot; values
+// are a binary block of { u32 parameter ID hash, f32 denormalised value }
+// pairs, so presets survive parameters being added, removed or re-ranged.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::presets
+{
+    static constexpr int numSlots = 16;   // programs 0..15
+
+    // Parameter choice "presetProgramChannel": 0 = Off, 1 = Omni, 2..17 = Ch 1..16
+    static constexpr int programChannelOff  = 0;
+    static constexpr int programChannelOmni = 1;
+
+    static constexpr const char* excludedIds[] = { "presetProgramChannel", "midiDataThrottle", "midiRateLimiter", "midiCurveTolerance" };
+
+    struct Preset
+    {
+        juce::String       name;
+        bool               resetEngine = false;   // reset LFO phase / echoes / EG on recall
+        std::vector<float> values;                // normalised, in Bank parameter order
+    };
+
+    class Bank
+    {
+    public:
+        using APVTS = juce::AudioProcessorValueTreeState;
+
+        static constexpr const char* stateId = "PresetBank";
+
+        explicit Bank (APVTS& apvts)
+        {
+            for (auto* p : apvts.processor.getParameters())
+                if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (p))
+                    if (! isExcluded (ranged->paramID))
+                        params.push_back ({ state::hashParameterId (ranged->paramID), ranged });
+        }
+
+        // ── Message thread ────────────────────────────────────────────────────
+
+        // Snapshot of the current parameter values into `slot`.
+        void store (int slot, const juce::String& name, bool resetEngine)
+        {
+            if (! isValidSlot (slot))
+                return;
+
+            auto preset = std::make_unique<Preset>();
+            preset->name = name;
+            preset->resetEngine = resetEngine;
+            preset->values.reserve (params.size());
+
+            for (const auto& p : params)
+                preset->values.push_back (p.param->getValue());
+
+            publish (slot, std::move (preset));
+        }
+
+        void clear (int slot)
+        {
+            if (isValidSlot (slot))
+                publish (slot, nullptr);
+        }
+
+        void rename (int slot, const juce::String& name)
+        {
+            if (const auto* cur = getPreset (slot); cur != nullptr && cur->name != name)
+            {
+                auto preset = std::make_unique<Preset> (*cur);
+                preset->name = name;
+                publish (slot, std::move (preset));
+            }
+        }
+
+        void setResetEngine (int slot, bool resetEngine)
+        {
+            if (const auto* cur = getPreset (slot); cur != nullptr && cur->resetEngine != resetEngine)
+            {
+                auto preset = std::make_unique<Preset> (*cur);
+                preset->resetEngine = resetEngine;
+                publish (slot, std::move (preset));
+            }
+        }
+
+        // nullptr for an empty slot
+        const Preset* getPreset (int slot) const noexcept
+        {
+            return isValidSlot (slot) ? slots[(size_t) slot].load (std::memory_order_acquire) : nullptr;
+        }
+
+        juce::String getSlotName (int slot) const
+        {
+            if (const auto* preset = getPreset (slot))
+                return preset->name;
+
+            return isValidSlot (slot) ? "(empty)" : juce::String();
+        }
+
+        // Program last recalled (-1 before the first recall)
+        int getCurrentProgram() const noexcept { return current.load (std::memory_order_relaxed); }
+
+        // prepareToPlay (true) / releaseResources (false).  While inactive no
+        // block can hold a preset, so replaced ones are freed straight away.
+        void setAudioActive (bool active)
+        {
+            audioActive = active;
+            freeRetired();
+        }
+
+        void saveToState (juce::ValueTree& state) const
+        {
+            auto node = state.getOrCreateChildWithName (stateId, nullptr);
+            node.removeAllChildren (nullptr);
+
+            for (int s = 0; s < numSlots; ++s)
+            {
+                const auto* preset = getPreset (s);
+                if (preset == nullptr)
+                    continue;
+
+                juce::MemoryOutputStream values;
+                for (size_t i = 0; i < params.size(); ++i)
+                {
+                    values.writeInt ((int) params[i].hash);
+                    values.writeFloat (params[i].param->convertFrom0to1 (preset->values[i]));
+                }
+
+                juce::ValueTree child ("Preset");
+                child.setProperty ("slot", s, nullptr);
+                child.setProperty ("name", preset->name, nullptr);
+                child.setProperty ("resetEngine", preset->resetEngine, nullptr);
+                child.setProperty ("values", values.getMemoryBlock(), nullptr);
+                node.appendChild (child, nullptr);
+            }
+        }
+
+        // Decodes every stored preset now, so recalling one later is a plain copy.
+        // A session without a bank empties it.
+        void loadFromState (const juce::ValueTree& state)
+        {
+            std::array<std::unique_ptr<Preset>, numSlots> loaded;
+
+            for (const auto& child : state.getChildWithName (stateId))
+            {
+                const int slot = child.getProperty ("slot", -1);
+                if (! isValidSlot (slot) || ! child.hasType ("Preset"))
+                    continue;
+
+                auto preset = std::make_unique<Preset>();
+                preset->name = child.getProperty ("name").toString();
+                preset->resetEngine = (bool) child.getProperty ("resetEngine", false);
+                decodeValues (child.getProperty ("values"), preset->values);
+
+                loaded[(size_t) slot] = std::move (preset);
+            }
+
+            for (int s = 0; s < numSlots; ++s)
+            {
+                auto& preset = loaded[(size_t) s];
+                const auto* cur = getPreset (s);
+
+                if (preset == nullptr)
+                    clear (s);
+                else if (cur == nullptr || ! isSame (*cur, *preset))
+                    publish (s, std::move (preset));
+            }
+        }
+
+        // ── Any thread ────────────────────────────────────────────────────────
+        // Host setCurrentProgram(), the UI, or a MIDI program change: picked up
+        // at the start of the next block.
+        void requestProgram (int program) noexcept
+        {
+            if (isValidSlot (program))
+                pending.store (program, std::memory_order_release);
+        }
+
+        // ── Audio thread ──────────────────────────────────────────────────────
+        // Start of block: acknowledges the epoch (presets retired before it are
+        // no longer read by this thread), then recalls the pending program if
+        // its slot holds a preset.  Returns that preset (nullptr when nothing
+        // was recalled); valid until the end of the block.
+        const Preset* applyPending() noexcept
+        {
+            acknowledged.store (epoch.load (std::memory_order_acquire), std::memory_order_release);
+
+            const int program = pending.exchange (-1, std::memory_order_acq_rel);
+            const auto* preset = getPreset (program);
+
+            if (preset == nullptr)
+                return nullptr;
+
+            for (size_t i = 0; i < params.size(); ++i)
+            {
+                auto* param = params[i].param;
+                const float v = preset->values[i];
+
+                if (param->getValue() != v)
+                    param->setValueNotifyingHost (v);
+            }
+
+            current.store (program, std::memory_order_relaxed);
+            return preset;
+        }
+
+    private:
+        struct Param
+        {
+            uint32_t hash;
+            juce::RangedAudioParameter* param;
+        };
+
+        static bool isValidSlot (int slot) noexcept { return slot >= 0 && slot < numSlots; }
+
+        static bool isExcluded (const juce::String& id)
+        {
+            for (const auto* e : excludedIds)
+                if (id == e)
+                    return true;
+            return false;
+        }
+
+        static bool isSame (const Preset& a, const Preset& b)
+        {
+            return a.name == b.name && a.resetEngine == b.resetEngine && a.values == b.values;
+        }
+
+        // Parameters missing from the saved block take their default.
+        void decodeValues (const juce::var& v, std::vector<float>& out) const
+        {
+            out.resize (params.size());
+            for (size_t i = 0; i < params.size(); ++i)
+                out[i] = params[i].param->getDefaultValue();
+
+            // Binary ValueTree keeps the block; an XML round trip turns it into base64.
+            juce::MemoryBlock block;
+            if (const auto* b = v.getBinaryData())
+                block = *b;
+            else
+                block.fromBase64Encoding (v.toString());
+
+            const auto* pos = static_cast<const uint8_t*> (block.getData());
+            const auto  n   = block.getSize() / 8;
+
+            for (size_t k = 0; k < n; ++k, pos += 8)
+            {
+                const auto hash = juce::ByteOrder::littleEndianInt (pos);
+                const auto bits = juce::ByteOrder::littleEndianInt (pos + 4);
+
+                float value;
+                std::memcpy (&value, &bits, sizeof (value));
+
+                for (size_t i = 0; i < params.size(); ++i)
+                {
+                    if (params[i].hash == hash)
+                    {
+                        out[i] = params[i].param->convertTo0to1 (value);
+                        break;
+                    }
+                }
+            }
+        }
+
+        // nullptr clears the slot.  The slot's previous preset is retired at the
+        // new epoch: a block that acknowledged that epoch reads the new pointer.
+        void publish (int slot, std::unique_ptr<const Preset> preset)
+        {
+            auto& owner = owners[(size_t) slot];
+            auto  old   = std::move (owner);
+
+            owner = std::move (preset);
+            slots[(size_t) slot].store (owner.get(), std::memory_order_release);
+
+            if (old != nullptr)
+                retired.push_back ({ std::move (old), epoch.fetch_add (1, std::memory_order_acq_rel) + 1 });
+
+            freeRetired();
+        }
+
+        void freeRetired()
+        {
+            const auto done = acknowledged.load (std::memory_order_acquire);
+
+            retired.erase (std::remove_if (retired.begin(), retired.end(),
+                                           [&] (const Retired& r) { return ! audioActive || r.epoch <= done; }),
+                           retired.end());
+        }
+
+        struct Retired
+        {
+            std::unique_ptr<const Preset> preset;
+            uint64_t epoch;                                  // freed once acknowledged
+        };
+
+        std::vector<Param> params;                           // bank parameter order
+
+        std::array<std::unique_ptr<const Preset>, numSlots> owners;   // message thread
+        std::array<std::atomic<const Preset*>, numSlots>    slots {};
+        std::vector<Retired> retired;                        // message thread
+        bool audioActive = false;                            // message thread
+
+        std::atomic<uint64_t> epoch { 0 };
+        std::atomic<uint64_t> acknowledged { 0 };
+
+        std::atomic<int> pending { -1 };
+        std::atomic<int> current { -1 };
+
+        JUCE_DECLARE_NON_COPYABLE (Bank)
+    };
+} // namespace modztakt::presets
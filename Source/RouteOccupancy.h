@@ -0,0 +1,243 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "InstrumentMap.h"
+#include "LfoEngine.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Route occupancy: which routes drive each (MIDI channel, map parameter)
+//
+// A 16 × maxParams table of owner bits, one bit per claimant:
+//   LFO route r         Owner::lfo (r)    (route{r}_channel / route{r}_param)
+//   EG route r          Owner::eg (r)     (egRoute{r}_channel / egRoute{r}_dest)
+//   Delay EG shaping    Owner::delayEgShape  (volume / level role on each delay route channel)
+//   Delay auto-pan      Owner::delayPan      (pan role on each delay route channel)
+//
+// sync() re-derives every owner's claims from the raw parameter values and
+// only touches the cells whose claim moved, bumping getSerial() when anything
+// changed.  A conflict check is then a single lookup:
+//     isClaimed (ch, param, (Owner::anyLfo | Owner::anyEg) & ~Owner::eg (r))
+//
+// Port is not part of the key (the UI never allowed two routes on the same
+// channel and parameter, whatever their port).
+//
+// Not shared between threads: the processor keeps one (audio thread) and the
+// editor another (message thread); each syncs its own.  Nothing allocates.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::routing
+{
+    static constexpr int maxLfoRoutes = lfo::maxRoutes;
+    static constexpr int maxRoutes    = 3;      // EG / delay routes
+    static constexpr int numChannels  = 16;
+
+    namespace Owner
+    {
+        constexpr uint32_t lfo (int r) noexcept { return 1u << r; }
+        constexpr uint32_t eg  (int r) noexcept { return 1u << (16 + r); }
+
+        constexpr uint32_t delayEgShape = 1u << 24;
+        constexpr uint32_t delayPan     = 1u << 25;
+
+        constexpr uint32_t anyLfo   = 0x0000ffffu;
+        constexpr uint32_t anyEg    = 0x00ff0000u;
+        constexpr uint32_t anyDelay = delayEgShape | delayPan;
+        constexpr uint32_t all      = 0xffffffffu;
+
+        // LFO / EG routes with a lower index than r (first route wins)
+        constexpr uint32_t lfoBefore (int r) noexcept { return lfo (r) - 1u; }
+        constexpr uint32_t egBefore  (int r) noexcept { return eg (r) - eg (0); }
+    }
+
+    class Occupancy
+    {
+    public:
+        using APVTS = juce::AudioProcessorValueTreeState;
+
+        Occupancy (APVTS& apvts, const instrument::InstrumentMap& map)
+        {
+            for (int r = 0; r < maxLfoRoutes; ++r)
+            {
+                const auto rs = juce::String (r);
+                auto& p = lfoRouteParams[(size_t) r];
+
+                p.channel = apvts.getRawParameterValue ("route" + rs + "_channel");
+                p.param   = apvts.getRawParameterValue ("route" + rs + "_param");
+            }
+
+            for (int r = 0; r < maxRoutes; ++r)
+            {
+                const auto rs = juce::String (r);
+                auto& p = routeParams[(size_t) r];
+
+                p.egChannel    = apvts.getRawParameterValue ("egRoute"    + rs + "_channel");
+                p.egDest       = apvts.getRawParameterValue ("egRoute"    + rs + "_dest");
+                p.delayChannel = apvts.getRawParameterValue ("delayRoute" + rs + "_channel");
+            }
+
+            delayEgShape    = apvts.getRawParameterValue ("delayEgShape");
+            delayPanEnabled = apvts.getRawParameterValue ("delayPanEnabled");
+
+            sync (map);
+        }
+
+        // Re-reads the route parameters; returns true when any claim moved.
+        bool sync (const instrument::InstrumentMap& map) noexcept
+        {
+            std::array<Claims, numSlots> next {};
+
+            // LFO: choice 0 = Disabled, 1..16; params past the map are off
+            for (int r = 0; r < maxLfoRoutes; ++r)
+            {
+                const auto& p = lfoRouteParams[(size_t) r];
+
+                const int lfoParam = load (p.param);
+                if (map.isValidIndex (lfoParam))
+                    next[lfoSlot (r)][0] = makeCell (load (p.channel), lfoParam);
+            }
+
+            for (int r = 0; r < maxRoutes; ++r)
+            {
+                const auto& p = routeParams[(size_t) r];
+
+                // EG: dest choices past the map's EG destinations drive the LFO, not MIDI
+                next[egSlot (r)][0] = makeCell (load (p.egChannel), map.egChoiceToIndex (load (p.egDest)));
+            }
+
+            // Delay EG shaping / auto-pan: the role parameter on every delay route channel
+            const int shape = load (delayEgShape);
+            const int shapeParam = shape == 0 ? -1
+                                 : map.getRoleIndex (shape == 1 ? instrument::Role::Volume
+                                                                : instrument::Role::Level);
+            const int panParam = load (delayPanEnabled) > 0 ? map.getRoleIndex (instrument::Role::Pan) : -1;
+
+            for (int dr = 0; dr < maxRoutes; ++dr)
+            {
+                const int ch = load (routeParams[(size_t) dr].delayChannel);
+                next[shapeSlot][(size_t) dr] = makeCell (ch, shapeParam);
+                next[panSlot][(size_t) dr]   = makeCell (ch, panParam);
+            }
+
+            bool changed = false;
+
+            for (int s = 0; s < numSlots; ++s)
+            {
+                auto& cur = claims[(size_t) s];
+                const auto& nxt = next[(size_t) s];
+
+                if (cur == nxt)
+                    continue;
+
+                const auto bit = slotOwner (s);
+
+                for (const auto& c : cur) apply (c, bit, false);
+                for (const auto& c : nxt) apply (c, bit, true);
+
+                cur = nxt;
+                changed = true;
+            }
+
+            if (changed)
+                ++serial;
+
+            return changed;
+        }
+
+        // Owner bits of (channel 1..16, map parameter); 0 when free or out of range.
+        uint32_t getOwners (int channel, int param) const noexcept
+        {
+            if (channel < 1 || channel > numChannels || param < 0 || param >= instrument::maxParams)
+                return 0;
+
+            return owners[(size_t) channel - 1][(size_t) param];
+        }
+
+        bool isClaimed (int channel, int param, uint32_t by = Owner::all) const noexcept
+        {
+            return (getOwners (channel, param) & by) != 0;
+        }
+
+        uint32_t getSerial() const noexcept { return serial; }
+
+    private:
+        // One claimed cell; the default (channel 0) is "no claim"
+        struct Cell
+        {
+            int channel = 0;
+            int param   = -1;
+
+            bool isValid() const noexcept { return channel != 0; }
+            bool operator== (const Cell& o) const noexcept { return channel == o.channel && param == o.param; }
+            bool operator!= (const Cell& o) const noexcept { return ! (*this == o); }
+        };
+
+        // Disabled channel or missing parameter: no claim (so it compares equal to one)
+        static Cell makeCell (int channel, int param) noexcept
+        {
+            if (channel < 1 || channel > numChannels || param < 0 || param >= instrument::maxParams)
+                return {};
+
+            return { channel, param };
+        }
+
+        // Slots: LFO routes, EG routes, delay shaping, delay pan.
+        // An LFO / EG route claims one cell, delay features one per delay route.
+        using Claims = std::array<Cell, maxRoutes>;
+
+        static constexpr int shapeSlot = maxLfoRoutes + maxRoutes;
+        static constexpr int panSlot   = shapeSlot + 1;
+        static constexpr int numSlots  = panSlot + 1;
+
+        static constexpr int lfoSlot (int r) noexcept { return r; }
+        static constexpr int egSlot  (int r) noexcept { return maxLfoRoutes + r; }
+
+        static uint32_t slotOwner (int s) noexcept
+        {
+            if (s < maxLfoRoutes)  return Owner::lfo (s);
+            if (s < shapeSlot)     return Owner::eg (s - maxLfoRoutes);
+            return s == shapeSlot ? Owner::delayEgShape : Owner::delayPan;
+        }
+
+        void apply (const Cell& c, uint32_t bit, bool claim) noexcept
+        {
+            if (! c.isValid())
+                return;
+
+            auto& cell = owners[(size_t) c.channel - 1][(size_t) c.param];
+            cell = claim ? (cell | bit) : (cell & ~bit);
+        }
+
+        static int load (const std::atomic<float>* p) noexcept
+        {
+            return p != nullptr ? (int) p->load (std::memory_order_relaxed) : 0;
+        }
+
+        static_assert (maxLfoRoutes <= 16, "owner bits hold 16 LFO routes");
+        static_assert (maxRoutes <= 8,     "owner bits hold 8 EG routes");
+
+        struct LfoRouteParamPtrs
+        {
+            std::atomic<float>* channel = nullptr;
+            std::atomic<float>* param   = nullptr;
+        };
+
+        struct RouteParamPtrs
+        {
+            std::atomic<float>* egChannel    = nullptr;
+            std::atomic<float>* egDest       = nullptr;
+            std::atomic<float>* delayChannel = nullptr;
+        };
+
+        std::array<LfoRouteParamPtrs, maxLfoRoutes> lfoRouteParams {};
+        std::array<RouteParamPtrs,    maxRoutes>    routeParams {};
+        std::atomic<float>* delayEgShape    = nullptr;
+        std::atomic<float>* delayPanEnabled = nullptr;
+
+        std::array<Claims, numSlots> claims {};
+        std::array<std::array<uint32_t, instrument::maxParams>, numChannels> owners {};
+        uint32_t serial = 0;
+    };
+} // namespace modztakt::routing
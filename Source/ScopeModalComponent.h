@@ -1,6 +1,16 @@
 #pragma once
 #include <JuceHeader.h>
 
+#include "ScopeStream.h"
+
+// Trace = the last historySize min/max buckets of each route's ScopeStream,
+// placed by timestamp on a shared time axis.  Values are held between
+// buckets, as the synth holds them (gaps only where a route was idle for
+// longer than idleGapMs).
+//
+// One stream per LFO route; the toggles show routesPerPage routes at a time
+// (the disc is too small for all of them), the arrows page through the rest.
+// A toggle's tick has its trace colour.
 template <size_t N>
 
 class ScopeModalComponent : public juce::Component,
@@ -8,22 +18,23 @@ class ScopeModalComponent : public juce::Component,
 {
 public:
 
-    using LFOValuesArray = std::array<std::atomic<float>, N>;
+    using StreamsArray       = std::array<modztakt::scope::Stream, N>;
     using RoutesEnabledArray = std::array<std::atomic<bool>, N>;
 
-    ScopeModalComponent(LFOValuesArray& lfoValuesRefs, RoutesEnabledArray& lfoRoutesEnabled)
-        : lfoValues(lfoValuesRefs), lfoRoutesEnabled(lfoRoutesEnabled)
+    ScopeModalComponent(StreamsArray& scopeStreams, RoutesEnabledArray& lfoRoutesEnabled)
+        : streams(scopeStreams), lfoRoutesEnabled(lfoRoutesEnabled)
     {
-        for (size_t i = 0; i < N; ++i)
+        for (size_t k = 0; k < routesPerPage; ++k)
         {
-            addAndMakeVisible(routeButtons[i]);
-
-            routeButtons[i].setToggleState(lfoRoutesEnabled[i],
-                                           juce::dontSendNotification);
+            addAndMakeVisible(routeButtons[k]);
 
-            routeButtons[i].onClick = [this, i]()
+            routeButtons[k].onClick = [this, k]()
             {
-                this->lfoRoutesEnabled[i] = routeButtons[i].getToggleState();
+                const size_t i = firstRoute + k;
+                this->lfoRoutesEnabled[i] = routeButtons[k].getToggleState();
+
+                updateTraces();
+                repaint();
 
                 if (!anyRouteEnabled())
                 {
@@ -38,6 +49,21 @@ public:
                 }
             };
         }
+
+        for (auto* arrow : { &prevPageButton, &nextPageButton })
+            addAndMakeVisible(arrow);
+
+        prevPageButton.setTooltip("Previous LFO routes");
+        nextPageButton.setTooltip("Next LFO routes");
+        prevPageButton.onClick = [this]() { showPage(firstRoute - juce::jmin(firstRoute, routesPerPage)); };
+        nextPageButton.onClick = [this]() { showPage(firstRoute + routesPerPage); };
+
+        showPage(0);
+
+        // Path storage is reused frame to frame: reserve a full trace up front
+        for (auto& p : tracePaths)
+            p.preallocateSpace(historySize * 6);
+
         setOpaque(false);
     }
 
@@ -54,6 +80,16 @@ public:
 
     void resized() override
     {
+        const auto bounds = getLocalBounds().toFloat();
+        traceCentre = bounds.getCentre();
+        traceRadius = juce::jmin(bounds.getWidth(), bounds.getHeight()) * 0.5f - 2.0f;
+
+        clipPath.clear();
+        clipPath.addEllipse(bounds);
+
+        background = {};   // re-rendered on next paint
+        updateTraces();
+
         auto area = getLocalBounds();
 
         // Inset everything so it stays inside the circle
@@ -63,113 +99,253 @@ public:
         // Bottom area for toggles
         auto toggleArea = area.removeFromBottom(16);
 
-        const int buttonWidth = 24;
+        const int buttonWidth = 20;
+        const int arrowWidth = 10;
         const int spacing = 2;
 
         int totalWidth = int(routeButtons.size()) * buttonWidth
-                         + (int(routeButtons.size()) - 1) * spacing;
+                         + (int(routeButtons.size()) - 1) * spacing
+                         + 2 * (arrowWidth + spacing);
 
         int x = toggleArea.getCentreX() - totalWidth / 2;
+        const int y = toggleArea.getY() + 15;
+
+        prevPageButton.setBounds(x, y + 3, arrowWidth, toggleArea.getHeight() - 6);
+        x += arrowWidth + spacing;
 
         for (auto& b : routeButtons)
         {
             x += 1; // left margin offset
-            b.setBounds(x, toggleArea.getY() + 15, buttonWidth, toggleArea.getHeight());
+            b.setBounds(x, y, buttonWidth, toggleArea.getHeight());
             x += buttonWidth + spacing;
         }
+
+        nextPageButton.setBounds(x, y + 3, arrowWidth, toggleArea.getHeight() - 6);
+        pageLabelArea = { toggleArea.getX(), y - 11, toggleArea.getWidth(), 10 };
     }
 
     void visibilityChanged() override
     {
         if (isVisible() && anyRouteEnabled())
-            startTimerHz(120);
+            startTimerHz(60);
         else
             stopTimer();
     }
 
     void paint(juce::Graphics& g) override
     {
+        if (!anyRouteEnabled())
+            return;
 
-        for (size_t i = 0; i < lfoValues.size(); ++i)
-        {
-            if (!lfoRoutesEnabled[i].load(std::memory_order_relaxed))
-                continue;
+        // Static background (disc + rim): rendered once per size / scale
+        const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        if (background.isNull() || backgroundScale != scale)
+            renderBackground(scale);
 
-            auto r = getLocalBounds().toFloat();
-            auto centre = r.getCentre();
-            const float radius = juce::jmin(r.getWidth(), r.getHeight()) * 0.5f - 2.0f;
+        g.drawImage(background, getLocalBounds().toFloat());
 
-            g.setColour(juce::Colours::darkgrey);
-            g.fillEllipse(r);
+        g.reduceClipRegion(clipPath);
 
-            g.saveState();
-            {
-                juce::Path clipPath;
-                clipPath.addEllipse(r);
-                g.reduceClipRegion(clipPath);
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (!lfoRoutesEnabled[i].load(std::memory_order_relaxed))
+                continue;
 
-                g.setColour(juce::Colour(0xff003300));
-                g.drawEllipse(r, 2.0f);
+            // glow pass
+            g.setColour(traceColour(i).withAlpha(0.2f));
+            g.strokePath(tracePaths[i], juce::PathStrokeType(3.5f));
 
-                // Draw each active LFO waveform
-                for (size_t i = 0; i < lfoValues.size(); ++i)
-                {
-                    if (!lfoRoutesEnabled[i])
-                        continue;
-
-                    juce::Path p;
-                    for (int j = 0; j < bufferSize; ++j)
-                    {
-                        const int idx = (writeIndices[i] + j) % bufferSize;
-                        const float xNorm = float(j) / (bufferSize - 1);
-                        const float yNorm = buffers[i][idx];
-
-                        const float x = centre.x + (xNorm - 0.5f) * (radius - 8.0f) * 2.0f;
-                        const float y = centre.y - yNorm * (radius - 8.0f);
-
-                        if (j == 0)
-                            p.startNewSubPath(x, y);
-                        else
-                            p.lineTo(x, y);
-                    }
-
-                    // glow pass
-                    g.setColour(juce::Colour::fromHSV(i / float(N), 0.8f, 0.9f, 0.2f));
-                    g.strokePath(p, juce::PathStrokeType(3.5f));
-
-                    // core beam
-                    g.setColour(juce::Colour::fromHSV(i / float(N), 0.8f, 0.9f, 1.0f));
-                    g.strokePath(p, juce::PathStrokeType(1.5f));
-                }
-            }
-            g.restoreState(); // ⬅ restore unclipped state
+            // core beam
+            g.setColour(traceColour(i));
+            g.strokePath(tracePaths[i], juce::PathStrokeType(1.5f));
         }
+
+        // Routes the toggles below stand for
+        const size_t lastRoute = juce::jmin(firstRoute + routesPerPage, N);
+        g.setColour(juce::Colours::lightgrey);
+        g.setFont(9.0f);
+        g.drawText("LFO " + juce::String(firstRoute + 1) + "-" + juce::String(lastRoute),
+                   pageLabelArea, juce::Justification::centred, false);
     }
 
     std::function<void()> onAllRoutesDisabled;
 
 private:
     
+    static juce::Colour traceColour(size_t route)
+    {
+        return juce::Colour::fromHSV(route / float(N), 0.8f, 0.9f, 1.0f);
+    }
+
+    // Toggles for routes first..first + routesPerPage (past N: hidden)
+    void showPage(size_t first)
+    {
+        firstRoute = juce::jmin(first, (N - 1) / routesPerPage * routesPerPage);
+
+        for (size_t k = 0; k < routesPerPage; ++k)
+        {
+            const size_t i = firstRoute + k;
+            auto& b = routeButtons[k];
+
+            b.setVisible(i < N);
+
+            if (i >= N)
+                continue;
+
+            b.setToggleState(lfoRoutesEnabled[i].load(std::memory_order_relaxed), juce::dontSendNotification);
+            b.setColour(juce::ToggleButton::tickColourId, traceColour(i));
+            b.setTooltip("LFO route " + juce::String(i + 1));
+        }
+
+        prevPageButton.setEnabled(firstRoute > 0);
+        nextPageButton.setEnabled(firstRoute + routesPerPage < N);
+        repaint();
+    }
+
     void timerCallback() override
     {
         if (!anyRouteEnabled())
             return;   // sleep completely
 
-        for (size_t i = 0; i < lfoValues.size(); ++i)
+        // Drain every route (disabled ones too, so stale buckets don't pile up)
+        int received = 0;
+        const double previousTimeMs = latestTimeMs;
+
+        for (size_t i = 0; i < N; ++i)
         {
+            received += streams[i].drain([this, i](const modztakt::scope::Bucket& b) { pushBucket(b, i); });
+
+            hasOpenBucket[i] = streams[i].getOpenBucket(openBuckets[i]);
+
             if (lfoRoutesEnabled[i].load(std::memory_order_relaxed))
-                pushSample(lfoValues[i].load(std::memory_order_relaxed), i);
+                latestTimeMs = juce::jmax(latestTimeMs, streams[i].getTimeMs());
         }
 
-        repaint();
+        // Held values scroll even when nothing new was sent
+        if (received > 0 || latestTimeMs != previousTimeMs)
+            repaintTraces();
     }
 
-    // Push a new LFO sample (-1..+1 expected)
-    void pushSample(float v, size_t lfoIndex)
+    // ── Rendering cache ──────────────────────────────────────────────────────
+    void renderBackground(float scale)
     {
-        v = juce::jlimit(-1.0f, 1.0f, v);
-        buffers[lfoIndex][writeIndices[lfoIndex]] = v;
-        writeIndices[lfoIndex] = (writeIndices[lfoIndex] + 1) % bufferSize;
+        backgroundScale = scale;
+        background = juce::Image(juce::Image::ARGB,
+                                 juce::jmax(1, juce::roundToInt((float) getWidth()  * scale)),
+                                 juce::jmax(1, juce::roundToInt((float) getHeight() * scale)),
+                                 true);
+
+        juce::Graphics bg(background);
+        bg.addTransform(juce::AffineTransform::scale(scale));
+
+        const auto r = getLocalBounds().toFloat();
+
+        bg.setColour(juce::Colours::darkgrey);
+        bg.fillEllipse(r);
+
+        bg.reduceClipRegion(clipPath);
+        bg.setColour(juce::Colour(0xff003300));
+        bg.drawEllipse(r, 2.0f);
+    }
+
+    // Rebuilds the trace paths in place (storage is kept between frames):
+    // min/max per bucket, newest on the right, each bucket's last value held
+    // until the next one, broken where a route was idle.
+    void updateTraces()
+    {
+        using modztakt::scope::idleGapMs;
+
+        const double windowStartMs = latestTimeMs - historySize * modztakt::scope::bucketMs;
+        const float  amplitude     = traceRadius - 8.0f;
+
+        const auto xAt = [&](double timeMs)
+        {
+            const float xNorm = float((juce::jmax(timeMs, windowStartMs) - windowStartMs) / (latestTimeMs - windowStartMs));
+            return traceCentre.x + (xNorm - 0.5f) * amplitude * 2.0f;
+        };
+
+        const auto yAt = [&](float value) { return traceCentre.y - value * amplitude; };
+
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto& p = tracePaths[i];
+            p.clear();
+
+            if (!lfoRoutesEnabled[i].load(std::memory_order_relaxed))
+                continue;
+
+            const modztakt::scope::Bucket* prev = nullptr;
+
+            const auto addBucket = [&](const modztakt::scope::Bucket& b)
+            {
+                if (b.timeMs < windowStartMs)
+                {
+                    prev = &b;   // may still be held into the window
+                    return;
+                }
+
+                const float x = xAt(b.timeMs);
+
+                if (prev == nullptr || b.timeMs - prev->timeMs > idleGapMs)
+                    p.startNewSubPath(x, yAt(b.max));
+                else
+                {
+                    if (p.isEmpty())
+                        p.startNewSubPath(xAt(windowStartMs), yAt(prev->last));
+
+                    p.lineTo(x, yAt(prev->last));
+                    p.lineTo(x, yAt(b.max));
+                }
+
+                p.lineTo(x, yAt(b.min));
+                p.lineTo(x, yAt(b.last));
+                prev = &b;
+            };
+
+            for (int j = 0; j < historyCounts[i]; ++j)
+                addBucket(history[i][(size_t) ((historyWrite[i] - historyCounts[i] + j + historySize) % historySize)]);
+
+            // The bucket the audio thread is still filling (drained later as a finished one)
+            if (hasOpenBucket[i] && (prev == nullptr || openBuckets[i].timeMs > prev->timeMs))
+                addBucket(openBuckets[i]);
+
+            // Last value held up to now
+            if (prev != nullptr && latestTimeMs - prev->timeMs <= idleGapMs)
+            {
+                if (p.isEmpty())
+                    p.startNewSubPath(xAt(windowStartMs), yAt(prev->last));
+
+                p.lineTo(xAt(latestTimeMs), yAt(prev->last));
+            }
+        }
+    }
+
+    // Repaints only the area covered by the old and new traces.
+    void repaintTraces()
+    {
+        updateTraces();
+
+        juce::Rectangle<float> dirty;
+        for (const auto& p : tracePaths)
+            if (!p.isEmpty())
+                dirty = dirty.isEmpty() ? p.getBounds() : dirty.getUnion(p.getBounds());
+
+        // glow stroke width + antialiasing margin
+        const auto area = dirty.expanded(3.0f).getSmallestIntegerContainer();
+
+        if (!area.isEmpty() || !lastTraceArea.isEmpty())
+            repaint(area.getUnion(lastTraceArea));
+
+        lastTraceArea = area;
+    }
+
+    void pushBucket(const modztakt::scope::Bucket& b, size_t route)
+    {
+        history[route][(size_t) historyWrite[route]] = b;
+        historyWrite[route]  = (historyWrite[route] + 1) % historySize;
+        historyCounts[route] = juce::jmin(historyCounts[route] + 1, historySize);
+
+        latestTimeMs = juce::jmax(latestTimeMs, b.timeMs);
     }
 
     // used to disable scope when unused
@@ -182,14 +358,33 @@ private:
         return false;
     }
 
-    LFOValuesArray& lfoValues;
+    StreamsArray& streams;
     RoutesEnabledArray& lfoRoutesEnabled;
 
-    static constexpr int bufferSize = 128;
-
-    std::array<std::array<float, bufferSize>, N> buffers;
-    std::array<int, N> writeIndices = {};
-
-    // toggles to display routes
-    std::array<juce::ToggleButton, N> routeButtons;
+    static constexpr int historySize = 128;
+
+    std::array<std::array<modztakt::scope::Bucket, historySize>, N> history {};
+    std::array<int, N> historyWrite = {};
+    std::array<int, N> historyCounts = {};
+    std::array<modztakt::scope::Bucket, N> openBuckets {};
+    std::array<bool, N> hasOpenBucket {};
+    double latestTimeMs = 0.0;   // right edge: stream time, or the newest bucket
+
+    // Cached rendering state
+    juce::Image background;
+    float backgroundScale = 1.0f;
+    juce::Path clipPath;
+    std::array<juce::Path, N> tracePaths;
+    juce::Point<float> traceCentre;
+    float traceRadius = 0.0f;
+    juce::Rectangle<int> lastTraceArea;
+
+    // toggles to display routes, one page at a time
+    static constexpr size_t routesPerPage = 3;
+
+    std::array<juce::ToggleButton, routesPerPage> routeButtons;
+    juce::ArrowButton prevPageButton { "prevRoutes", 0.5f, juce::Colours::lightgrey };
+    juce::ArrowButton nextPageButton { "nextRoutes", 0.0f, juce::Colours::lightgrey };
+    size_t firstRoute = 0;
+    juce::Rectangle<int> pageLabelArea;
 };
\ No newline at end of file
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Scope sample stream (audio thread → scope)
+//
+// One Stream per route.  The audio thread pushes every value it sends
+// (push(), -1..+1 with its time in the processor's ms timeline); samples are
+// reduced to min/max buckets of bucketMs, so fast modulation shows as a band
+// instead of aliasing.  Finished buckets go through a preallocated
+// single-producer / single-consumer ring, and the scope drains them at its
+// own frame rate (drain()).
+//
+// Throttled and compressed streams are sparse: the synth holds each value
+// until the next one, and so does the trace.  The bucket still being filled
+// is readable from the scope side (getOpenBucket(), a sequence-locked copy),
+// so the last value sent shows without waiting for the next push, and
+// setTime() once per block tells the scope how far the held value runs.
+//
+// Nothing allocates or locks.  When the scope falls behind, new buckets are
+// dropped (getDroppedCount()) rather than overwriting unread ones.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::scope
+{
+    static constexpr double bucketMs   = 8.0;      // 128 buckets ≈ 1 s of trace
+    static constexpr double idleGapMs  = 2000.0;   // longer silences draw as a gap
+
+    struct Bucket
+    {
+        float  min    = 0.0f;
+        float  max    = 0.0f;
+        float  last   = 0.0f;  // value held after the bucket
+        double timeMs = 0.0;   // start of the bucket
+    };
+
+    class Stream
+    {
+    public:
+        static constexpr int capacity = 512;   // ≈ 4 s of buckets; power of two
+
+        // ── Audio thread ──────────────────────────────────────────────────────
+        void push (float value, double timeMs) noexcept
+        {
+            value = juce::jlimit (-1.0f, 1.0f, value);
+
+            // New bucket: publish the previous one
+            if (! open || timeMs >= current.timeMs + bucketMs || timeMs < current.timeMs)
+            {
+                if (open)
+                    publish (current);
+
+                current = { value, value, value, timeMs - std::fmod (timeMs, bucketMs) };
+                open = true;
+            }
+            else
+            {
+                current.min  = juce::jmin (current.min, value);
+                current.max  = juce::jmax (current.max, value);
+                current.last = value;
+            }
+
+            // Sequence lock: odd while the copy is being written
+            const auto seq = openSeq.load (std::memory_order_relaxed);
+            openSeq.store (seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence (std::memory_order_release);
+
+            openMin.store (current.min, std::memory_order_relaxed);
+            openMax.store (current.max, std::memory_order_relaxed);
+            openLast.store (current.last, std::memory_order_relaxed);
+            openTimeMs.store (current.timeMs, std::memory_order_relaxed);
+
+            openSeq.store (seq + 2, std::memory_order_release);
+        }
+
+        // End of every block the scope shows this route.
+        void setTime (double nowMs) noexcept
+        {
+            timeNowMs.store (nowMs, std::memory_order_relaxed);
+        }
+
+        // ── Scope (message thread) ────────────────────────────────────────────
+        // Calls fn (const Bucket&) for every bucket published since the last drain.
+        template <typename Fn>
+        int drain (Fn&& fn) noexcept
+        {
+            const auto w = writePos.load (std::memory_order_acquire);
+            auto r = readPos.load (std::memory_order_relaxed);
+
+            int n = 0;
+            for (; r != w; ++r, ++n)
+                fn (ring[r & (capacity - 1)]);
+
+            readPos.store (r, std::memory_order_release);
+            return n;
+        }
+
+        // The bucket being filled (also published later by the audio thread:
+        // the scope draws it in place until the finished one is drained).
+        bool getOpenBucket (Bucket& b) const noexcept
+        {
+            for (int attempt = 0; attempt < 4; ++attempt)
+            {
+                const auto before = openSeq.load (std::memory_order_acquire);
+
+                if (before == 0)
+                    return false;   // nothing pushed yet
+
+                if ((before & 1) != 0)
+                    continue;
+
+                b.min    = openMin.load (std::memory_order_relaxed);
+                b.max    = openMax.load (std::memory_order_relaxed);
+                b.last   = openLast.load (std::memory_order_relaxed);
+                b.timeMs = openTimeMs.load (std::memory_order_relaxed);
+
+                std::atomic_thread_fence (std::memory_order_acquire);
+
+                if (openSeq.load (std::memory_order_relaxed) == before)
+                    return true;
+            }
+
+            return false;   // being written: next frame
+        }
+
+        double getTimeMs() const noexcept { return timeNowMs.load (std::memory_order_relaxed); }
+
+        uint32_t getDroppedCount() const noexcept { return dropped.load (std::memory_order_relaxed); }
+
+    private:
+        void publish (const Bucket& b) noexcept
+        {
+            const auto w = writePos.load (std::memory_order_relaxed);
+
+            if (w - readPos.load (std::memory_order_acquire) >= (uint32_t) capacity)
+            {
+                dropped.fetch_add (1, std::memory_order_relaxed);
+                return;
+            }
+
+            ring[w & (capacity - 1)] = b;
+            writePos.store (w + 1, std::memory_order_release);
+        }
+
+        static_assert ((capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+
+        std::array<Bucket, capacity> ring {};
+        std::atomic<uint32_t> writePos { 0 }, readPos { 0 }, dropped { 0 };
+
+        // Open bucket copy + stream time (audio thread writes, scope reads)
+        std::atomic<uint32_t> openSeq { 0 };
+        std::atomic<float>    openMin { 0.0f }, openMax { 0.0f }, openLast { 0.0f };
+        std::atomic<double>   openTimeMs { 0.0 }, timeNowMs { 0.0 };
+
+        // Audio thread only
+        Bucket current;
+        bool   open = false;
+    };
+} // namespace modztakt::scope
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// A/B snapshot morph
+//
+// Two snapshots (A, B) of the morph targets below, and one automatable
+// "morphAmount" parameter that moves between them.  While "morphEnabled" is
+// on and both snapshots are stored, the processor feeds the engines' Params
+// from resolve() instead of the live parameters:
+//   - continuous targets are interpolated in the parameter's normalised range
+//     (so skewed ranges like the LFO rate morph the way the knob turns)
+//   - discrete targets (shapes, modes, divisions, switches) take A below
+//     switchPoint and B from it
+//
+// Nothing is written back to the APVTS: one parameter moves, the host sees
+// one automation lane.  The knobs keep showing the live values.
+//
+// Snapshots are flat arrays of atomics, written by the message thread
+// (capture / state load) and read by the audio thread once per block.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::morph
+{
+    enum Target : int
+    {
+        lfoRate, lfoDepth, lfoShape,
+        egAttack, egHold, egDecay, egSustain, egRelease, egVelAmount,
+        egAttackMode, egDecayCurve, egReleaseCurve,
+        delayTime, delayFeedback, delaySyncDivision, delayPanEnabled, delayPanWidth,
+
+        numTargets
+    };
+
+    struct TargetInfo
+    {
+        const char* paramId;
+        bool        continuous;
+    };
+
+    static constexpr TargetInfo targets[numTargets] =
+    {
+        { "lfoRateHz",         true  },
+        { "lfoDepth",          true  },
+        { "lfoShape",          false },
+        { "egAttack",          true  },
+        { "egHold",            true  },
+        { "egDecay",           true  },
+        { "egSustain",         true  },
+        { "egRelease",         true  },
+        { "egVelAmount",       true  },
+        { "egAttackMode",      false },
+        { "egDecayCurve",      false },
+        { "egReleaseCurve",    false },
+        { "delayRate",         true  },
+        { "feedback",          true  },
+        { "delaySyncDivision", false },
+        { "delayPanEnabled",   false },
+        { "delayPanWidth",     true  },
+    };
+
+    static constexpr float switchPoint = 0.5f;
+
+    enum Slot : int { A = 0, B = 1 };
+
+    using Values = std::array<float, numTargets>;   // denormalised, like getRawParameterValue()
+
+    class Snapshots
+    {
+    public:
+        using APVTS = juce::AudioProcessorValueTreeState;
+
+        static constexpr const char* stateId = "MorphSnapshots";
+
+        explicit Snapshots (APVTS& apvts)
+        {
+            for (int t = 0; t < numTargets; ++t)
+            {
+                params[(size_t) t] = dynamic_cast<juce::RangedAudioParameter*> (apvts.getParameter (targets[t].paramId));
+                live[(size_t) t]   = apvts.getRawParameterValue (targets[t].paramId);
+                jassert (params[(size_t) t] != nullptr && live[(size_t) t] != nullptr);
+            }
+
+            amount  = apvts.getRawParameterValue ("morphAmount");
+            enabled = apvts.getRawParameterValue ("morphEnabled");
+        }
+
+        // ── Message thread ────────────────────────────────────────────────────
+        void capture (int slot)
+        {
+            for (int t = 0; t < numTargets; ++t)
+                snapshots[(size_t) slot][(size_t) t].store (params[(size_t) t]->getValue(), std::memory_order_relaxed);
+
+            stored[(size_t) slot].store (true, std::memory_order_release);
+        }
+
+        bool hasSnapshot (int slot) const noexcept { return stored[(size_t) slot].load (std::memory_order_acquire); }
+
+        void saveToState (juce::ValueTree& state) const
+        {
+            auto node = state.getOrCreateChildWithName (stateId, nullptr);
+            node.removeAllChildren (nullptr);
+
+            for (int s = A; s <= B; ++s)
+            {
+                if (! hasSnapshot (s))
+                    continue;
+
+                juce::ValueTree child ("Snapshot");
+                child.setProperty ("slot", s, nullptr);
+
+                for (int t = 0; t < numTargets; ++t)
+                    child.setProperty (targets[t].paramId,
+                                       params[(size_t) t]->convertFrom0to1 (snapshots[(size_t) s][(size_t) t].load (std::memory_order_relaxed)),
+                                       nullptr);
+
+                node.appendChild (child, nullptr);
+            }
+        }
+
+        // Targets missing from a saved snapshot take their default.
+        void loadFromState (const juce::ValueTree& state)
+        {
+            std::array<bool, 2> found { false, false };
+
+            for (const auto& child : state.getChildWithName (stateId))
+            {
+                const int s = child.getProperty ("slot", -1);
+                if (s != A && s != B)
+                    continue;
+
+                for (int t = 0; t < numTargets; ++t)
+                {
+                    auto* p = params[(size_t) t];
+                    const auto v = child.getProperty (targets[t].paramId);
+
+                    snapshots[(size_t) s][(size_t) t].store (v.isVoid() ? p->getDefaultValue()
+                                                                       : p->convertTo0to1 ((float) v),
+                                                             std::memory_order_relaxed);
+                }
+
+                found[(size_t) s] = true;
+            }
+
+            for (int s = A; s <= B; ++s)
+                stored[(size_t) s].store (found[(size_t) s], std::memory_order_release);
+        }
+
+        // ── Audio thread ──────────────────────────────────────────────────────
+        // Values the engines use this block: the morph when active, else the live parameters.
+        const Values& resolve() noexcept
+        {
+            if (! isActive())
+            {
+                for (int t = 0; t < numTargets; ++t)
+                    current[(size_t) t] = live[(size_t) t]->load (std::memory_order_relaxed);
+
+                return current;
+            }
+
+            const float x = juce::jlimit (0.0f, 1.0f, amount->load (std::memory_order_relaxed));
+
+            for (int t = 0; t < numTargets; ++t)
+            {
+                const float a = snapshots[A][(size_t) t].load (std::memory_order_relaxed);
+                const float b = snapshots[B][(size_t) t].load (std::memory_order_relaxed);
+
+                const float v01 = targets[t].continuous ? a + (b - a) * x
+                                                        : (x < switchPoint ? a : b);
+
+                current[(size_t) t] = params[(size_t) t]->convertFrom0to1 (v01);
+            }
+
+            return current;
+        }
+
+        bool isActive() const noexcept
+        {
+            return enabled->load (std::memory_order_relaxed) > 0.5f && hasSnapshot (A) && hasSnapshot (B);
+        }
+
+    private:
+        std::array<juce::RangedAudioParameter*, numTargets> params {};
+        std::array<std::atomic<float>*, numTargets>         live {};
+        std::atomic<float>* amount  = nullptr;
+        std::atomic<float>* enabled = nullptr;
+
+        // Normalised values per slot
+        std::array<std::array<std::atomic<float>, numTargets>, 2> snapshots {};
+        std::array<std::atomic<bool>, 2> stored {};
+
+        Values current {};   // audio thread only
+
+        JUCE_DECLARE_NON_COPYABLE (Snapshots)
+    };
+} // namespace modztakt::morph
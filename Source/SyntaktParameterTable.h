@@ -1,5 +1,8 @@
 #pragma once
-#include <JuceHeader.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <climits>
+#include <cmath>
+#include <cstdint>
 
 struct SyntaktParameter
     {
@@ -12,13 +15,186 @@ struct SyntaktParameter
         int maxValue;    // max mapped value
         bool isBipolar;  // centered params
         bool egDestination; // available in EG dest selector
+        bool isCC14 = false; // with isCC: 14-bit CC pair, ccNumber (0..31) = MSB, ccNumber + 32 = LSB
     };
 
+// Wire encoding of one parameter value
+enum class ParamEncoding
+{
+    CC7,    // 1 message,  3 bytes, 0..127
+    CC14,   // 2 messages, 6 bytes, 0..16383 (CC n + CC n+32)
+    NRPN    // 4 messages, 12 bytes, 0..16383 (CC 99/98/6/38)
+};
+
+inline ParamEncoding getParamEncoding (const SyntaktParameter& p) noexcept
+{
+    if (! p.isCC)
+        return ParamEncoding::NRPN;
+
+    return (p.isCC14 && p.ccNumber >= 0 && p.ccNumber < 32) ? ParamEncoding::CC14
+                                                            : ParamEncoding::CC7;
+}
+
+// ── Wire output ─────────────────────────────────────────────────────────────
+// Used by the engine core's send path (EngineCore.h).
+
+// knob >= 0: live knob position (knobFollow) — bipolar centre, or the
+// unipolar starting point the envelope rises from.
+inline int mapEgToMidi (double egVal, const SyntaktParameter& param, int knob = -1)
+{
+    if (param.isBipolar)
+    {
+        const double center = (knob >= 0) ? (double) knob : (param.minValue + param.maxValue) * 0.5;
+        const double range  = (param.maxValue - param.minValue) * 0.5;
+        return juce::jlimit (param.minValue, param.maxValue, (int) (center + (egVal * 2.0 - 1.0) * range));
+    }
+
+    const int base = (knob >= 0) ? knob : param.minValue;
+    return (int) (base + egVal * (param.maxValue - base));
+}
+
+// Position of an EG route's value in the parameter's range (MIDI 2.0, curve
+// compression): the envelope itself, or where mapEgToMidi put it around the knob.
+inline double mapEgTo01 (double egVal, int midiValue, const SyntaktParameter& param, int knob = -1)
+{
+    return (knob >= 0) ? (midiValue - param.minValue) / (double) (param.maxValue - param.minValue)
+                       : egVal;
+}
+
+// Per-encoding change threshold, in the parameter's own value units.
+// The "MIDI Data throttle" setting counts 7-bit steps.  High-resolution
+// encodings keep a finer step, scaled by their wire cost: a CC pair
+// (6 bytes) resolves 1/16 of a 7-bit step, NRPN (12 bytes) 1/8.
+inline int changeThresholdFor (const SyntaktParameter& param, int steps7) noexcept
+{
+    if (steps7 <= 0)
+        return 0;
+
+    const auto encoding = getParamEncoding (param);
+    if (encoding == ParamEncoding::CC7)
+        return steps7;
+
+    const int unitsPerStep = juce::jmax (1, (param.maxValue - param.minValue) / 127);
+    const int subdivisions = (encoding == ParamEncoding::CC14) ? 16 : 8;
+
+    return juce::jmax (1, steps7 * unitsPerStep / subdivisions);
+}
+
+// Data throttle, then rate limiter, for one destination: false when `value`
+// must not go out.  lastSent INT_MIN = nothing sent yet; threshold is in the
+// value's own units (changeThresholdFor(), or 1 for "any change").
+inline bool passThrottle (int& lastSent, double& lastSendMs, int value, int threshold,
+                          double nowMs, double minIntervalMs) noexcept
+{
+    if (lastSent != INT_MIN && std::abs ((juce::int64) value - lastSent) < threshold)
+        return false;
+
+    lastSent = value;
+
+    if (nowMs - lastSendMs < minIntervalMs)
+        return false;
+
+    lastSendMs = nowMs;
+    return true;
+}
+
+// Curve simplifier tolerance (CurveSimplifier.h) as a position in the
+// parameter's range.  The "MIDI Curve tolerance" setting counts 7-bit steps:
+// one step of the parameter's own range for 7-bit CCs, 1/127 of the range
+// for the high-resolution encodings.
+inline double curveToleranceFor (const SyntaktParameter& param, double steps7) noexcept
+{
+    if (steps7 <= 0.0)
+        return 0.0;
+
+    const double steps = (getParamEncoding (param) == ParamEncoding::CC7)
+                       ? (double) (param.maxValue - param.minValue) : 127.0;
+
+    return steps7 / juce::jmax (1.0, steps);
+}
+
+// Unthrottled CC / NRPN write
+inline void writeParamValueToBuffer (juce::MidiBuffer& midiOut,
+                                     int midiChannel,
+                                     const SyntaktParameter& param,
+                                     int midiValue,
+                                     int sampleOffsetInBlock)
+{
+    const auto encoding = getParamEncoding (param);
+
+    if (encoding == ParamEncoding::CC7)
+    {
+        midiOut.addEvent (juce::MidiMessage::controllerEvent (midiChannel, param.ccNumber, midiValue),
+                          sampleOffsetInBlock);
+        return;
+    }
+
+    const int valueMSB = (midiValue >> 7) & 0x7F;
+    const int valueLSB = midiValue & 0x7F;
+
+    // 14-bit CC pair: MSB first, the receiver latches on the LSB
+    if (encoding == ParamEncoding::CC14)
+    {
+        midiOut.addEvent (juce::MidiMessage::controllerEvent (midiChannel, param.ccNumber,      valueMSB), sampleOffsetInBlock);
+        midiOut.addEvent (juce::MidiMessage::controllerEvent (midiChannel, param.ccNumber + 32, valueLSB), sampleOffsetInBlock);
+        return;
+    }
+
+    // NRPN: CC 99,98 then 6,38
+
+    midiOut.addEvent (juce::MidiMessage::controllerEvent (midiChannel, 99, param.nrpnMsb), sampleOffsetInBlock);
+    midiOut.addEvent (juce::MidiMessage::controllerEvent (midiChannel, 98, param.nrpnLsb), sampleOffsetInBlock);
+    midiOut.addEvent (juce::MidiMessage::controllerEvent (midiChannel, 6,  valueMSB),   sampleOffsetInBlock);
+    midiOut.addEvent (juce::MidiMessage::controllerEvent (midiChannel, 38, valueLSB),   sampleOffsetInBlock);
+}
+
+// ── MIDI 2.0 ────────────────────────────────────────────────────────────────
+// Position in [min, max] → 32-bit MIDI 2.0 value, relative to the
+// encoding's full scale (127 or 16383) so table ranges keep their meaning.
+inline uint32_t toUmp32 (const SyntaktParameter& param, double value01) noexcept
+{
+    const double fullScale = (getParamEncoding (param) == ParamEncoding::CC7) ? 127.0 : 16383.0;
+    const double v = (param.minValue + juce::jlimit (0.0, 1.0, value01) * (param.maxValue - param.minValue)) / fullScale;
+
+    return (uint32_t) std::llround (juce::jlimit (0.0, 1.0, v) * 4294967295.0);
+}
+
+// CC (7 or 14 bit) → MIDI 2.0 control change; NRPN → assignable controller.
+inline juce::ump::PacketX2 makeUmpParamPacket (int midiChannel, const SyntaktParameter& param, uint32_t data) noexcept
+{
+    const auto ch = (uint8_t) juce::jlimit (0, 15, midiChannel - 1);
+
+    if (param.isCC)
+        return juce::ump::Factory::makeControlChangeV2 (0, ch, (uint8_t) param.ccNumber, data);
+
+    return juce::ump::Factory::makeAssignableControllerV2 (0, ch, (uint8_t) param.nrpnMsb, (uint8_t) param.nrpnLsb, data);
+}
+
+// Per-note controllers are indexed by CC number.  NRPN entries have no
+// such index (map-loaded ones carry ccNumber 0), so they stay per channel.
+inline bool hasPerNoteIndex (const SyntaktParameter& param) noexcept
+{
+    return param.isCC;
+}
+
+// Per-note EG: assignable per-note controller, index = the entry's CC number.
+inline juce::ump::PacketX2 makeUmpPerNotePacket (int midiChannel, int note, const SyntaktParameter& param, uint32_t data) noexcept
+{
+    jassert (hasPerNoteIndex (param));
+    const auto ch = (uint8_t) juce::jlimit (0, 15, midiChannel - 1);
+
+    return juce::ump::Factory::makeAssignablePerNoteControllerV2 (0, ch, (uint8_t) note, (uint8_t) param.ccNumber, data);
+}
+
+// Entries for synths accepting 14-bit CC pairs set isCC14, e.g.:
+//   {"Cutoff (14-bit)", true, 19, 0, 0, 0, 16383, false, true, true},
+// The Syntakt itself only uses 7-bit CC and NRPN.
+
 
 static const SyntaktParameter syntaktParameters[] = {
 
     // Track parameters
-    {"Pattern Mute", true, 110, 104, 1, 0, 1, false},
+    {"Pattern Mute", true, 110, 104, 1, 0, 1, false, false},
     {"Track Mute", true, 94, 101, 1, 0, 1, false, false},
     {"Track Level", true, 95, 100, 1, 0, 127, false, true},
 
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Processor ⇄ editor message queues
+//
+// Two typed, preallocated single-producer / single-consumer queues:
+//   processor → editor   Event    (audio thread pushes, editor drains on its
+//                                  refresh tick, see UiRefresh.h)
+//   editor → processor   Command  (message thread pushes, the audio thread
+//                                  drains at the start of each block)
+//
+// One producer each: never push from a thread the host picks (host program
+// changes go straight to PresetBank::requestProgram, which is atomic).
+//
+// Every push gets the next sequence number, even when the queue is full and
+// the message is dropped, so the consumer sees a gap (Drain::lost) and can
+// resync from the state accessors instead of missing a transition.  Nothing
+// collapses: two LFO toggles within one UI tick arrive as two events, in the
+// order they were posted.
+//
+// A new processor ↔ UI signal is a new Type here, not a new atomic.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::ui
+{
+    struct Event
+    {
+        enum class Type : uint8_t
+        {
+            lfoRunning,        // flag: LFO actually producing output
+            setLfoActive,      // flag: the Start/Stop parameter should follow
+            setLfoRate,        // value: synced rate (Hz) the rate parameter should show
+            tempo,             // value: BPM from host / MIDI clock (0 = none)
+            oneShotFinished,   // index: LFO route whose one-shot cycle completed
+            transportStart,
+            transportStop
+        };
+
+        Type     type  = Type::lfoRunning;
+        uint32_t seq   = 0;
+        int      index = 0;
+        bool     flag  = false;
+        double   value = 0.0;
+    };
+
+    struct Command
+    {
+        enum class Type : uint8_t
+        {
+            resync             // editor opened: post the current state again
+        };
+
+        Type     type  = Type::resync;
+        uint32_t seq   = 0;
+        int      index = 0;
+        double   value = 0.0;
+    };
+
+    template <typename Message, int capacity>
+    class MessageQueue
+    {
+    public:
+        // ── Producer ──────────────────────────────────────────────────────────
+        // Returns false when the queue is full (the message is dropped, its
+        // sequence number still consumed).
+        bool push (Message m) noexcept
+        {
+            m.seq = nextSeq++;
+
+            const auto w = writePos.load (std::memory_order_relaxed);
+
+            if (w - readPos.load (std::memory_order_acquire) >= (uint32_t) capacity)
+                return false;
+
+            ring[w & (capacity - 1)] = m;
+            writePos.store (w + 1, std::memory_order_release);
+            return true;
+        }
+
+        // ── Consumer ──────────────────────────────────────────────────────────
+        struct Drain
+        {
+            int      count = 0;   // messages handed to fn
+            uint32_t lost  = 0;   // sequence numbers skipped (dropped while full)
+        };
+
+        // Calls fn (const Message&) for every queued message, oldest first.
+        template <typename Fn>
+        Drain drain (Fn&& fn) noexcept
+        {
+            Drain result;
+
+            const auto w = writePos.load (std::memory_order_acquire);
+            auto r = readPos.load (std::memory_order_relaxed);
+
+            for (; r != w; ++r, ++result.count)
+            {
+                const auto& m = ring[r & (capacity - 1)];
+
+                result.lost += m.seq - expectedSeq;
+                expectedSeq = m.seq + 1;
+
+                fn (m);
+            }
+
+            readPos.store (r, std::memory_order_release);
+            return result;
+        }
+
+    private:
+        static_assert ((capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+
+        std::array<Message, capacity> ring {};
+        std::atomic<uint32_t> writePos { 0 }, readPos { 0 };
+
+        uint32_t nextSeq = 0;       // producer only
+        uint32_t expectedSeq = 0;   // consumer only
+    };
+
+    using EventQueue   = MessageQueue<Event, 256>;
+    using CommandQueue = MessageQueue<Command, 64>;
+} // namespace modztakt::ui
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// UI refresh scheduler
+//
+// One timer for the whole editor instead of one polling timer per component.
+// What changed since the last tick is a bit mask (ChangeMask) fed by:
+//   - APVTS parameter listeners   (one per parameter, bits from its ID prefix)
+//   - the processor               (events queued for the editor, instrument
+//                                  map switched by a state load)
+//   - components themselves       (markChanged(), e.g. after a menu action)
+//
+// Marking is a single fetch_or: safe from the audio thread, never blocks.
+// Each tick takes the mask and calls only the subscribers whose bits are set,
+// so an idle editor costs two atomic exchanges per tick.
+//
+// Popups that show parameter state (tap editor) subscribe while open through
+// subscribeScoped().  The ports editor and the scope keep their own timers:
+// they only run while open and show live data (port backlog, traces).
+// ─────────────────────────────────────────────────────────────────────────────
+namespace modztakt::ui
+{
+    namespace Changed
+    {
+        enum : uint32_t
+        {
+            lfoParams     = 1u << 0,   // LFO, sync and global settings parameters
+            routeParams   = 1u << 1,   // route* / egRoute* / delayRoute* parameters
+            egParams      = 1u << 2,   // eg* parameters
+            delayParams   = 1u << 3,   // delay* parameters (+ feedback)
+            events        = 1u << 4,   // processor: events queued (UiEventQueue.h)
+            clock         = 1u << 5,   // tempo display (editor re-marks while it settles)
+            instrumentMap = 1u << 6,   // processor: selected map changed outside the menu
+
+            all           = 0xffffffffu
+        };
+    }
+
+    // Change bits of a parameter, from its ID prefix.
+    inline uint32_t classifyParameter (const juce::String& id)
+    {
+        if (id.startsWith ("route") || id.startsWith ("egRoute"))
+            return Changed::routeParams;
+
+        if (id.startsWith ("delayRoute"))
+            return Changed::routeParams | Changed::delayParams;
+
+        if (id.startsWith ("eg"))
+            return Changed::egParams;
+
+        if (id.startsWith ("delay") || id == "feedback")
+            return Changed::delayParams;
+
+        return Changed::lfoParams;
+    }
+
+    // Lock-free change mask: any thread marks, the scheduler takes.
+    class ChangeMask
+    {
+    public:
+        void mark (uint32_t bits) noexcept
+        {
+            if (bits != 0)
+                mask.fetch_or (bits, std::memory_order_release);
+        }
+
+        uint32_t take() noexcept { return mask.exchange (0, std::memory_order_acquire); }
+
+    private:
+        std::atomic<uint32_t> mask { 0 };
+    };
+
+    class RefreshScheduler : private juce::Timer
+    {
+    public:
+        using APVTS    = juce::AudioProcessorValueTreeState;
+        using Callback = std::function<void (uint32_t changed)>;
+
+        static constexpr int refreshHz = 30;
+
+        RefreshScheduler (APVTS& apvtsRef, ChangeMask& processorChangesRef)
+            : apvts (apvtsRef), processorChanges (processorChangesRef)
+        {
+            for (auto* p : apvts.processor.getParameters())
+            {
+                if (auto* withId = dynamic_cast<juce::AudioProcessorParameterWithID*> (p))
+                {
+                    auto* l = listeners.add (new ParamListener (changes, classifyParameter (withId->paramID)));
+                    apvts.addParameterListener (withId->paramID, l);
+                    listenerIds.add (withId->paramID);
+                }
+            }
+
+            // First tick brings every subscriber up to date.
+            changes.mark (Changed::all);
+        }
+
+        ~RefreshScheduler() override
+        {
+            stopTimer();
+
+            for (int i = 0; i < listeners.size(); ++i)
+                apvts.removeParameterListener (listenerIds[i], listeners[i]);
+        }
+
+        // Message thread.  `fn` runs on a tick where one of `mask`'s bits changed,
+        // with the changed bits it subscribed to.  Subscribers must stay alive
+        // while the timer runs: the owner calls stop() in its destructor.
+        void subscribe (uint32_t mask, Callback fn)
+        {
+            subscribers.push_back ({ nextId++, mask, std::move (fn) });
+        }
+
+        // Ends the subscription it was returned for when destroyed (or does
+        // nothing if the scheduler went first).
+        class Subscription
+        {
+        public:
+            Subscription (RefreshScheduler& s, int subscriberId) : scheduler (&s), id (subscriberId) {}
+
+            ~Subscription()
+            {
+                if (auto* s = scheduler.get())
+                    s->unsubscribe (id);
+            }
+
+        private:
+            juce::WeakReference<RefreshScheduler> scheduler;
+            const int id;
+
+            JUCE_DECLARE_NON_COPYABLE (Subscription)
+        };
+
+        // For components that come and go (popups): keep the returned handle
+        // as a member, declared after everything `fn` uses.
+        [[nodiscard]] Subscription subscribeScoped (uint32_t mask, Callback fn)
+        {
+            const int id = nextId;
+            subscribe (mask, std::move (fn));
+            return Subscription (*this, id);
+        }
+
+        void markChanged (uint32_t bits) noexcept { changes.mark (bits); }
+
+        void start() { startTimerHz (refreshHz); }
+        void stop()  { stopTimer(); }
+
+    private:
+        struct ParamListener : APVTS::Listener
+        {
+            ParamListener (ChangeMask& target, uint32_t b) : changes (target), bits (b) {}
+
+            // Any thread (audio thread for automation)
+            void parameterChanged (const juce::String&, float) override { changes.mark (bits); }
+
+            ChangeMask& changes;
+            const uint32_t bits;
+        };
+
+        struct Subscriber
+        {
+            int      id;
+            uint32_t mask;
+            Callback fn;
+        };
+
+        // A subscriber may end another one from its callback: cleared in
+        // place during a tick, erased after it.
+        void unsubscribe (int id)
+        {
+            for (auto& s : subscribers)
+                if (s.id == id)
+                    s.mask = 0;
+
+            if (! dispatching)
+                removeUnsubscribed();
+        }
+
+        void removeUnsubscribed()
+        {
+            subscribers.erase (std::remove_if (subscribers.begin(), subscribers.end(),
+                                               [] (const Subscriber& s) { return s.mask == 0; }),
+                               subscribers.end());
+        }
+
+        void timerCallback() override
+        {
+            const auto changed = changes.take() | processorChanges.take();
+            if (changed == 0)
+                return;
+
+            dispatching = true;
+
+            for (size_t i = 0; i < subscribers.size(); ++i)
+                if (const auto bits = subscribers[i].mask & changed; bits != 0)
+                    subscribers[i].fn (bits);
+
+            dispatching = false;
+            removeUnsubscribed();
+        }
+
+        APVTS& apvts;
+        ChangeMask& processorChanges;
+        ChangeMask changes;
+
+        juce::OwnedArray<ParamListener> listeners;
+        juce::StringArray listenerIds;
+        std::vector<Subscriber> subscribers;
+        int  nextId = 0;
+        bool dispatching = false;
+
+        JUCE_DECLARE_WEAK_REFERENCEABLE (RefreshScheduler)
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RefreshScheduler)
+    };
+} // namespace modztakt::ui